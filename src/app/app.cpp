@@ -5,7 +5,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <chrono>
 #include <csignal>
+#include <exception>
 #include <execinfo.h>
 #include <iostream>
 
@@ -20,7 +22,9 @@
 #include "app.hpp"
 #include "config/config.hpp"
 #include "fileidentifier/fileidentifier.hpp"
+#include "initgraph.hpp"
 #include "logger/logmodule.hpp"
+#include "tracer/tracer.hpp"
 // cppcheck-suppress missingInclude
 #include "version.hpp"
 
@@ -61,6 +65,10 @@ void ErrorHandler(int sig)
         break;
     }
 
+    if (tracer::Dump()) {
+        std::cerr << "Trace ring dumped" << std::endl;
+    }
+
     size = backtrace(array, cBacktraceSize);
 
     backtrace_symbols_fd(array, size, STDERR_FILENO);
@@ -68,6 +76,13 @@ void ErrorHandler(int sig)
     raise(sig);
 }
 
+void TraceDumpHandler(int sig)
+{
+    (void)sig;
+
+    tracer::Dump();
+}
+
 void RegisterErrorSignals()
 {
     struct sigaction act { };
@@ -81,6 +96,16 @@ void RegisterErrorSignals()
     sigaction(SIGSEGV, &act, nullptr);
 }
 
+void RegisterTraceDumpSignal()
+{
+    struct sigaction act { };
+
+    act.sa_handler = TraceDumpHandler;
+    act.sa_flags   = SA_RESTART;
+
+    sigaction(SIGUSR1, &act, nullptr);
+}
+
 Error ConvertCertModuleConfig(const config::ModuleConfig& config, certhandler::ModuleConfig& aosConfig)
 {
     if (config.mAlgorithm == "ecc") {
@@ -156,15 +181,30 @@ void App::initialize(Application& self)
     }
 
     RegisterErrorSignals();
+    RegisterTraceDumpSignal();
+
+    mLogger.SetLogLevel(mLogLevel);
+    logger::SetLogLevel(mLogLevel);
 
     auto err = mLogger.Init();
     AOS_ERROR_CHECK_AND_THROW(err, "can't initialize logger");
 
+    if (mAsyncLog) {
+        err = mAsyncLogger.Init(
+            mJournal ? logger::AsyncLogger::Backend::eJournald : logger::AsyncLogger::Backend::eStdIO, mLogLevel);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't initialize async logger");
+
+        err = mAsyncLogger.Start();
+        AOS_ERROR_CHECK_AND_THROW(err, "can't start async logger");
+    }
+
     Application::initialize(self);
 
     Init();
     Start();
 
+    ReportStartupTrace();
+
     // Notify systemd
 
     auto ret = sd_notify(0, cSDNotifyReady);
@@ -178,6 +218,10 @@ void App::uninitialize()
     Stop();
 
     Application::uninitialize();
+
+    if (auto err = mAsyncLogger.Stop(); !err.IsNone()) {
+        std::cerr << "Can't stop async logger" << std::endl;
+    }
 }
 
 void App::reinitialize(Application& self)
@@ -216,6 +260,16 @@ void App::defineOptions(Poco::Util::OptionSet& options)
     options.addOption(Poco::Util::Option("config", "c", "path to config file")
                           .argument("${file}")
                           .callback(Poco::Util::OptionCallback<App>(this, &App::HandleConfigFile)));
+    options.addOption(Poco::Util::Option("startup-trace", "", "dumps startup trace in Chrome trace format")
+                          .argument("${file}")
+                          .callback(Poco::Util::OptionCallback<App>(this, &App::HandleStartupTrace)));
+    options.addOption(Poco::Util::Option("serial-startup", "", "initializes components one by one")
+                          .callback(Poco::Util::OptionCallback<App>(this, &App::HandleSerialStartup)));
+    options.addOption(Poco::Util::Option("async-log", "", "writes logs from a background thread")
+                          .callback(Poco::Util::OptionCallback<App>(this, &App::HandleAsyncLog)));
+    options.addOption(Poco::Util::Option("trace-dump", "", "path to trace ring dump written on SIGUSR1 or crash")
+                          .argument("${file}")
+                          .callback(Poco::Util::OptionCallback<App>(this, &App::HandleTraceDump)));
 }
 
 /***********************************************************************************************************************
@@ -228,51 +282,133 @@ void App::Init()
 
     // Initialize Aos modules
 
-    auto config = config::ParseConfig(mConfigFile.empty() ? cDefaultConfigFile : mConfigFile);
+    auto config = mStartupTrace.Run(
+        "config", [this]() { return config::ParseConfig(mConfigFile.empty() ? cDefaultConfigFile : mConfigFile); });
     AOS_ERROR_CHECK_AND_THROW(config.mError, "can't parse config");
 
-    auto err = mDatabase.Init(config.mValue.mDatabase);
-    AOS_ERROR_CHECK_AND_THROW(err, "can't initialize database");
+    if (config.mValue.mEnablePermissionsHandler) {
+        mPermHandler = std::make_unique<permhandler::PermHandler>();
+    }
 
-    err = mNodeInfoProvider.Init(config.mValue.mNodeInfo);
-    AOS_ERROR_CHECK_AND_THROW(err, "can't initialize node info provider");
+    if (!config.mValue.mMetricsServerURL.empty()) {
+        auto err = mMetricsServer.Start(config.mValue.mMetricsServerURL);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't start metrics server");
 
-    err = InitIdentifierModule(config.mValue.mIdentifier);
-    AOS_ERROR_CHECK_AND_THROW(err, "can't initialize identifier module");
+        mCleanupManager.AddCleanup([this]() {
+            if (auto err = mMetricsServer.Stop(); !err.IsNone()) {
+                LOG_ERR() << "Can't stop metrics server: err=" << err;
+            }
+        });
+    }
 
-    if (config.mValue.mEnablePermissionsHandler) {
-        mPermHandler = std::make_unique<permhandler::PermHandler>();
+    // IAM server is started before the identifier and cert modules are ready: it serves requests which don't depend
+    // on them and rejects others with retry hint
+    CreateIdentifierModule(config.mValue.mIdentifier);
+
+    if (mIdentifier) {
+        mIAMServer.SetComponentPending(iamserver::ServerComponent::eIdentifier);
     }
 
-    err = mCryptoProvider.Init();
-    AOS_ERROR_CHECK_AND_THROW(err, "can't initialize crypto provider");
+    mIAMServer.SetComponentPending(iamserver::ServerComponent::eCertificates);
 
-    err = mCertLoader.Init(mCryptoProvider, mPKCS11Manager);
-    AOS_ERROR_CHECK_AND_THROW(err, "can't initialize cert loader");
+    InitGraph graph {mStartupTrace};
+    bool      iamServerStarted = false;
 
-    err = InitCertModules(config.mValue);
-    AOS_ERROR_CHECK_AND_THROW(err, "can't initialize cert modules");
+    graph.Add("database", {}, [&]() {
+        auto err = mDatabase.Init(config.mValue.mDatabase);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't initialize database");
+    });
 
-    err = mNodeManager.Init(mDatabase);
-    AOS_ERROR_CHECK_AND_THROW(err, "can't initialize node manager");
+    graph.Add("nodeinfoprovider", {}, [&]() {
+        auto err = mNodeInfoProvider.Init(config.mValue.mNodeInfo);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't initialize node info provider");
+    });
 
-    err = mProvisionManager.Init(mIAMServer, mCertHandler);
-    AOS_ERROR_CHECK_AND_THROW(err, "can't initialize provision manager");
+    graph.Add("identifier", {}, [&]() {
+        auto err = InitIdentifierModule(config.mValue.mIdentifier);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't initialize identifier module");
+    });
 
-    err = mCertProvider.Init(mCertHandler);
-    AOS_ERROR_CHECK_AND_THROW(err, "can't initialize cert provider");
+    graph.Add("cryptoprovider", {}, [this]() {
+        auto err = mCryptoProvider.Init();
+        AOS_ERROR_CHECK_AND_THROW(err, "can't initialize crypto provider");
+    });
+
+    graph.Add("certloader", {"cryptoprovider"}, [this]() {
+        auto err = mCertLoader.Init(mCryptoProvider, mPKCS11Manager);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't initialize cert loader");
+    });
 
-    err = mIAMServer.Init(config.mValue.mIAMServer, mCertHandler, *mIdentifier, *mPermHandler, mCertLoader,
-        mCryptoProvider, mNodeInfoProvider, mNodeManager, mCertProvider, mProvisionManager, mProvisioning);
-    AOS_ERROR_CHECK_AND_THROW(err, "can't initialize IAM server");
+    // cert loader and cert modules share PKCS11 manager
+    graph.Add("certmodules", {"database", "certloader"}, [&]() {
+        auto err = InitCertModules(config.mValue);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't initialize cert modules");
+    });
+
+    // node manager and IAM server access the database concurrently with cert modules, database serializes the calls
+    graph.Add("nodemanager", {"database"}, [this]() {
+        auto err = mNodeManager.Init(mDatabase);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't initialize node manager");
+    });
+
+    graph.Add("provisionmanager", {"certmodules"}, [this]() {
+        auto err = mProvisionManager.Init(mIAMServer, mCertHandler);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't initialize provision manager");
+    });
+
+    graph.Add("certprovider", {"certmodules"}, [this]() {
+        auto err = mCertProvider.Init(mCertHandler);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't initialize cert provider");
+    });
+
+    graph.Add("iamserver", {"nodeinfoprovider", "nodemanager"}, [&]() {
+        auto err = mIAMServer.Init(config.mValue.mIAMServer, mCertHandler, *mIdentifier, *mPermHandler, mCertLoader,
+            mCryptoProvider, mNodeInfoProvider, mNodeManager, mCertProvider, mProvisionManager, mProvisioning);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't initialize IAM server");
+    });
+
+    graph.Add("iamserver.start", {"iamserver"}, [&]() {
+        auto err = mIAMServer.Start();
+        AOS_ERROR_CHECK_AND_THROW(err, "can't start IAM server");
+
+        iamServerStarted = true;
+    });
+
+    graph.Add("iamserver.certificates", {"iamserver", "certloader", "provisionmanager", "certprovider"}, [this]() {
+        auto err = mIAMServer.SetComponentReady(iamserver::ServerComponent::eCertificates);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't set IAM server certificates");
+    });
 
     const auto& clientConfig = config.mValue.mIAMClient;
     if (!clientConfig.mMainIAMPublicServerURL.empty() && !clientConfig.mMainIAMProtectedServerURL.empty()) {
-        mIAMClient = std::make_unique<iamclient::IAMClient>();
+        graph.Add("iamclient",
+            {"nodeinfoprovider", "identifier", "certloader", "provisionmanager", "certprovider"}, [&]() {
+                mIAMClient = std::make_unique<iamclient::IAMClient>();
+
+                auto err = mIAMClient->Init(clientConfig, mIdentifier.get(), mCertProvider, mProvisionManager,
+                    mCertLoader, mCryptoProvider, mNodeInfoProvider, mProvisioning);
+                AOS_ERROR_CHECK_AND_THROW(err, "can't initialize IAM client");
+            });
+    }
+
+    std::exception_ptr failure;
+
+    try {
+        graph.Run(mSerialStartup);
+    } catch (...) {
+        failure = std::current_exception();
+    }
+
+    if (iamServerStarted) {
+        mCleanupManager.AddCleanup([this]() {
+            if (auto err = mIAMServer.Stop(); !err.IsNone()) {
+                LOG_ERR() << "Can't stop IAM server: err=" << err;
+            }
+        });
+    }
 
-        err = mIAMClient->Init(clientConfig, mIdentifier.get(), mCertProvider, mProvisionManager, mCertLoader,
-            mCryptoProvider, mNodeInfoProvider, mProvisioning);
-        AOS_ERROR_CHECK_AND_THROW(err, "can't initialize IAM client");
+    if (failure) {
+        std::rethrow_exception(failure);
     }
 }
 
@@ -280,36 +416,89 @@ void App::Start()
 {
     LOG_INF() << "Start IAM";
 
+    InitGraph graph {mStartupTrace};
+    bool      nodeInfoProviderStarted = false;
+    bool      identifierStarted       = false;
+    bool      iamClientStarted        = false;
+
+    graph.Add("nodeinfoprovider.start", {}, [&]() {
+        auto err = mNodeInfoProvider.SubscribeNodeInfoUpdated(*this);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't subscribe on node info updates");
+
+        err = mNodeInfoProvider.Start();
+        AOS_ERROR_CHECK_AND_THROW(err, "can't start node info provider");
+
+        nodeInfoProviderStarted = true;
+    });
+
     if (mIdentifier) {
-        auto err = mIdentifier->Start();
-        AOS_ERROR_CHECK_AND_THROW(err, "can't start identifier module");
+        graph.Add("identifier.start", {}, [&]() {
+            auto err = mIdentifier->Start();
+            AOS_ERROR_CHECK_AND_THROW(err, "can't start identifier module");
 
-        mCleanupManager.AddCleanup([this]() {
-            if (auto err = mIdentifier->Stop(); !err.IsNone()) {
-                LOG_ERR() << "Can't stop identifier module: err=" << err;
-            }
+            identifierStarted = true;
+
+            err = mIAMServer.SetComponentReady(iamserver::ServerComponent::eIdentifier);
+            AOS_ERROR_CHECK_AND_THROW(err, "can't set IAM server identifier");
         });
     }
 
-    auto err = mIAMServer.Start();
-    AOS_ERROR_CHECK_AND_THROW(err, "can't start IAM server");
+    if (mIAMClient) {
+        std::vector<std::string> dependencies;
 
-    mCleanupManager.AddCleanup([this]() {
-        if (auto err = mIAMServer.Stop(); !err.IsNone()) {
-            LOG_ERR() << "Can't stop IAM server: err=" << err;
+        if (mIdentifier) {
+            dependencies.push_back("identifier.start");
         }
-    });
 
-    if (mIAMClient) {
-        err = mIAMClient->Start();
-        AOS_ERROR_CHECK_AND_THROW(err, "can't start IAM client");
+        graph.Add("iamclient.start", dependencies, [&]() {
+            auto err = mIAMClient->Start();
+            AOS_ERROR_CHECK_AND_THROW(err, "can't start IAM client");
+
+            iamClientStarted = true;
+        });
+    }
 
+    std::exception_ptr failure;
+
+    try {
+        graph.Run(mSerialStartup);
+    } catch (...) {
+        failure = std::current_exception();
+    }
+
+    // Register cleanups for started components only, in the same order as serial start did
+
+    if (nodeInfoProviderStarted) {
+        mCleanupManager.AddCleanup([this]() {
+            if (auto err = mNodeInfoProvider.Stop(); !err.IsNone()) {
+                LOG_ERR() << "Can't stop node info provider: err=" << err;
+            }
+
+            if (auto err = mNodeInfoProvider.UnsubscribeNodeInfoUpdated(*this); !err.IsNone()) {
+                LOG_ERR() << "Can't unsubscribe from node info updates: err=" << err;
+            }
+        });
+    }
+
+    if (identifierStarted) {
+        mCleanupManager.AddCleanup([this]() {
+            if (auto err = mIdentifier->Stop(); !err.IsNone()) {
+                LOG_ERR() << "Can't stop identifier module: err=" << err;
+            }
+        });
+    }
+
+    if (iamClientStarted) {
         mCleanupManager.AddCleanup([this]() {
             if (auto err = mIAMClient->Stop(); !err.IsNone()) {
                 LOG_ERR() << "Can't stop IAM client: err=" << err;
             }
         });
     }
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
 }
 
 void App::Stop()
@@ -319,6 +508,20 @@ void App::Stop()
     mCleanupManager.ExecuteCleanups();
 }
 
+void App::OnNodeInfoUpdated(const NodeInfo& info)
+{
+    // node manager notifies IAM server subscribers about changed node info
+    if (auto err = mNodeManager.SetNodeInfo(info); !err.IsNone()) {
+        LOG_ERR() << "Can't update node info: err=" << err;
+    }
+
+    if (mIAMClient) {
+        if (auto err = mIAMClient->UpdateNodeInfo(info); !err.IsNone()) {
+            LOG_WRN() << "Can't send node info update: err=" << err;
+        }
+    }
+}
+
 void App::HandleHelp(const std::string& name, const std::string& value)
 {
     (void)name;
@@ -362,6 +565,8 @@ void App::HandleJournal(const std::string& name, const std::string& value)
     (void)name;
     (void)value;
 
+    mJournal = true;
+
     mLogger.SetBackend(common::logger::Logger::Backend::eJournald);
 }
 
@@ -376,7 +581,7 @@ void App::HandleLogLevel(const std::string& name, const std::string& value)
         throw Poco::Exception("unsupported log level", value);
     }
 
-    mLogger.SetLogLevel(level);
+    mLogLevel = level;
 }
 
 void App::HandleConfigFile(const std::string& name, const std::string& value)
@@ -386,6 +591,49 @@ void App::HandleConfigFile(const std::string& name, const std::string& value)
     mConfigFile = value;
 }
 
+void App::HandleStartupTrace(const std::string& name, const std::string& value)
+{
+    (void)name;
+
+    mStartupTraceFile = value;
+}
+
+void App::HandleSerialStartup(const std::string& name, const std::string& value)
+{
+    (void)name;
+    (void)value;
+
+    mSerialStartup = true;
+}
+
+void App::HandleAsyncLog(const std::string& name, const std::string& value)
+{
+    (void)name;
+    (void)value;
+
+    mAsyncLog = true;
+}
+
+void App::HandleTraceDump(const std::string& name, const std::string& value)
+{
+    (void)name;
+
+    tracer::SetDumpPath(value.c_str());
+}
+
+void App::ReportStartupTrace()
+{
+    LOG_INF() << "Startup summary: " << mStartupTrace.Summary().c_str();
+
+    if (mStartupTraceFile.empty()) {
+        return;
+    }
+
+    if (auto err = mStartupTrace.DumpChromeTrace(mStartupTraceFile); !err.IsNone()) {
+        LOG_WRN() << "Can't dump startup trace: file=" << mStartupTraceFile.c_str() << ", err=" << err;
+    }
+}
+
 Error App::InitCertModules(const config::Config& config)
 {
     LOG_DBG() << "Init cert modules: " << config.mCertModules.size();
@@ -422,7 +670,20 @@ Error App::InitCertModules(const config::Config& config)
         auto pkcs11Module = std::make_unique<certhandler::PKCS11Module>();
         auto certModule   = std::make_unique<certhandler::CertModule>();
 
+        // PKCS11 manager and library contexts are shared by all modules and aren't thread safe, so HSMs are
+        // initialized one by one. Init time is logged per module to spot slow tokens.
+        const auto start = std::chrono::steady_clock::now();
+
         err = pkcs11Module->Init(moduleConfig.mID.c_str(), aosParams, mPKCS11Manager, mCryptoProvider);
+
+        const auto end = std::chrono::steady_clock::now();
+
+        mStartupTrace.AddEvent("hsm." + moduleConfig.mID, start, end);
+
+        LOG_INF() << "Cert module HSM initialized: id=" << moduleConfig.mID.c_str()
+                  << ", time=" << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()
+                  << "ms, err=" << err;
+
         if (!err.IsNone()) {
             return AOS_ERROR_WRAP(err);
         }
@@ -445,24 +706,23 @@ Error App::InitCertModules(const config::Config& config)
     return ErrorEnum::eNone;
 }
 
-Error App::InitIdentifierModule(const config::IdentifierConfig& config)
+void App::CreateIdentifierModule(const config::IdentifierConfig& config)
 {
     if (config.mPlugin == "fileidentifier") {
-        auto fileIdentifier = std::make_unique<fileidentifier::FileIdentifier>();
-
-        if (auto err = fileIdentifier->Init(config, mIAMServer); !err.IsNone()) {
-            return err;
-        }
-
-        mIdentifier = std::move(fileIdentifier);
+        mIdentifier = std::make_unique<fileidentifier::FileIdentifier>();
     } else if (config.mPlugin == "visidentifier") {
-        auto visIdentifier = std::make_unique<visidentifier::VISIdentifier>();
+        mIdentifier = std::make_unique<visidentifier::VISIdentifier>();
+    }
+}
 
-        if (auto err = visIdentifier->Init(config, mIAMServer); !err.IsNone()) {
-            return err;
-        }
+Error App::InitIdentifierModule(const config::IdentifierConfig& config)
+{
+    if (config.mPlugin == "fileidentifier") {
+        return static_cast<fileidentifier::FileIdentifier&>(*mIdentifier).Init(config, mIAMServer);
+    }
 
-        mIdentifier = std::move(visIdentifier);
+    if (config.mPlugin == "visidentifier") {
+        return static_cast<visidentifier::VISIdentifier&>(*mIdentifier).Init(config, mIAMServer);
     }
 
     return ErrorEnum::eNone;
@@ -22,7 +22,10 @@
 #include "database/database.hpp"
 #include "iamclient/iamclient.hpp"
 #include "iamserver/iamserver.hpp"
+#include "logger/asynclogger.hpp"
+#include "metrics/metricsserver.hpp"
 #include "nodeinfoprovider/nodeinfoprovider.hpp"
+#include "startuptrace.hpp"
 #include "visidentifier/visidentifier.hpp"
 
 namespace aos::iam::app {
@@ -30,7 +33,7 @@ namespace aos::iam::app {
 /**
  * Aos IAM application.
  */
-class App : public Poco::Util::ServerApplication {
+class App : public Poco::Util::ServerApplication, private nodeinfoprovider::NodeInfoObserverItf {
 protected:
     void initialize(Application& self);
     void uninitialize();
@@ -49,11 +52,20 @@ private:
     void HandleJournal(const std::string& name, const std::string& value);
     void HandleLogLevel(const std::string& name, const std::string& value);
     void HandleConfigFile(const std::string& name, const std::string& value);
+    void HandleStartupTrace(const std::string& name, const std::string& value);
+    void HandleSerialStartup(const std::string& name, const std::string& value);
+    void HandleAsyncLog(const std::string& name, const std::string& value);
+    void HandleTraceDump(const std::string& name, const std::string& value);
+
+    // nodeinfoprovider::NodeInfoObserverItf interface
+    void OnNodeInfoUpdated(const NodeInfo& info) override;
 
     void  Init();
     void  Start();
     void  Stop();
+    void  ReportStartupTrace();
     Error InitCertModules(const config::Config& config);
+    void  CreateIdentifierModule(const config::IdentifierConfig& config);
     Error InitIdentifierModule(const config::IdentifierConfig& config);
 
     crypto::DefaultCryptoProvider mCryptoProvider;
@@ -68,14 +80,22 @@ private:
     provisionmanager::ProvisionManager             mProvisionManager;
     iamserver::IAMServer                           mIAMServer;
     common::logger::Logger                         mLogger;
+    logger::AsyncLogger                            mAsyncLogger;
     std::unique_ptr<permhandler::PermHandler>      mPermHandler;
     std::unique_ptr<iamclient::IAMClient>          mIAMClient;
     std::unique_ptr<identhandler::IdentHandlerItf> mIdentifier;
     aos::common::utils::CleanupManager             mCleanupManager;
+    StartupTrace                                   mStartupTrace;
+    metrics::MetricsServer                         mMetricsServer;
 
     bool        mStopProcessing = false;
     bool        mProvisioning   = false;
+    bool        mSerialStartup  = false;
+    bool        mJournal        = false;
+    bool        mAsyncLog       = false;
+    LogLevel    mLogLevel       = LogLevelEnum::eInfo;
     std::string mConfigFile;
+    std::string mStartupTraceFile;
 };
 
 } // namespace aos::iam::app
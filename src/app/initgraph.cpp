@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include <utils/exception.hpp>
+
+#include "initgraph.hpp"
+#include "logger/logmodule.hpp"
+
+namespace aos::iam::app {
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+InitGraph::InitGraph(StartupTrace& trace)
+    : mTrace(trace)
+{
+}
+
+void InitGraph::Add(const std::string& name, const std::vector<std::string>& dependencies, Action action)
+{
+    // requiring dependencies to be added first makes the graph acyclic and the adding order a valid serial order
+    for (const auto& dependency : dependencies) {
+        if (std::none_of(mComponents.begin(), mComponents.end(),
+                [&dependency](const Component& component) { return component.mName == dependency; })) {
+            AOS_ERROR_THROW(ErrorEnum::eInvalidArgument, "unknown component dependency");
+        }
+    }
+
+    mComponents.push_back({name, dependencies, std::move(action)});
+}
+
+void InitGraph::Run(bool serial)
+{
+    std::mutex                   mutex;
+    std::condition_variable      condVar;
+    std::vector<bool>            started(mComponents.size()), done(mComponents.size());
+    std::vector<std::thread>     threads;
+    std::exception_ptr           failure;
+    size_t                       running = 0;
+    std::unique_lock<std::mutex> lock {mutex};
+
+    while (true) {
+        if (!failure && (!serial || running == 0)) {
+            for (size_t i = 0; i < mComponents.size(); i++) {
+                if (started[i] || !IsReady(mComponents[i], done)) {
+                    continue;
+                }
+
+                started[i] = true;
+                running++;
+
+                threads.emplace_back([&, i]() {
+                    const auto& component = mComponents[i];
+                    const auto  start     = StartupTrace::Clock::now();
+
+                    std::exception_ptr componentFailure;
+
+                    try {
+                        component.mAction();
+                    } catch (...) {
+                        componentFailure = std::current_exception();
+                    }
+
+                    mTrace.AddEvent(component.mName, start, StartupTrace::Clock::now());
+
+                    std::lock_guard componentLock {mutex};
+
+                    if (componentFailure && !failure) {
+                        LOG_ERR() << "Component init failed: component=" << component.mName.c_str();
+
+                        failure = componentFailure;
+                    }
+
+                    done[i] = !componentFailure;
+                    running--;
+
+                    condVar.notify_all();
+                });
+
+                if (serial) {
+                    break;
+                }
+            }
+        }
+
+        if (running == 0) {
+            break;
+        }
+
+        condVar.wait(lock);
+    }
+
+    lock.unlock();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+bool InitGraph::IsReady(const Component& component, const std::vector<bool>& done) const
+{
+    return std::all_of(
+        component.mDependencies.begin(), component.mDependencies.end(), [this, &done](const std::string& dependency) {
+            auto it = std::find_if(mComponents.begin(), mComponents.end(),
+                [&dependency](const Component& item) { return item.mName == dependency; });
+
+            return done[it - mComponents.begin()];
+        });
+}
+
+} // namespace aos::iam::app
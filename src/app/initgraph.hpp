@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef INITGRAPH_HPP_
+#define INITGRAPH_HPP_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "startuptrace.hpp"
+
+namespace aos::iam::app {
+
+/**
+ * Runs application components initialization respecting their dependencies. Components which dependencies are
+ * satisfied run concurrently.
+ */
+class InitGraph {
+public:
+    using Action = std::function<void()>;
+
+    /**
+     * Constructor.
+     *
+     * @param trace startup trace to record component timings.
+     */
+    explicit InitGraph(StartupTrace& trace);
+
+    /**
+     * Adds component.
+     *
+     * @param name component name.
+     * @param dependencies names of components that should be initialized before this one.
+     * @param action component init action, failure is reported by exception.
+     */
+    void Add(const std::string& name, const std::vector<std::string>& dependencies, Action action);
+
+    /**
+     * Runs all components. After the first failure no new components are started, already running ones are waited for
+     * and the failure exception is rethrown.
+     *
+     * @param serial runs components one by one in the order they were added.
+     */
+    void Run(bool serial = false);
+
+private:
+    struct Component {
+        std::string              mName;
+        std::vector<std::string> mDependencies;
+        Action                   mAction;
+    };
+
+    bool IsReady(const Component& component, const std::vector<bool>& done) const;
+
+    StartupTrace&          mTrace;
+    std::vector<Component> mComponents;
+};
+
+} // namespace aos::iam::app
+
+#endif
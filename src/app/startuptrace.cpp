@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+#include <Poco/JSON/Array.h>
+#include <Poco/JSON/Object.h>
+#include <Poco/JSON/Stringifier.h>
+
+#include <utils/exception.hpp>
+
+#include "startuptrace.hpp"
+
+namespace aos::iam::app {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+int64_t ToMicroseconds(StartupTrace::Clock::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+int64_t ToMilliseconds(StartupTrace::Clock::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+StartupTrace::StartupTrace()
+    : mStart(Clock::now())
+{
+}
+
+void StartupTrace::AddEvent(const std::string& name, Clock::time_point start, Clock::time_point end)
+{
+    std::lock_guard lock {mMutex};
+
+    mEvents.push_back({name, start, end - start, GetThreadIndex()});
+}
+
+std::vector<StartupTrace::Event> StartupTrace::GetEvents() const
+{
+    std::vector<Event> events;
+
+    {
+        std::lock_guard lock {mMutex};
+
+        events = mEvents;
+    }
+
+    std::stable_sort(
+        events.begin(), events.end(), [](const Event& lhs, const Event& rhs) { return lhs.mStart < rhs.mStart; });
+
+    return events;
+}
+
+std::string StartupTrace::Summary() const
+{
+    const auto events = GetEvents();
+
+    Clock::time_point end   = mStart;
+    const Event*      worst = nullptr;
+
+    for (const auto& event : events) {
+        end = std::max(end, event.mStart + event.mDuration);
+
+        if (!worst || event.mDuration > worst->mDuration) {
+            worst = &event;
+        }
+    }
+
+    std::ostringstream summary;
+
+    summary << "total=" << ToMilliseconds(end - mStart) << "ms";
+
+    if (worst) {
+        summary << ", slowest=" << worst->mName;
+    }
+
+    summary << ", phases=[";
+
+    for (auto it = events.begin(); it != events.end(); ++it) {
+        summary << (it == events.begin() ? "" : ", ") << it->mName << ":" << ToMilliseconds(it->mDuration) << "ms";
+    }
+
+    summary << "]";
+
+    return summary.str();
+}
+
+Error StartupTrace::DumpChromeTrace(const std::string& path) const
+{
+    try {
+        Poco::JSON::Array traceEvents;
+
+        for (const auto& event : GetEvents()) {
+            Poco::JSON::Object traceEvent;
+
+            traceEvent.set("name", event.mName);
+            traceEvent.set("cat", "startup");
+            traceEvent.set("ph", "X");
+            traceEvent.set("ts", ToMicroseconds(event.mStart - mStart));
+            traceEvent.set("dur", ToMicroseconds(event.mDuration));
+            traceEvent.set("pid", static_cast<int>(getpid()));
+            traceEvent.set("tid", event.mThreadIndex);
+
+            traceEvents.add(traceEvent);
+        }
+
+        Poco::JSON::Object trace;
+
+        trace.set("traceEvents", traceEvents);
+        trace.set("displayTimeUnit", "ms");
+
+        std::ofstream file(path, std::ios_base::out | std::ios_base::trunc);
+        if (!file) {
+            return AOS_ERROR_WRAP(Error(ErrorEnum::eRuntime, "can't create trace file"));
+        }
+
+        Poco::JSON::Stringifier::stringify(trace, file);
+
+        if (!file) {
+            return AOS_ERROR_WRAP(Error(ErrorEnum::eRuntime, "can't write trace file"));
+        }
+    } catch (const std::exception& e) {
+        return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+    }
+
+    return ErrorEnum::eNone;
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+size_t StartupTrace::GetThreadIndex()
+{
+    const auto id = std::this_thread::get_id();
+
+    if (auto it = std::find(mThreads.begin(), mThreads.end(), id); it != mThreads.end()) {
+        return it - mThreads.begin();
+    }
+
+    mThreads.push_back(id);
+
+    return mThreads.size() - 1;
+}
+
+} // namespace aos::iam::app
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef STARTUPTRACE_HPP_
+#define STARTUPTRACE_HPP_
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <aos/common/tools/error.hpp>
+
+namespace aos::iam::app {
+
+/**
+ * Collects timings of application startup phases.
+ */
+class StartupTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Startup phase event.
+     */
+    struct Event {
+        std::string       mName;
+        Clock::time_point mStart;
+        Clock::duration   mDuration;
+        size_t            mThreadIndex;
+    };
+
+    /**
+     * Constructor.
+     */
+    StartupTrace();
+
+    /**
+     * Runs startup phase and records its timing.
+     *
+     * @param name phase name.
+     * @param phase phase function.
+     * @return phase function result.
+     */
+    template <typename F>
+    auto Run(const std::string& name, F&& phase)
+    {
+        const auto start = Clock::now();
+
+        auto result = phase();
+
+        AddEvent(name, start, Clock::now());
+
+        return result;
+    }
+
+    /**
+     * Adds startup phase event.
+     *
+     * @param name phase name.
+     * @param start phase start time.
+     * @param end phase end time.
+     */
+    void AddEvent(const std::string& name, Clock::time_point start, Clock::time_point end);
+
+    /**
+     * Returns recorded events ordered by start time.
+     *
+     * @return std::vector<Event>.
+     */
+    std::vector<Event> GetEvents() const;
+
+    /**
+     * Returns one line startup summary: total time, slowest phase and all phases in start order.
+     *
+     * @return std::string.
+     */
+    std::string Summary() const;
+
+    /**
+     * Dumps recorded events in Chrome trace event format (chrome://tracing, Perfetto).
+     *
+     * @param path output file path.
+     * @return Error.
+     */
+    Error DumpChromeTrace(const std::string& path) const;
+
+private:
+    size_t GetThreadIndex();
+
+    mutable std::mutex           mMutex;
+    Clock::time_point            mStart;
+    std::vector<Event>           mEvents;
+    std::vector<std::thread::id> mThreads;
+};
+
+} // namespace aos::iam::app
+
+#endif
@@ -7,6 +7,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <string>
 #include <unordered_map>
 
 #include <Poco/JSON/Object.h>
@@ -30,8 +31,15 @@ namespace {
 
 constexpr auto cDefaultCPUInfoPath            = "/proc/cpuinfo";
 constexpr auto cDefaultMemInfoPath            = "/proc/meminfo";
+constexpr auto cDefaultStatPath               = "/proc/stat";
+constexpr auto cDefaultProcCGroupPath         = "/proc/self/cgroup";
+constexpr auto cDefaultCGroupRootPath         = "/sys/fs/cgroup";
 constexpr auto cDefaultProvisioningStatusPath = "/var/aos/.provisionstate";
 constexpr auto cDefaultNodeIDPath             = "/etc/machine-id";
+constexpr auto cDefaultPartitionProbeTimeout  = "5s";
+constexpr auto cDefaultPublicServerSocketMode = "0660";
+constexpr auto cDefaultProvisioningCmdTimeout = "10m";
+constexpr auto cDefaultSlowRPCThreshold       = "1s";
 
 /***********************************************************************************************************************
  * Static
@@ -77,6 +85,24 @@ PartitionInfoConfig ParsePartitionInfoConfig(const common::utils::CaseInsensitiv
     return partitionInfoConfig;
 }
 
+ResourceSamplerConfig ParseResourceSamplerConfig(const common::utils::CaseInsensitiveObjectWrapper& object)
+{
+    ResourceSamplerConfig config {};
+
+    if (auto interval = object.GetOptionalValue<std::string>("interval"); interval.has_value()) {
+        Error err;
+
+        Tie(config.mInterval, err) = common::utils::ParseDuration(*interval);
+        AOS_ERROR_CHECK_AND_THROW(err, "resource sampler interval parse error");
+    }
+
+    config.mSampleCPU        = object.GetValue<bool>("sampleCPU", true);
+    config.mSampleRAM        = object.GetValue<bool>("sampleRAM", true);
+    config.mSamplePartitions = object.GetValue<bool>("samplePartitions", true);
+
+    return config;
+}
+
 NodeInfoConfig ParseNodeInfoConfig(const common::utils::CaseInsensitiveObjectWrapper& object)
 {
     NodeInfoConfig nodeInfoConfig {};
@@ -85,12 +111,16 @@ NodeInfoConfig ParseNodeInfoConfig(const common::utils::CaseInsensitiveObjectWra
         = object.GetValue<std::string>("provisioningStatePath", cDefaultProvisioningStatusPath);
     nodeInfoConfig.mCPUInfoPath = object.GetValue<std::string>("cpuInfoPath", cDefaultCPUInfoPath);
     nodeInfoConfig.mMemInfoPath = object.GetValue<std::string>("memInfoPath", cDefaultMemInfoPath);
+    nodeInfoConfig.mStatPath    = object.GetValue<std::string>("statPath", cDefaultStatPath);
     nodeInfoConfig.mNodeIDPath  = object.GetValue<std::string>("nodeIDPath", cDefaultNodeIDPath);
     nodeInfoConfig.mNodeName    = object.GetValue<std::string>("nodeName");
     nodeInfoConfig.mNodeType    = object.GetValue<std::string>("nodeType");
     nodeInfoConfig.mOSType      = object.GetValue<std::string>("osType");
     nodeInfoConfig.mMaxDMIPS    = object.GetValue<uint64_t>("maxDMIPS");
 
+    nodeInfoConfig.mProcCGroupPath = object.GetValue<std::string>("procCGroupPath", cDefaultProcCGroupPath);
+    nodeInfoConfig.mCGroupRootPath = object.GetValue<std::string>("cgroupRootPath", cDefaultCGroupRootPath);
+
     if (object.Has("attrs")) {
         for (const auto& [key, value] : *object.Get("attrs").extract<Poco::JSON::Object::Ptr>()) {
             nodeInfoConfig.mAttrs.emplace(key, value.extract<std::string>());
@@ -105,6 +135,16 @@ NodeInfoConfig ParseNodeInfoConfig(const common::utils::CaseInsensitiveObjectWra
             });
     }
 
+    Error err;
+
+    Tie(nodeInfoConfig.mPartitionProbeTimeout, err) = common::utils::ParseDuration(
+        object.GetOptionalValue<std::string>("partitionProbeTimeout").value_or(cDefaultPartitionProbeTimeout));
+    AOS_ERROR_CHECK_AND_THROW(err, "partitionProbeTimeout parse error");
+
+    if (object.Has("resourceSampler")) {
+        nodeInfoConfig.mResourceSampler = ParseResourceSamplerConfig(object.GetObject("resourceSampler"));
+    }
+
     return nodeInfoConfig;
 }
 
@@ -123,6 +163,13 @@ IAMConfig ParseIAMConfig(const common::utils::CaseInsensitiveObjectWrapper& obje
     config.mDeprovisionCmdArgs        = common::utils::GetArrayValue<std::string>(
         object, "deprovisionCmdArgs", [](const Poco::Dynamic::Var& value) { return value.convert<std::string>(); });
 
+    Error err;
+
+    // zero timeout disables provisioning command timeout
+    Tie(config.mProvisioningCmdTimeout, err) = common::utils::ParseDuration(
+        object.GetOptionalValue<std::string>("provisioningCmdTimeout").value_or(cDefaultProvisioningCmdTimeout));
+    AOS_ERROR_CHECK_AND_THROW(err, "provisioningCmdTimeout parse error");
+
     return config;
 }
 
@@ -142,6 +189,18 @@ IAMClientConfig ParseIAMClientConfig(const common::utils::CaseInsensitiveObjectW
     return config;
 }
 
+GRPCServerConfig ParseGRPCServerConfig(const common::utils::CaseInsensitiveObjectWrapper& object)
+{
+    GRPCServerConfig config {};
+
+    config.mMaxThreads           = object.GetValue<int>("maxThreads", 0);
+    config.mNumCQs               = object.GetValue<int>("numCQs", 0);
+    config.mMaxMessageSize       = object.GetValue<int>("maxMessageSize", 0);
+    config.mMaxConcurrentStreams = object.GetValue<int>("maxConcurrentStreams", 0);
+
+    return config;
+}
+
 IAMServerConfig ParseIAMServerConfig(const common::utils::CaseInsensitiveObjectWrapper& object)
 {
     IAMServerConfig config;
@@ -149,6 +208,22 @@ IAMServerConfig ParseIAMServerConfig(const common::utils::CaseInsensitiveObjectW
 
     config.mIAMPublicServerURL    = object.GetValue<std::string>("iamPublicServerURL");
     config.mIAMProtectedServerURL = object.GetValue<std::string>("iamProtectedServerURL");
+    config.mIAMPublicServerSocket = object.GetValue<std::string>("iamPublicServerSocket");
+
+    // socket mode is an octal string, e.g. "0660"
+    config.mIAMPublicServerSocketMode = std::stoul(
+        object.GetValue<std::string>("iamPublicServerSocketMode", cDefaultPublicServerSocketMode), nullptr, 8);
+
+    Error err;
+
+    // zero threshold disables slow RPC reporting
+    Tie(config.mSlowRPCThreshold, err) = common::utils::ParseDuration(
+        object.GetOptionalValue<std::string>("slowRPCThreshold").value_or(cDefaultSlowRPCThreshold));
+    AOS_ERROR_CHECK_AND_THROW(err, "slowRPCThreshold parse error");
+
+    if (object.Has("grpcServer")) {
+        config.mGRPCServer = ParseGRPCServerConfig(object.GetObject("grpcServer"));
+    }
 
     return config;
 }
@@ -213,6 +288,7 @@ RetWithError<Config> ParseConfig(const std::string& filename)
         config.mIAMServer                = ParseIAMServerConfig(object);
         config.mDatabase                 = ParseDatabaseConfig(object, config.mCertModules);
         config.mEnablePermissionsHandler = object.GetValue<bool>("enablePermissionsHandler");
+        config.mMetricsServerURL         = object.GetValue<std::string>("metricsServerURL");
 
         if (object.Has("identifier")) {
             config.mIdentifier = ParseIdentifier(object.GetObject("identifier"));
@@ -89,12 +89,25 @@ struct PartitionInfoConfig {
     std::string              mPath;
 };
 
+/*
+ * Resource sampler configuration.
+ */
+struct ResourceSamplerConfig {
+    Duration mInterval         = {};
+    bool     mSampleCPU        = true;
+    bool     mSampleRAM        = true;
+    bool     mSamplePartitions = true;
+};
+
 /*
  * Node information configuration.
  */
 struct NodeInfoConfig {
     std::string                                  mCPUInfoPath;
     std::string                                  mMemInfoPath;
+    std::string                                  mStatPath;
+    std::string                                  mProcCGroupPath;
+    std::string                                  mCGroupRootPath;
     std::string                                  mProvisioningStatePath;
     std::string                                  mNodeIDPath;
     std::string                                  mNodeName;
@@ -103,6 +116,8 @@ struct NodeInfoConfig {
     uint64_t                                     mMaxDMIPS;
     std::unordered_map<std::string, std::string> mAttrs;
     std::vector<PartitionInfoConfig>             mPartitions;
+    Duration                                     mPartitionProbeTimeout;
+    ResourceSamplerConfig                        mResourceSampler;
 };
 
 /**
@@ -125,6 +140,7 @@ struct IAMConfig {
     std::vector<std::string> mDiskEncryptionCmdArgs;
     std::vector<std::string> mFinishProvisioningCmdArgs;
     std::vector<std::string> mDeprovisionCmdArgs;
+    Duration                 mProvisioningCmdTimeout {};
 };
 
 /**
@@ -137,11 +153,28 @@ struct IAMClientConfig : IAMConfig {
 };
 
 /**
- * Configuration for IAM client.
+ * gRPC server resource limits. Zero value keeps gRPC default. Max threads is shared by all IAM servers.
+ */
+struct GRPCServerConfig {
+    int mMaxThreads           = 0;
+    int mNumCQs               = 0;
+    int mMaxMessageSize       = 0;
+    int mMaxConcurrentStreams = 0;
+};
+
+/**
+ * Configuration for IAM server.
+ *
+ * Public and protected servers use TLS, so nothing is served before certificates are ready unless
+ * IAMPublicServerSocket is set: the public services are served over this local socket from the start.
  */
 struct IAMServerConfig : IAMConfig {
-    std::string mIAMPublicServerURL;
-    std::string mIAMProtectedServerURL;
+    std::string      mIAMPublicServerURL;
+    std::string      mIAMProtectedServerURL;
+    std::string      mIAMPublicServerSocket;
+    uint32_t         mIAMPublicServerSocketMode = 0;
+    Duration         mSlowRPCThreshold {};
+    GRPCServerConfig mGRPCServer;
 };
 
 /*
@@ -155,6 +188,7 @@ struct Config {
     IdentifierConfig          mIdentifier;
     std::vector<ModuleConfig> mCertModules;
     bool                      mEnablePermissionsHandler;
+    std::string               mMetricsServerURL;
 };
 
 /*******************************************************************************
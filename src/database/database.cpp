@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 #include <filesystem>
+#include <optional>
 
 #include <Poco/Data/SQLite/Connector.h>
 #include <Poco/JSON/Parser.h>
@@ -16,6 +17,8 @@
 
 #include "database.hpp"
 #include "logger/logmodule.hpp"
+#include "metrics/metrics.hpp"
+#include "tracer/tracer.hpp"
 
 using namespace Poco::Data::Keywords;
 
@@ -34,6 +37,25 @@ inline std::string Stringify(const Poco::JSON::Object& json)
     return oss.str();
 }
 
+/**
+ * Records database operation to the trace ring and to the operation duration metric.
+ */
+class OperationScope {
+public:
+    explicit OperationScope(const char* operation)
+        : mTraceEvent(tracer::EventType::eDBOp, operation)
+    {
+        if (metrics::IsEnabled()) {
+            mTimer.emplace(metrics::GetRegistry().GetHistogram(
+                "aos_iam_db_duration_seconds", "Database operation duration", {{"op", operation}}));
+        }
+    }
+
+private:
+    tracer::ScopedEvent                 mTraceEvent;
+    std::optional<metrics::ScopedTimer> mTimer;
+};
+
 /***********************************************************************************************************************
  * Public
  **********************************************************************************************************************/
@@ -45,6 +67,8 @@ Database::Database()
 
 Error Database::Init(const config::DatabaseConfig& config)
 {
+    std::lock_guard lock {mMutex};
+
     if (mSession && mSession->isConnected()) {
         return ErrorEnum::eNone;
     }
@@ -77,6 +101,9 @@ Error Database::Init(const config::DatabaseConfig& config)
 
 Error Database::AddCertInfo(const String& certType, const iam::certhandler::CertInfo& certInfo)
 {
+    std::lock_guard lock {mMutex};
+    OperationScope operation {"AddCertInfo"};
+
     try {
         *mSession
             << "INSERT INTO certificates (type, issuer, serial, certURL, keyURL, notAfter) VALUES (?, ?, ?, ?, ?, ?);",
@@ -90,6 +117,9 @@ Error Database::AddCertInfo(const String& certType, const iam::certhandler::Cert
 
 Error Database::RemoveCertInfo(const String& certType, const String& certURL)
 {
+    std::lock_guard lock {mMutex};
+    OperationScope operation {"RemoveCertInfo"};
+
     try {
         *mSession << "DELETE FROM certificates WHERE type = ? AND certURL = ?;", bind(certType.CStr()),
             bind(certURL.CStr()), now;
@@ -102,6 +132,9 @@ Error Database::RemoveCertInfo(const String& certType, const String& certURL)
 
 Error Database::RemoveAllCertsInfo(const String& certType)
 {
+    std::lock_guard lock {mMutex};
+    OperationScope operation {"RemoveAllCertsInfo"};
+
     try {
         *mSession << "DELETE FROM certificates WHERE type = ?;", bind(certType.CStr()), now;
     } catch (const std::exception& e) {
@@ -114,6 +147,9 @@ Error Database::RemoveAllCertsInfo(const String& certType)
 Error Database::GetCertInfo(
     const Array<uint8_t>& issuer, const Array<uint8_t>& serial, iam::certhandler::CertInfo& cert)
 {
+    std::lock_guard lock {mMutex};
+    OperationScope operation {"GetCertInfo"};
+
     try {
         CertInfo              result;
         Poco::Data::Statement statement {*mSession};
@@ -136,6 +172,9 @@ Error Database::GetCertInfo(
 
 Error Database::GetCertsInfo(const String& certType, Array<iam::certhandler::CertInfo>& certsInfo)
 {
+    std::lock_guard lock {mMutex};
+    OperationScope operation {"GetCertsInfo"};
+
     try {
         std::vector<CertInfo> result;
 
@@ -172,6 +211,9 @@ Database::~Database()
 
 Error Database::SetNodeInfo(const NodeInfo& info)
 {
+    std::lock_guard lock {mMutex};
+    OperationScope operation {"SetNodeInfo"};
+
     try {
         Poco::JSON::Object pocoNodeInfo;
         const auto         nodeInfo = Stringify(ConvertNodeInfoToJSON(info));
@@ -187,6 +229,9 @@ Error Database::SetNodeInfo(const NodeInfo& info)
 
 Error Database::GetNodeInfo(const String& nodeID, NodeInfo& nodeInfo) const
 {
+    std::lock_guard lock {mMutex};
+    OperationScope operation {"GetNodeInfo"};
+
     try {
         Poco::Data::Statement       statement {*mSession};
         Poco::Nullable<std::string> pocoInfo;
@@ -221,6 +266,9 @@ Error Database::GetNodeInfo(const String& nodeID, NodeInfo& nodeInfo) const
 
 Error Database::GetAllNodeIds(Array<StaticString<cNodeIDLen>>& ids) const
 {
+    std::lock_guard lock {mMutex};
+    OperationScope operation {"GetAllNodeIds"};
+
     try {
         Poco::Data::Statement    statement {*mSession};
         std::vector<std::string> storedIds;
@@ -244,6 +292,9 @@ Error Database::GetAllNodeIds(Array<StaticString<cNodeIDLen>>& ids) const
 
 Error Database::RemoveNodeInfo(const String& nodeID)
 {
+    std::lock_guard lock {mMutex};
+    OperationScope operation {"RemoveNodeInfo"};
+
     try {
         *mSession << "DELETE FROM nodeinfo WHERE id = ?;", bind(nodeID.CStr()), now;
     } catch (const std::exception& e) {
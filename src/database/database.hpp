@@ -9,6 +9,7 @@
 #define DATABASE_HPP_
 
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 
@@ -158,6 +159,8 @@ private:
     static Poco::JSON::Array ConvertAttributesToJSON(const Array<NodeAttribute>& attributes);
     static Error             ConvertAttributesFromJSON(const Poco::JSON::Array& src, Array<NodeAttribute>& dst);
 
+    // session is shared by components running on different threads, e.g. cert modules and node manager
+    mutable std::mutex                          mMutex;
     std::unique_ptr<Poco::Data::Session>        mSession;
     std::optional<common::migration::Migration> mDatabase;
 };
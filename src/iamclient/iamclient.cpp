@@ -16,10 +16,67 @@
 #include <utils/grpchelper.hpp>
 
 #include "iamclient.hpp"
+#include "iamserver/allcerttypes.hpp"
 #include "logger/logmodule.hpp"
+#include "metrics/metrics.hpp"
+#include "tracer/protocarrier.hpp"
 
 namespace aos::iam::iamclient {
 
+namespace {
+
+/***********************************************************************************************************************
+ * Constants
+ **********************************************************************************************************************/
+
+constexpr auto   cSSLSessionCacheSize = 4;
+constexpr size_t cMaxKeyTasks         = 8;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+std::shared_ptr<grpc_ssl_session_cache> CreateSSLSessionCache()
+{
+    return {grpc_ssl_session_cache_create_lru(cSSLSessionCacheSize), grpc_ssl_session_cache_destroy};
+}
+
+metrics::Gauge& ConnectedGauge()
+{
+    static auto& gauge = metrics::GetRegistry().GetGauge("aos_iam_client_connected", "Connected to main IAM");
+
+    return gauge;
+}
+
+metrics::Counter& ConnectionsCounter()
+{
+    static auto& counter = metrics::GetRegistry().GetCounter(
+        "aos_iam_client_connections_total", "Number of established connections to main IAM");
+
+    return counter;
+}
+
+metrics::Histogram& RequestDurationHistogram()
+{
+    static auto& histogram = metrics::GetRegistry().GetHistogram(
+        "aos_iam_client_request_duration_seconds", "Main IAM request processing duration");
+
+    return histogram;
+}
+
+std::optional<std::chrono::steady_clock::time_point> GetRequestDeadline(
+    const iamanager::v5::IAMIncomingMessages& message)
+{
+    auto timeout = tracer::ExtractDeadline(message);
+    if (!timeout.has_value()) {
+        return std::nullopt;
+    }
+
+    return std::chrono::steady_clock::now() + *timeout;
+}
+
+} // namespace
+
 /***********************************************************************************************************************
  * Public
  **********************************************************************************************************************/
@@ -37,6 +94,7 @@ Error IAMClient::Init(const config::IAMClientConfig& config, identhandler::Ident
     mProvisionManager  = &provisionManager;
     mReconnectInterval = config.mNodeReconnectInterval;
     mCACert            = config.mCACert;
+    mSSLSessionCache   = CreateSSLSessionCache();
 
     if (provisioningMode) {
         mCredentialList.push_back(grpc::InsecureChannelCredentials());
@@ -118,6 +176,28 @@ Error IAMClient::Stop()
     return err;
 }
 
+Error IAMClient::UpdateNodeInfo(const NodeInfo& info)
+{
+    iamanager::v5::IAMOutgoingMessages outgoingMsg;
+
+    *outgoingMsg.mutable_node_info() = common::pbconvert::ConvertToProto(info);
+
+    std::lock_guard lock {mWriteMutex};
+
+    // node info is sent on registration, updates are sent only to established stream
+    if (!mConnected) {
+        return ErrorEnum::eNone;
+    }
+
+    LOG_DBG() << "Send node info update: status=" << info.mStatus;
+
+    if (!mStream->Write(outgoingMsg)) {
+        return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "stream closed before sending node info"));
+    }
+
+    return ErrorEnum::eNone;
+}
+
 /***********************************************************************************************************************
  * Private
  **********************************************************************************************************************/
@@ -130,6 +210,9 @@ void IAMClient::OnCertChanged(const certhandler::CertInfo& info)
     mCredentialList.push_back(
         common::utils::GetMTLSClientCredentials(info, mCACert.c_str(), *mCertLoader, *mCryptoProvider));
 
+    // sessions established with the previous certificate must not be resumed
+    mSSLSessionCache = CreateSSLSessionCache();
+
     mCredentialListUpdated = true;
 }
 
@@ -141,7 +224,16 @@ std::unique_ptr<grpc::ClientContext> IAMClient::CreateClientContext()
 PublicNodeServiceStubPtr IAMClient::CreateStub(
     const std::string& url, const std::shared_ptr<grpc::ChannelCredentials>& credentials)
 {
-    auto channel = grpc::CreateCustomChannel(url, credentials, grpc::ChannelArguments());
+    grpc::ChannelArguments args;
+
+    // reconnects resume TLS session instead of full mTLS handshake with HSM backed key
+    if (mSSLSessionCache) {
+        auto arg = grpc_ssl_session_cache_create_channel_arg(mSSLSessionCache.get());
+
+        args.SetPointerWithVtable(arg.key, arg.value.pointer.p, arg.value.pointer.vtable);
+    }
+
+    auto channel = grpc::CreateCustomChannel(url, credentials, args);
     if (!channel) {
         LOG_ERR() << "Can't create client channel";
 
@@ -168,7 +260,13 @@ bool IAMClient::RegisterNode(const std::string& url)
         }
 
         mRegisterNodeCtx = CreateClientContext();
-        mStream          = mPublicNodeServiceStub->RegisterNode(mRegisterNodeCtx.get());
+
+        {
+            std::lock_guard writeLock {mWriteMutex};
+
+            mStream = mPublicNodeServiceStub->RegisterNode(mRegisterNodeCtx.get());
+        }
+
         if (!mStream) {
             LOG_ERR() << "Stream creation problem";
 
@@ -184,6 +282,7 @@ bool IAMClient::RegisterNode(const std::string& url)
         LOG_DBG() << "Connection established";
 
         mCredentialListUpdated = false;
+        mConnected             = true;
 
         return true;
     }
@@ -199,11 +298,17 @@ void IAMClient::ConnectionLoop() noexcept
         LOG_DBG() << "Connecting to IAMServer...";
 
         if (RegisterNode(mServerURL)) {
+            metrics::ScopedGauge connected {ConnectedGauge()};
+
+            ConnectionsCounter().Inc();
+
             HandleIncomingMessages();
 
             LOG_DBG() << "IAMClient connection closed";
         }
 
+        mConnected = false;
+
         std::unique_lock lock {mMutex};
 
         mCondVar.wait_for(lock, std::chrono::nanoseconds(mReconnectInterval.Nanoseconds()), [this]() { return mStop; });
@@ -219,28 +324,46 @@ void IAMClient::HandleIncomingMessages() noexcept
 {
     try {
         iamanager::v5::IAMIncomingMessages incomingMsg;
+        std::vector<std::future<bool>>     keyTasks;
+
+        auto waitKeyTasks = [&keyTasks]() {
+            auto ok = true;
+
+            for (auto& task : keyTasks) {
+                ok = task.get() && ok;
+            }
+
+            keyTasks.clear();
+
+            return ok;
+        };
 
         while (mStream->Read(&incomingMsg)) {
             bool ok = true;
 
-            if (incomingMsg.has_start_provisioning_request()) {
-                ok = ProcessStartProvisioning(incomingMsg.start_provisioning_request());
-            } else if (incomingMsg.has_finish_provisioning_request()) {
-                ok = ProcessFinishProvisioning(incomingMsg.finish_provisioning_request());
-            } else if (incomingMsg.has_deprovision_request()) {
-                ok = ProcessDeprovision(incomingMsg.deprovision_request());
-            } else if (incomingMsg.has_pause_node_request()) {
-                ok = ProcessPauseNode(incomingMsg.pause_node_request());
-            } else if (incomingMsg.has_resume_node_request()) {
-                ok = ProcessResumeNode(incomingMsg.resume_node_request());
-            } else if (incomingMsg.has_create_key_request()) {
-                ok = ProcessCreateKey(incomingMsg.create_key_request());
-            } else if (incomingMsg.has_apply_cert_request()) {
-                ok = ProcessApplyCert(incomingMsg.apply_cert_request());
-            } else if (incomingMsg.has_get_cert_types_request()) {
-                ok = ProcessGetCertTypes(incomingMsg.get_cert_types_request());
+            if (incomingMsg.has_create_key_request()) {
+                ok = keyTasks.size() < cMaxKeyTasks || waitKeyTasks();
+
+                // key generation may take long on HSM, keys of different cert types are generated concurrently
+                keyTasks.push_back(std::async(std::launch::async,
+                    [this, request = incomingMsg.create_key_request(), parent = tracer::ExtractSpanContext(incomingMsg),
+                        deadline = GetRequestDeadline(incomingMsg)]() {
+                        metrics::ScopedTimer timer {RequestDurationHistogram()};
+                        tracer::Span         span {"create_key_request", parent};
+
+                        // main IAM has already failed the request, generating the key is a waste of HSM time
+                        if (deadline.has_value() && std::chrono::steady_clock::now() >= *deadline) {
+                            LOG_WRN() << "Create key request deadline exceeded: type=" << request.type().c_str();
+
+                            return SendCreateKeyResponse(request.node_id().c_str(), request.type().c_str(), {},
+                                AOS_ERROR_WRAP(Error(ErrorEnum::eTimeout, "request deadline exceeded")));
+                        }
+
+                        return ProcessCreateKey(request);
+                    }));
             } else {
-                AOS_ERROR_CHECK_AND_THROW(ErrorEnum::eNotSupported, "Not supported request type");
+                // other requests may depend on the generated keys
+                ok = waitKeyTasks() && ProcessIncomingMessage(incomingMsg);
             }
 
             if (!ok) {
@@ -259,11 +382,55 @@ void IAMClient::HandleIncomingMessages() noexcept
                 }
             }
         }
+
+        waitKeyTasks();
     } catch (const std::exception& e) {
         LOG_ERR() << "Failed to handle incoming message: err=" << common::utils::ToAosError(e);
     }
 }
 
+bool IAMClient::ProcessIncomingMessage(const iamanager::v5::IAMIncomingMessages& incomingMsg)
+{
+    metrics::ScopedTimer timer {RequestDurationHistogram()};
+
+    // continue the trace started by main IAM, span is named after the request field
+    const auto requestField = incomingMsg.GetDescriptor()->FindFieldByNumber(incomingMsg.IAMIncomingMessage_case());
+    tracer::Span span {
+        requestField ? requestField->name().c_str() : "unknown", tracer::ExtractSpanContext(incomingMsg)};
+
+    if (incomingMsg.has_start_provisioning_request()) {
+        return ProcessStartProvisioning(incomingMsg.start_provisioning_request());
+    }
+
+    if (incomingMsg.has_finish_provisioning_request()) {
+        return ProcessFinishProvisioning(incomingMsg.finish_provisioning_request());
+    }
+
+    if (incomingMsg.has_deprovision_request()) {
+        return ProcessDeprovision(incomingMsg.deprovision_request());
+    }
+
+    if (incomingMsg.has_pause_node_request()) {
+        return ProcessPauseNode(incomingMsg.pause_node_request());
+    }
+
+    if (incomingMsg.has_resume_node_request()) {
+        return ProcessResumeNode(incomingMsg.resume_node_request());
+    }
+
+    if (incomingMsg.has_apply_cert_request()) {
+        return ProcessApplyCert(incomingMsg.apply_cert_request());
+    }
+
+    if (incomingMsg.has_get_cert_types_request()) {
+        return ProcessGetCertTypes(incomingMsg.get_cert_types_request());
+    }
+
+    AOS_ERROR_CHECK_AND_THROW(ErrorEnum::eNotSupported, "Not supported request type");
+
+    return false;
+}
+
 bool IAMClient::SendNodeInfo()
 {
     auto                               nodeInfo = std::make_unique<NodeInfo>();
@@ -280,7 +447,7 @@ bool IAMClient::SendNodeInfo()
 
     LOG_DBG() << "Send node info: status=" << nodeInfo->mStatus;
 
-    bool isOK = mStream->Write(outgoingMsg);
+    bool isOK = WriteMessage(outgoingMsg);
     if (!isOK) {
         LOG_WRN() << "Stream closed before sending node info";
     }
@@ -301,13 +468,13 @@ bool IAMClient::ProcessStartProvisioning(const iamanager::v5::StartProvisioningR
 
         common::pbconvert::SetErrorInfo(err, response);
 
-        return mStream->Write(outgoingMsg);
+        return WriteMessage(outgoingMsg);
     }
 
     err = mProvisionManager->StartProvisioning(request.password().c_str());
     common::pbconvert::SetErrorInfo(err, response);
 
-    return mStream->Write(outgoingMsg);
+    return WriteMessage(outgoingMsg);
 }
 
 bool IAMClient::ProcessFinishProvisioning(const iamanager::v5::FinishProvisioningRequest& request)
@@ -323,26 +490,26 @@ bool IAMClient::ProcessFinishProvisioning(const iamanager::v5::FinishProvisionin
 
         common::pbconvert::SetErrorInfo(err, response);
 
-        return mStream->Write(outgoingMsg);
+        return WriteMessage(outgoingMsg);
     }
 
     err = mProvisionManager->FinishProvisioning(request.password().c_str());
     if (!err.IsNone()) {
         common::pbconvert::SetErrorInfo(err, response);
 
-        return mStream->Write(outgoingMsg);
+        return WriteMessage(outgoingMsg);
     }
 
     err = mNodeInfoProvider->SetNodeStatus(NodeStatusEnum::eProvisioned);
     if (!err.IsNone()) {
         common::pbconvert::SetErrorInfo(err, response);
 
-        return mStream->Write(outgoingMsg);
+        return WriteMessage(outgoingMsg);
     }
 
     common::pbconvert::SetErrorInfo(err, response);
 
-    return mStream->Write(outgoingMsg);
+    return WriteMessage(outgoingMsg);
 }
 
 bool IAMClient::ProcessDeprovision(const iamanager::v5::DeprovisionRequest& request)
@@ -358,26 +525,26 @@ bool IAMClient::ProcessDeprovision(const iamanager::v5::DeprovisionRequest& requ
 
         common::pbconvert::SetErrorInfo(err, response);
 
-        return mStream->Write(outgoingMsg);
+        return WriteMessage(outgoingMsg);
     }
 
     err = mProvisionManager->Deprovision(request.password().c_str());
     if (!err.IsNone()) {
         common::pbconvert::SetErrorInfo(err, response);
 
-        return mStream->Write(outgoingMsg);
+        return WriteMessage(outgoingMsg);
     }
 
     err = mNodeInfoProvider->SetNodeStatus(NodeStatusEnum::eUnprovisioned);
     if (!err.IsNone()) {
         common::pbconvert::SetErrorInfo(err, response);
 
-        return mStream->Write(outgoingMsg);
+        return WriteMessage(outgoingMsg);
     }
 
     common::pbconvert::SetErrorInfo(err, response);
 
-    return mStream->Write(outgoingMsg);
+    return WriteMessage(outgoingMsg);
 }
 
 bool IAMClient::ProcessPauseNode(const iamanager::v5::PauseNodeRequest& request)
@@ -395,19 +562,19 @@ bool IAMClient::ProcessPauseNode(const iamanager::v5::PauseNodeRequest& request)
 
         common::pbconvert::SetErrorInfo(err, response);
 
-        return mStream->Write(outgoingMsg);
+        return WriteMessage(outgoingMsg);
     }
 
     err = mNodeInfoProvider->SetNodeStatus(NodeStatusEnum::ePaused);
     if (!err.IsNone()) {
         common::pbconvert::SetErrorInfo(err, response);
 
-        return mStream->Write(outgoingMsg);
+        return WriteMessage(outgoingMsg);
     }
 
     common::pbconvert::SetErrorInfo(err, response);
 
-    return SendNodeInfo() && mStream->Write(outgoingMsg);
+    return SendNodeInfo() && WriteMessage(outgoingMsg);
 }
 
 bool IAMClient::ProcessResumeNode(const iamanager::v5::ResumeNodeRequest& request)
@@ -425,25 +592,82 @@ bool IAMClient::ProcessResumeNode(const iamanager::v5::ResumeNodeRequest& reques
 
         common::pbconvert::SetErrorInfo(err, response);
 
-        return mStream->Write(outgoingMsg);
+        return WriteMessage(outgoingMsg);
     }
 
     err = mNodeInfoProvider->SetNodeStatus(NodeStatusEnum::eProvisioned);
     if (!err.IsNone()) {
         common::pbconvert::SetErrorInfo(err, response);
 
-        return mStream->Write(outgoingMsg);
+        return WriteMessage(outgoingMsg);
     }
 
     common::pbconvert::SetErrorInfo(err, response);
 
-    return SendNodeInfo() && mStream->Write(outgoingMsg);
+    return SendNodeInfo() && WriteMessage(outgoingMsg);
 }
 
 bool IAMClient::ProcessCreateKey(const iamanager::v5::CreateKeyRequest& request)
 {
-    const String               nodeID   = request.node_id().c_str();
-    const String               certType = request.type().c_str();
+    if (iamserver::IsAllCertTypes(request)) {
+        return ProcessCreateKeysForAllCertTypes(request);
+    }
+
+    const String nodeID   = request.node_id().c_str();
+    const String certType = request.type().c_str();
+
+    auto csr = std::make_unique<StaticString<crypto::cCSRPEMLen>>();
+    auto err = CreateKey(certType, request, *csr);
+
+    return SendCreateKeyResponse(nodeID, certType, *csr, err);
+}
+
+bool IAMClient::ProcessCreateKeysForAllCertTypes(const iamanager::v5::CreateKeyRequest& request)
+{
+    const String nodeID = request.node_id().c_str();
+
+    LOG_DBG() << "Process create key request for all cert types";
+
+    auto [certTypes, err] = mProvisionManager->GetCertTypes();
+    if (!err.IsNone()) {
+        LOG_ERR() << "Get certificate types failed: error=" << AOS_ERROR_WRAP(err);
+
+        return SendCreateKeyResponse(nodeID, {}, {}, AOS_ERROR_WRAP(err));
+    }
+
+    std::vector<std::future<iamanager::v5::CreateKeyResponse>> keys;
+
+    // key generation may take long on HSM, keys of different cert types are generated concurrently
+    for (const auto& type : certTypes) {
+        keys.push_back(std::async(std::launch::async, [this, &request, certType = std::string(type.CStr())]() {
+            iamanager::v5::CreateKeyResponse response;
+
+            auto csr = std::make_unique<StaticString<crypto::cCSRPEMLen>>();
+
+            common::pbconvert::SetErrorInfo(CreateKey(certType.c_str(), request, *csr), response);
+
+            response.set_node_id(request.node_id());
+            response.set_type(certType);
+            response.set_csr(csr->CStr());
+
+            return response;
+        }));
+    }
+
+    iamanager::v5::IAMOutgoingMessages outgoingMsg;
+    auto&                              response = *outgoingMsg.mutable_create_key_response();
+
+    response.set_node_id(nodeID.CStr());
+
+    for (auto& key : keys) {
+        iamserver::AddCertTypeResponse(response, key.get());
+    }
+
+    return WriteMessage(outgoingMsg);
+}
+
+Error IAMClient::CreateKey(const String& certType, const iamanager::v5::CreateKeyRequest& request, String& csr)
+{
     StaticString<cSystemIDLen> subject  = request.subject().c_str();
     const String               password = request.password().c_str();
 
@@ -452,7 +676,7 @@ bool IAMClient::ProcessCreateKey(const iamanager::v5::CreateKeyRequest& request)
     if (subject.IsEmpty() && !mIdentHandler) {
         LOG_ERR() << "Subject can't be empty";
 
-        return SendCreateKeyResponse(nodeID, certType, {}, AOS_ERROR_WRAP(ErrorEnum::eInvalidArgument));
+        return AOS_ERROR_WRAP(ErrorEnum::eInvalidArgument);
     }
 
     Error err = ErrorEnum::eNone;
@@ -462,15 +686,11 @@ bool IAMClient::ProcessCreateKey(const iamanager::v5::CreateKeyRequest& request)
         if (!err.IsNone()) {
             LOG_ERR() << "Getting system ID error: error=" << AOS_ERROR_WRAP(err);
 
-            return SendCreateKeyResponse(nodeID, certType, {}, AOS_ERROR_WRAP(err));
+            return AOS_ERROR_WRAP(err);
         }
     }
 
-    auto csr = std::make_unique<StaticString<crypto::cCSRPEMLen>>();
-
-    err = AOS_ERROR_WRAP(mProvisionManager->CreateKey(certType, subject, password, *csr));
-
-    return SendCreateKeyResponse(nodeID, certType, *csr, err);
+    return AOS_ERROR_WRAP(mProvisionManager->CreateKey(certType, subject, password, csr));
 }
 
 bool IAMClient::ProcessApplyCert(const iamanager::v5::ApplyCertRequest& request)
@@ -527,7 +747,7 @@ bool IAMClient::SendCreateKeyResponse(const String& nodeID, const String& type,
 
     common::pbconvert::SetErrorInfo(error, response);
 
-    return mStream->Write(outgoingMsg);
+    return WriteMessage(outgoingMsg);
 }
 
 bool IAMClient::SendApplyCertResponse(
@@ -554,7 +774,7 @@ bool IAMClient::SendApplyCertResponse(
 
     common::pbconvert::SetErrorInfo(error, response);
 
-    return mStream->Write(outgoingMsg);
+    return WriteMessage(outgoingMsg);
 }
 
 bool IAMClient::SendGetCertTypesResponse(const provisionmanager::CertTypes& types, const Error& error)
@@ -568,7 +788,15 @@ bool IAMClient::SendGetCertTypesResponse(const provisionmanager::CertTypes& type
         response.mutable_types()->Add(type.CStr());
     }
 
-    return mStream->Write(outgoingMsg);
+    return WriteMessage(outgoingMsg);
+}
+
+bool IAMClient::WriteMessage(const iamanager::v5::IAMOutgoingMessages& message)
+{
+    // messages are sent from incoming message handler, key tasks and node info updates
+    std::lock_guard lock {mWriteMutex};
+
+    return mStream->Write(message);
 }
 
 } // namespace aos::iam::iamclient
@@ -8,9 +8,13 @@
 #ifndef IAMCLIENT_HPP_
 #define IAMCLIENT_HPP_
 
+#include <atomic>
 #include <condition_variable>
+#include <future>
+#include <memory>
 #include <thread>
 
+#include <grpc/grpc_security.h>
 #include <grpcpp/channel.h>
 #include <grpcpp/security/credentials.h>
 
@@ -69,6 +73,14 @@ public:
      */
     Error Stop();
 
+    /**
+     * Sends updated node info to main IAM. Does nothing if not connected.
+     *
+     * @param info node info.
+     * @returns Error.
+     */
+    Error UpdateNodeInfo(const NodeInfo& info);
+
 private:
     void OnCertChanged(const certhandler::CertInfo& info) override;
 
@@ -83,6 +95,7 @@ private:
 
     void ConnectionLoop() noexcept;
     void HandleIncomingMessages() noexcept;
+    bool ProcessIncomingMessage(const iamanager::v5::IAMIncomingMessages& incomingMsg);
 
     bool SendNodeInfo();
     bool ProcessStartProvisioning(const iamanager::v5::StartProvisioningRequest& request);
@@ -91,15 +104,18 @@ private:
     bool ProcessPauseNode(const iamanager::v5::PauseNodeRequest& request);
     bool ProcessResumeNode(const iamanager::v5::ResumeNodeRequest& request);
     bool ProcessCreateKey(const iamanager::v5::CreateKeyRequest& request);
+    bool ProcessCreateKeysForAllCertTypes(const iamanager::v5::CreateKeyRequest& request);
     bool ProcessApplyCert(const iamanager::v5::ApplyCertRequest& request);
     bool ProcessGetCertTypes(const iamanager::v5::GetCertTypesRequest& request);
 
     Error CheckCurrentNodeStatus(const std::initializer_list<NodeStatus>& allowedStatuses);
+    Error CreateKey(const String& certType, const iamanager::v5::CreateKeyRequest& request, String& csr);
 
     bool SendCreateKeyResponse(const String& nodeID, const String& type, const String& csr, const Error& error);
     bool SendApplyCertResponse(const String& nodeID, const String& type, const String& certURL,
         const Array<uint8_t>& serial, const Error& error);
     bool SendGetCertTypesResponse(const provisionmanager::CertTypes& types, const Error& error);
+    bool WriteMessage(const iamanager::v5::IAMOutgoingMessages& message);
 
     identhandler::IdentHandlerItf*         mIdentHandler     = nullptr;
     provisionmanager::ProvisionManagerItf* mProvisionManager = nullptr;
@@ -110,6 +126,7 @@ private:
 
     std::vector<std::shared_ptr<grpc::ChannelCredentials>> mCredentialList;
     bool                                                   mCredentialListUpdated = false;
+    std::shared_ptr<grpc_ssl_session_cache>                mSSLSessionCache;
 
     Duration    mReconnectInterval;
     std::string mCACert;
@@ -118,6 +135,8 @@ private:
 
     std::unique_ptr<grpc::ClientContext> mRegisterNodeCtx;
     StreamPtr                            mStream;
+    std::mutex                           mWriteMutex;
+    std::atomic_bool                     mConnected = false;
     PublicNodeServiceStubPtr             mPublicNodeServiceStub;
 
     std::thread mConnectionThread;
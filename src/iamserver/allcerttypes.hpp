@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ALLCERTTYPES_HPP_
+#define ALLCERTTYPES_HPP_
+
+#include <string>
+#include <vector>
+
+#include <google/protobuf/unknown_field_set.h>
+#include <iamanager/v5/iamanager.grpc.pb.h>
+
+namespace aos::iam::iamserver {
+
+/**
+ * Client metadata key requesting create key for all certificate types of the node, the value should be "true". The
+ * request type should be empty.
+ */
+constexpr auto cAllCertTypesMetadataKey = "aos-all-cert-types";
+
+/**
+ * Field number marking create key request forwarded to the node as request for all certificate types. The field is
+ * not declared in the proto schema: it is kept as unknown field, so nodes not aware of it fail the request as one with
+ * empty certificate type.
+ */
+constexpr int cAllCertTypesFieldNumber = 536870004;
+
+/**
+ * Field number carrying create key responses of each certificate type in the response for all certificate types. Kept
+ * as unknown field as well.
+ */
+constexpr int cCertTypeResponseFieldNumber = 536870005;
+
+/**
+ * Marks create key request as request for all certificate types.
+ *
+ * @param request create key request.
+ */
+inline void SetAllCertTypes(iamanager::v5::CreateKeyRequest& request)
+{
+    auto fields = request.GetReflection()->MutableUnknownFields(&request);
+
+    fields->DeleteByNumber(cAllCertTypesFieldNumber);
+    fields->AddVarint(cAllCertTypesFieldNumber, 1);
+}
+
+/**
+ * Checks if create key request is request for all certificate types.
+ *
+ * @param request create key request.
+ * @return bool.
+ */
+inline bool IsAllCertTypes(const iamanager::v5::CreateKeyRequest& request)
+{
+    const auto& fields = request.GetReflection()->GetUnknownFields(request);
+
+    for (int i = 0; i < fields.field_count(); i++) {
+        const auto& field = fields.field(i);
+
+        if (field.number() == cAllCertTypesFieldNumber && field.type() == google::protobuf::UnknownField::TYPE_VARINT) {
+            return field.varint() != 0;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Adds create key response of one certificate type to the response for all certificate types. The first failed
+ * certificate type error is set as the response error.
+ *
+ * @param response response for all certificate types.
+ * @param certTypeResponse response of one certificate type.
+ */
+inline void AddCertTypeResponse(
+    iamanager::v5::CreateKeyResponse& response, const iamanager::v5::CreateKeyResponse& certTypeResponse)
+{
+    if (certTypeResponse.has_error() && certTypeResponse.error().aos_code() != 0 && !response.has_error()) {
+        *response.mutable_error() = certTypeResponse.error();
+    }
+
+    response.GetReflection()->MutableUnknownFields(&response)->AddLengthDelimited(
+        cCertTypeResponseFieldNumber, certTypeResponse.SerializeAsString());
+}
+
+/**
+ * Returns create key responses of each certificate type from the response for all certificate types.
+ *
+ * @param response response for all certificate types.
+ * @return std::vector<iamanager::v5::CreateKeyResponse>.
+ */
+inline std::vector<iamanager::v5::CreateKeyResponse> GetCertTypeResponses(
+    const iamanager::v5::CreateKeyResponse& response)
+{
+    std::vector<iamanager::v5::CreateKeyResponse> certTypeResponses;
+
+    const auto& fields = response.GetReflection()->GetUnknownFields(response);
+
+    for (int i = 0; i < fields.field_count(); i++) {
+        const auto& field = fields.field(i);
+
+        if (field.number() != cCertTypeResponseFieldNumber
+            || field.type() != google::protobuf::UnknownField::TYPE_LENGTH_DELIMITED) {
+            continue;
+        }
+
+        if (certTypeResponses.emplace_back(); !certTypeResponses.back().ParseFromString(field.length_delimited())) {
+            certTypeResponses.pop_back();
+        }
+    }
+
+    return certTypeResponses;
+}
+
+} // namespace aos::iam::iamserver
+
+#endif
@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include <aos/common/tools/string.hpp>
+#include <utils/exception.hpp>
+
+#include "commandrunner.hpp"
+#include "logger/logmodule.hpp"
+
+extern char** environ;
+
+namespace aos::iam::iamserver {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Constants
+ **********************************************************************************************************************/
+
+constexpr auto cPollPeriod    = std::chrono::milliseconds(100);
+constexpr auto cReadChunkSize = 256;
+constexpr auto cMaxLineLen    = 1024;
+
+/***********************************************************************************************************************
+ * Statics
+ **********************************************************************************************************************/
+
+thread_local std::optional<std::chrono::steady_clock::time_point> sCallDeadline;
+
+/**
+ * Logs command output line by line and keeps the output tail.
+ */
+class OutputLogger {
+public:
+    explicit OutputLogger(const std::string& cmdName)
+        : mCmdName(cmdName)
+    {
+    }
+
+    void Write(const char* data, size_t size)
+    {
+        mTail.append(data, size);
+
+        if (mTail.size() > cMaxCommandOutputSize) {
+            mTail.erase(0, mTail.size() - cMaxCommandOutputSize);
+        }
+
+        for (size_t i = 0; i < size; i++) {
+            if (data[i] == '\n' || mLine.size() >= cMaxLineLen) {
+                Flush();
+            }
+
+            if (data[i] != '\n') {
+                mLine.push_back(data[i]);
+            }
+        }
+    }
+
+    void Flush()
+    {
+        if (!mLine.empty()) {
+            LOG_DBG() << mCmdName.c_str() << ": " << mLine.c_str();
+        }
+
+        mLine.clear();
+    }
+
+    std::string Tail() const
+    {
+        auto tail = mTail;
+
+        tail.erase(tail.find_last_not_of(" \t\r\n") + 1);
+
+        return tail;
+    }
+
+private:
+    const std::string& mCmdName;
+    std::string        mLine;
+    std::string        mTail;
+};
+
+/**
+ * Spawned command process with stdout and stderr redirected to the pipe.
+ */
+class Process {
+public:
+    ~Process()
+    {
+        if (mOutFD != -1) {
+            close(mOutFD);
+        }
+
+        if (mPID != -1 && !mExited) {
+            Kill();
+        }
+    }
+
+    Error Spawn(const std::vector<std::string>& cmdArgs)
+    {
+        int pipeFDs[2];
+
+        if (pipe2(pipeFDs, O_CLOEXEC) == -1) {
+            return AOS_ERROR_WRAP(errno);
+        }
+
+        std::vector<char*> argv;
+
+        for (const auto& arg : cmdArgs) {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+
+        argv.push_back(nullptr);
+
+        posix_spawn_file_actions_t actions;
+        posix_spawnattr_t          attr;
+
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, pipeFDs[1], STDOUT_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, pipeFDs[1], STDERR_FILENO);
+
+        // own process group allows to kill the command together with its children
+        posix_spawnattr_init(&attr);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+        posix_spawnattr_setpgroup(&attr, 0);
+
+        auto ret = posix_spawnp(&mPID, argv[0], &actions, &attr, argv.data(), environ);
+
+        posix_spawnattr_destroy(&attr);
+        posix_spawn_file_actions_destroy(&actions);
+        close(pipeFDs[1]);
+
+        if (ret != 0) {
+            mPID = -1;
+            close(pipeFDs[0]);
+
+            return AOS_ERROR_WRAP(ret);
+        }
+
+        mOutFD = pipeFDs[0];
+
+        return ErrorEnum::eNone;
+    }
+
+    // Reads output available within the timeout, returns true if some output has been read.
+    bool ReadOutput(std::chrono::milliseconds timeout, OutputLogger& logger)
+    {
+        if (mOutFD == -1) {
+            return false;
+        }
+
+        pollfd fd {mOutFD, POLLIN, 0};
+
+        if (auto ret = poll(&fd, 1, static_cast<int>(timeout.count())); ret <= 0) {
+            return false;
+        }
+
+        char chunk[cReadChunkSize];
+
+        auto size = read(mOutFD, chunk, sizeof(chunk));
+        if (size == -1 && errno == EINTR) {
+            return false;
+        }
+
+        if (size <= 0) {
+            close(mOutFD);
+            mOutFD = -1;
+
+            return false;
+        }
+
+        logger.Write(chunk, size);
+
+        return true;
+    }
+
+    bool IsOutputClosed() const { return mOutFD == -1; }
+
+    bool CheckExited()
+    {
+        if (!mExited && waitpid(mPID, &mStatus, WNOHANG) == mPID) {
+            mExited = true;
+        }
+
+        return mExited;
+    }
+
+    void Kill()
+    {
+        kill(-mPID, SIGKILL);
+
+        while (waitpid(mPID, &mStatus, 0) == -1 && errno == EINTR) { }
+
+        mExited = true;
+    }
+
+    int GetStatus() const { return mStatus; }
+
+private:
+    pid_t mPID    = -1;
+    int   mOutFD  = -1;
+    int   mStatus = 0;
+    bool  mExited = false;
+};
+
+Error CheckExitStatus(const std::string& cmd, int status)
+{
+    StaticString<cMaxErrorStrLen> errStr;
+
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        return ErrorEnum::eNone;
+    }
+
+    if (WIFSIGNALED(status)) {
+        errStr.Format("Process killed: cmd=%s, signal=%d", cmd.c_str(), WTERMSIG(status));
+    } else {
+        errStr.Format("Process failed: cmd=%s, code=%d", cmd.c_str(), WEXITSTATUS(status));
+    }
+
+    return {ErrorEnum::eFailed, errStr.CStr()};
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+Error ExecCommand(
+    const std::string& cmdName, const std::vector<std::string>& cmdArgs, std::chrono::nanoseconds timeout) noexcept
+{
+    if (cmdArgs.empty()) {
+        return ErrorEnum::eNone;
+    }
+
+    try {
+        // zero timeout means no timeout, the command is limited only by the call deadline
+        auto deadline = timeout > std::chrono::nanoseconds::zero() ? std::chrono::steady_clock::now() + timeout
+                                                                   : std::chrono::steady_clock::time_point::max();
+
+        if (auto callDeadline = CallDeadlineScope::Get(); callDeadline.has_value()) {
+            deadline = std::min(deadline, *callDeadline);
+        }
+
+        LOG_DBG() << "Exec command: name=" << cmdName.c_str() << ", cmd=" << cmdArgs[0].c_str();
+
+        Process      process;
+        OutputLogger logger(cmdName);
+
+        if (auto err = process.Spawn(cmdArgs); !err.IsNone()) {
+            LOG_ERR() << cmdName.c_str() << " exec failed: error=" << err;
+
+            return err;
+        }
+
+        // children may keep the output open after the command exits, so stop reading as soon as the command exited
+        // and no more output is pending
+        while (true) {
+            const auto now = std::chrono::steady_clock::now();
+
+            if (now >= deadline) {
+                process.Kill();
+                logger.Flush();
+
+                LOG_ERR() << cmdName.c_str() << " exec timed out: output=" << logger.Tail().c_str();
+
+                return AOS_ERROR_WRAP(Error(ErrorEnum::eTimeout, "command timed out"));
+            }
+
+            const auto exited   = process.CheckExited();
+            const auto pollTime = std::min<std::chrono::milliseconds>(
+                cPollPeriod, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now));
+
+            if (process.ReadOutput(exited ? std::chrono::milliseconds::zero() : pollTime, logger)) {
+                continue;
+            }
+
+            if (exited) {
+                break;
+            }
+
+            if (process.IsOutputClosed()) {
+                std::this_thread::sleep_for(pollTime);
+            }
+        }
+
+        logger.Flush();
+
+        if (auto err = CheckExitStatus(cmdArgs[0], process.GetStatus()); !err.IsNone()) {
+            LOG_ERR() << cmdName.c_str() << " exec failed: output=" << logger.Tail().c_str() << ", error=" << err;
+
+            return err;
+        }
+    } catch (const std::exception& e) {
+        return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+    }
+
+    return ErrorEnum::eNone;
+}
+
+CallDeadlineScope::CallDeadlineScope(std::chrono::system_clock::time_point deadline)
+    : mPrevDeadline(sCallDeadline)
+{
+    // gRPC reports infinite deadline as max time point
+    if (deadline == std::chrono::system_clock::time_point::max()) {
+        return;
+    }
+
+    sCallDeadline = std::chrono::steady_clock::now()
+        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            deadline - std::chrono::system_clock::now());
+}
+
+CallDeadlineScope::~CallDeadlineScope()
+{
+    sCallDeadline = mPrevDeadline;
+}
+
+std::optional<std::chrono::steady_clock::time_point> CallDeadlineScope::Get()
+{
+    return sCallDeadline;
+}
+
+} // namespace aos::iam::iamserver
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMANDRUNNER_HPP_
+#define COMMANDRUNNER_HPP_
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <aos/common/tools/error.hpp>
+
+namespace aos::iam::iamserver {
+
+/**
+ * Max size of the command output tail kept for error reporting.
+ */
+constexpr auto cMaxCommandOutputSize = 4096;
+
+/**
+ * Executes external command. Command output is logged line by line. The command and all its children are killed when
+ * the timeout or the deadline of the current RPC (see CallDeadlineScope) expires.
+ *
+ * @param cmdName command name used in logs.
+ * @param cmdArgs command and its arguments.
+ * @param timeout command timeout, zero means no timeout.
+ * @return Error.
+ */
+Error ExecCommand(
+    const std::string& cmdName, const std::vector<std::string>& cmdArgs, std::chrono::nanoseconds timeout) noexcept;
+
+/**
+ * Sets deadline of the RPC handled by the current thread for the commands executed within the scope.
+ */
+class CallDeadlineScope {
+public:
+    /**
+     * Constructor.
+     *
+     * @param deadline RPC deadline.
+     */
+    explicit CallDeadlineScope(std::chrono::system_clock::time_point deadline);
+
+    /**
+     * Destructor.
+     */
+    ~CallDeadlineScope();
+
+    CallDeadlineScope(const CallDeadlineScope&)            = delete;
+    CallDeadlineScope& operator=(const CallDeadlineScope&) = delete;
+
+    /**
+     * Returns deadline of the RPC handled by the current thread.
+     *
+     * @return std::optional<std::chrono::steady_clock::time_point>.
+     */
+    static std::optional<std::chrono::steady_clock::time_point> Get();
+
+private:
+    std::optional<std::chrono::steady_clock::time_point> mPrevDeadline;
+};
+
+} // namespace aos::iam::iamserver
+
+#endif
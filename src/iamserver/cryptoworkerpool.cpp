@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <utils/exception.hpp>
+
+#include "cryptoworkerpool.hpp"
+#include "logger/logmodule.hpp"
+
+namespace aos::iam::iamserver {
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+CryptoWorkerPool::CryptoWorkerPool(size_t numWorkers, size_t maxTasks)
+    : mNumWorkers(numWorkers)
+    , mMaxTasks(maxTasks)
+{
+}
+
+CryptoWorkerPool::~CryptoWorkerPool()
+{
+    Stop();
+}
+
+void CryptoWorkerPool::Start()
+{
+    std::lock_guard lock {mMutex};
+
+    if (!mStopped) {
+        return;
+    }
+
+    LOG_DBG() << "Start crypto worker pool: workers=" << mNumWorkers;
+
+    mStopped = false;
+
+    for (size_t i = 0; i < mNumWorkers; i++) {
+        mWorkers.emplace_back(&CryptoWorkerPool::Run, this);
+    }
+}
+
+void CryptoWorkerPool::Stop()
+{
+    std::vector<Task>        canceledTasks;
+    std::vector<std::thread> workers;
+
+    {
+        std::lock_guard lock {mMutex};
+
+        if (mStopped) {
+            return;
+        }
+
+        LOG_DBG() << "Stop crypto worker pool";
+
+        mStopped = true;
+
+        // keys of running tasks are not in the ready list and are removed by the workers
+        for (const auto& key : mReadyKeys) {
+            auto it = mTasks.find(key);
+
+            for (auto& task : it->second) {
+                canceledTasks.push_back(std::move(task));
+            }
+
+            mTasks.erase(it);
+        }
+
+        for (auto& [key, tasks] : mTasks) {
+            for (auto& task : tasks) {
+                canceledTasks.push_back(std::move(task));
+            }
+
+            tasks.clear();
+        }
+
+        mReadyKeys.clear();
+        mNumTasks -= canceledTasks.size();
+        workers = std::move(mWorkers);
+    }
+
+    mCondVar.notify_all();
+
+    for (auto& task : canceledTasks) {
+        task(true);
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+Error CryptoWorkerPool::Post(const std::string& key, Task task)
+{
+    {
+        std::lock_guard lock {mMutex};
+
+        if (mStopped) {
+            return Error(ErrorEnum::eWrongState, "worker pool is stopped");
+        }
+
+        if (mNumTasks >= mMaxTasks) {
+            return Error(ErrorEnum::eNoMemory, "worker pool queue is full");
+        }
+
+        auto [it, inserted] = mTasks.try_emplace(key);
+
+        it->second.push_back(std::move(task));
+        mNumTasks++;
+
+        // known key is either in the ready list or has running task and is put back to the ready list by the worker
+        if (!inserted) {
+            return ErrorEnum::eNone;
+        }
+
+        mReadyKeys.push_back(key);
+    }
+
+    mCondVar.notify_one();
+
+    return ErrorEnum::eNone;
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+void CryptoWorkerPool::Run()
+{
+    std::unique_lock lock {mMutex};
+
+    while (true) {
+        mCondVar.wait(lock, [this] { return mStopped || !mReadyKeys.empty(); });
+
+        if (mStopped) {
+            return;
+        }
+
+        auto key = std::move(mReadyKeys.front());
+        mReadyKeys.pop_front();
+
+        auto& tasks = mTasks[key];
+        auto  task  = std::move(tasks.front());
+
+        tasks.pop_front();
+
+        lock.unlock();
+
+        try {
+            task(false);
+        } catch (const std::exception& e) {
+            LOG_ERR() << "Crypto task failed: err=" << common::utils::ToAosError(e);
+        }
+
+        lock.lock();
+
+        mNumTasks--;
+
+        // key is kept in the tasks map while its task is running, Stop only clears its queue
+        if (auto it = mTasks.find(key); it->second.empty()) {
+            mTasks.erase(it);
+        } else {
+            mReadyKeys.push_back(std::move(key));
+            mCondVar.notify_one();
+        }
+    }
+}
+
+} // namespace aos::iam::iamserver
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CRYPTOWORKERPOOL_HPP_
+#define CRYPTOWORKERPOOL_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <aos/common/tools/error.hpp>
+
+namespace aos::iam::iamserver {
+
+/**
+ * Bounded worker pool for long running crypto operations and requests waiting for them on other nodes. Tasks posted
+ * with the same key are executed one by one in the posting order, tasks with different keys run in parallel.
+ */
+class CryptoWorkerPool {
+public:
+    /**
+     * Task. Canceled flag is set if the pool is stopped before the task is started.
+     */
+    using Task = std::function<void(bool canceled)>;
+
+    /**
+     * Constructor.
+     *
+     * @param numWorkers number of worker threads.
+     * @param maxTasks max number of queued tasks.
+     */
+    CryptoWorkerPool(size_t numWorkers, size_t maxTasks);
+
+    /**
+     * Destructor.
+     */
+    ~CryptoWorkerPool();
+
+    /**
+     * Starts worker threads.
+     */
+    void Start();
+
+    /**
+     * Cancels queued tasks and waits for running tasks to complete.
+     */
+    void Stop();
+
+    /**
+     * Posts task.
+     *
+     * @param key ordering key.
+     * @param task task.
+     * @return Error eWrongState if the pool is stopped, eNoMemory if the queue is full.
+     */
+    Error Post(const std::string& key, Task task);
+
+private:
+    void Run();
+
+    size_t                                  mNumWorkers;
+    size_t                                  mMaxTasks;
+    std::mutex                              mMutex;
+    std::condition_variable                 mCondVar;
+    bool                                    mStopped  = true;
+    size_t                                  mNumTasks = 0;
+    std::map<std::string, std::deque<Task>> mTasks;
+    std::deque<std::string>                 mReadyKeys;
+    std::vector<std::thread>                mWorkers;
+};
+
+} // namespace aos::iam::iamserver
+
+#endif
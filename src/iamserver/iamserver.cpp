@@ -6,14 +6,14 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <memory>
 #include <numeric>
+#include <sys/stat.h>
 
-#include <Poco/Pipe.h>
-#include <Poco/PipeStream.h>
-#include <Poco/Process.h>
-#include <Poco/StreamCopier.h>
+#include <grpc/grpc.h>
+#include <grpcpp/resource_quota.h>
 
 #include <aos/common/crypto/crypto.hpp>
 #include <aos/common/crypto/utils.hpp>
@@ -21,10 +21,11 @@
 #include <aos/common/types.hpp>
 #include <aos/iam/certhandler.hpp>
 #include <utils/exception.hpp>
-#include <utils/grpchelper.hpp>
 
+#include "commandrunner.hpp"
 #include "iamserver.hpp"
 #include "logger/logmodule.hpp"
+#include "rpcinterceptor.hpp"
 
 namespace aos::iam::iamserver {
 
@@ -34,6 +35,11 @@ namespace {
  * Statics
  **********************************************************************************************************************/
 
+constexpr auto cUnixSocketScheme = "unix:";
+
+// local, public and protected servers
+constexpr auto cMaxServers = 3;
+
 std::string CorrectAddress(const std::string& addr)
 {
     if (addr.empty()) {
@@ -47,40 +53,35 @@ std::string CorrectAddress(const std::string& addr)
     return addr;
 }
 
-Error ExecProcess(const std::string& cmd, const std::vector<std::string>& args, std::string& output)
+void ApplyServerLimits(
+    const config::GRPCServerConfig& config, const grpc::ResourceQuota& quota, grpc::ServerBuilder& builder)
 {
-    Poco::Pipe            outPipe;
-    Poco::ProcessHandle   ph = Poco::Process::launch(cmd, args, nullptr, &outPipe, &outPipe);
-    Poco::PipeInputStream outStream(outPipe);
-
-    Poco::StreamCopier::copyToString(outStream, output);
-    Poco::trimRightInPlace(output);
+    if (config.mMaxThreads > 0) {
+        // quota is shared by all servers, so the thread limit holds for them together
+        builder.SetResourceQuota(quota);
 
-    if (int exitCode = ph.wait(); exitCode != 0) {
-        StaticString<cMaxErrorStrLen> errStr;
+        // pollers are taken from the same thread quota, keep half of it for running handlers
+        builder.SetSyncServerOption(
+            grpc::ServerBuilder::SyncServerOption::MAX_POLLERS, std::max(config.mMaxThreads / 2, 1));
+    }
 
-        errStr.Format("Process failed: cmd=%s, code=%d", cmd.c_str(), exitCode);
+    if (config.mNumCQs > 0) {
+        builder.SetSyncServerOption(grpc::ServerBuilder::SyncServerOption::NUM_CQS, config.mNumCQs);
+    }
 
-        return {ErrorEnum::eFailed, errStr.CStr()};
+    if (config.mMaxMessageSize > 0) {
+        builder.SetMaxReceiveMessageSize(config.mMaxMessageSize);
+        builder.SetMaxSendMessageSize(config.mMaxMessageSize);
     }
 
-    return ErrorEnum::eNone;
+    if (config.mMaxConcurrentStreams > 0) {
+        builder.AddChannelArgument(GRPC_ARG_MAX_CONCURRENT_STREAMS, config.mMaxConcurrentStreams);
+    }
 }
 
-Error ExecCommand(const std::string& cmdName, const std::vector<std::string>& cmdArgs)
+std::chrono::nanoseconds ToChronoDuration(const Duration& duration)
 {
-    if (!cmdArgs.empty()) {
-        std::string                    output;
-        const std::vector<std::string> args {cmdArgs.begin() + 1, cmdArgs.end()};
-
-        if (auto err = ExecProcess(cmdArgs[0], args, output); !err.IsNone()) {
-            LOG_ERR() << cmdName.c_str() << " exec failed: output=" << output.c_str() << ", error=" << err;
-
-            return err;
-        }
-    }
-
-    return ErrorEnum::eNone;
+    return std::chrono::nanoseconds(duration.Nanoseconds());
 }
 
 } // namespace
@@ -104,6 +105,20 @@ Error IAMServer::Init(const config::IAMServerConfig& config, certhandler::CertHa
     mProvisioningMode = provisioningMode;
     mCertHandler      = &certHandler;
 
+    if (mConfig.mGRPCServer.mMaxThreads > 0) {
+        // each server reserves one polling thread per completion queue on start
+        auto minThreads = cMaxServers * std::max(mConfig.mGRPCServer.mNumCQs, 1);
+
+        if (mConfig.mGRPCServer.mMaxThreads < minThreads) {
+            LOG_WRN() << "Server max threads is too low, use minimal value: maxThreads="
+                      << mConfig.mGRPCServer.mMaxThreads << ", minThreads=" << minThreads;
+
+            mConfig.mGRPCServer.mMaxThreads = minThreads;
+        }
+
+        mResourceQuota.SetMaxThreads(mConfig.mGRPCServer.mMaxThreads);
+    }
+
     Error err;
     auto  nodeInfo = std::make_unique<NodeInfo>();
 
@@ -127,24 +142,16 @@ Error IAMServer::Init(const config::IAMServerConfig& config, certhandler::CertHa
         return AOS_ERROR_WRAP(err);
     }
 
-    try {
-        if (!mProvisioningMode) {
-            certhandler::CertInfo certInfo;
-
-            err = certHandler.GetCertificate(String(mConfig.mCertStorage.c_str()), {}, {}, certInfo);
-            if (!err.IsNone()) {
-                return AOS_ERROR_WRAP(err);
-            }
-
-            mPublicCred    = common::utils::GetTLSServerCredentials(certInfo, certLoader, cryptoProvider);
-            mProtectedCred = common::utils::GetMTLSServerCredentials(
-                certInfo, mConfig.mCACert.c_str(), certLoader, cryptoProvider);
-        } else {
-            mPublicCred    = grpc::InsecureServerCredentials();
-            mProtectedCred = grpc::InsecureServerCredentials();
+    mPublicMessageHandler.SetReadiness(mReadiness);
+    mProtectedMessageHandler.SetReadiness(mReadiness);
+
+    if (mProvisioningMode) {
+        mPublicCred    = grpc::InsecureServerCredentials();
+        mProtectedCred = grpc::InsecureServerCredentials();
+    } else if (mReadiness.IsReady(ServerComponent::eCertificates)) {
+        if (err = InitCredentials(); !err.IsNone()) {
+            return err;
         }
-    } catch (const std::exception& e) {
-        return AOS_ERROR_WRAP(common::utils::ToAosError(e));
     }
 
     if (err = nodeManager.SubscribeNodeInfoChange(static_cast<nodemanager::NodeInfoListenerItf&>(*this));
@@ -157,16 +164,20 @@ Error IAMServer::Init(const config::IAMServerConfig& config, certhandler::CertHa
 
 Error IAMServer::Start()
 {
+    std::lock_guard stateLock {mStateMutex};
+
     if (mIsStarted) {
         return ErrorEnum::eNone;
     }
 
     LOG_DBG() << "Start IAM server";
 
-    if (!mProvisioningMode) {
-        auto err = mCertHandler->SubscribeCertChanged(String(mConfig.mCertStorage.c_str()), *this);
-        if (!err.IsNone()) {
-            return AOS_ERROR_WRAP(err);
+    // credentials are not set until certificates are ready
+    const bool secure = mPublicCred != nullptr;
+
+    if (secure) {
+        if (auto err = SubscribeCertChanged(); !err.IsNone()) {
+            return err;
         }
     }
 
@@ -175,16 +186,32 @@ Error IAMServer::Start()
     mPublicMessageHandler.Start();
     mProtectedMessageHandler.Start();
 
-    CreatePublicServer(CorrectAddress(mConfig.mIAMPublicServerURL), mPublicCred);
-    CreateProtectedServer(CorrectAddress(mConfig.mIAMProtectedServerURL), mProtectedCred);
+    {
+        std::lock_guard lock {mServerMutex};
+
+        // local socket doesn't depend on credentials and is never rotated
+        if (auto err = CreateLocalServer(); !err.IsNone()) {
+            mNodeController.Close();
+
+            mPublicMessageHandler.Close();
+            mProtectedMessageHandler.Close();
+
+            return err;
+        }
 
-    mIsStarted = true;
+        CreatePublicServer(CorrectAddress(mConfig.mIAMPublicServerURL), mPublicCred);
+        CreateProtectedServer(CorrectAddress(mConfig.mIAMProtectedServerURL), mProtectedCred);
+
+        mIsStarted = true;
+    }
 
     return ErrorEnum::eNone;
 }
 
 Error IAMServer::Stop()
 {
+    std::lock_guard stateLock {mStateMutex};
+
     if (!mIsStarted) {
         return ErrorEnum::eNone;
     }
@@ -193,8 +220,9 @@ Error IAMServer::Stop()
 
     Error err;
 
-    if (!mProvisioningMode) {
-        err = mCertHandler->UnsubscribeCertChanged(*this);
+    if (mCertChangedSubscribed) {
+        err                    = mCertHandler->UnsubscribeCertChanged(*this);
+        mCertChangedSubscribed = false;
     }
 
     mNodeController.Close();
@@ -202,6 +230,8 @@ Error IAMServer::Stop()
     mPublicMessageHandler.Close();
     mProtectedMessageHandler.Close();
 
+    std::lock_guard lock {mServerMutex};
+
     if (mPublicServer) {
         mPublicServer->Shutdown();
         mPublicServer->Wait();
@@ -212,18 +242,70 @@ Error IAMServer::Stop()
         mProtectedServer->Wait();
     }
 
+    if (mLocalServer) {
+        mLocalServer->Shutdown();
+        mLocalServer->Wait();
+    }
+
     mIsStarted = false;
 
     return err;
 }
 
+void IAMServer::SetComponentPending(ServerComponent component)
+{
+    mReadiness.SetPending(component);
+}
+
+Error IAMServer::SetComponentReady(ServerComponent component)
+{
+    std::lock_guard stateLock {mStateMutex};
+
+    if (mReadiness.IsReady(component)) {
+        return ErrorEnum::eNone;
+    }
+
+    LOG_DBG() << "Server component ready: component=" << static_cast<int>(component);
+
+    if (component != ServerComponent::eCertificates || mProvisioningMode) {
+        mReadiness.SetReady(component);
+
+        return ErrorEnum::eNone;
+    }
+
+    if (auto err = InitCredentials(); !err.IsNone()) {
+        return err;
+    }
+
+    mReadiness.SetReady(component);
+
+    if (!mIsStarted) {
+        return ErrorEnum::eNone;
+    }
+
+    if (auto err = SubscribeCertChanged(); !err.IsNone()) {
+        return err;
+    }
+
+    {
+        std::lock_guard lock {mServerMutex};
+
+        // local server keeps running, secure servers are started along with it
+        CreatePublicServer(CorrectAddress(mConfig.mIAMPublicServerURL), mPublicCred);
+        CreateProtectedServer(CorrectAddress(mConfig.mIAMProtectedServerURL), mProtectedCred);
+    }
+
+    return ErrorEnum::eNone;
+}
+
 Error IAMServer::OnStartProvisioning(const String& password)
 {
     (void)password;
 
     LOG_DBG() << "Process on start provisioning";
 
-    return ExecCommand("Start provisioning", mConfig.mStartProvisioningCmdArgs);
+    return ExecCommand(
+        "Start provisioning", mConfig.mStartProvisioningCmdArgs, ToChronoDuration(mConfig.mProvisioningCmdTimeout));
 }
 
 Error IAMServer::OnFinishProvisioning(const String& password)
@@ -232,7 +314,8 @@ Error IAMServer::OnFinishProvisioning(const String& password)
 
     LOG_DBG() << "Process on finish provisioning";
 
-    return ExecCommand("Finish provisioning", mConfig.mFinishProvisioningCmdArgs);
+    return ExecCommand(
+        "Finish provisioning", mConfig.mFinishProvisioningCmdArgs, ToChronoDuration(mConfig.mProvisioningCmdTimeout));
 }
 
 Error IAMServer::OnDeprovision(const String& password)
@@ -241,7 +324,7 @@ Error IAMServer::OnDeprovision(const String& password)
 
     LOG_DBG() << "Process on deprovisioning";
 
-    return ExecCommand("Deprovision", mConfig.mDeprovisionCmdArgs);
+    return ExecCommand("Deprovision", mConfig.mDeprovisionCmdArgs, ToChronoDuration(mConfig.mProvisioningCmdTimeout));
 }
 
 Error IAMServer::OnEncryptDisk(const String& password)
@@ -250,7 +333,8 @@ Error IAMServer::OnEncryptDisk(const String& password)
 
     LOG_DBG() << "Process on encrypt disk";
 
-    return ExecCommand("Encrypt disk", mConfig.mDiskEncryptionCmdArgs);
+    return ExecCommand(
+        "Encrypt disk", mConfig.mDiskEncryptionCmdArgs, ToChronoDuration(mConfig.mProvisioningCmdTimeout));
 }
 
 void IAMServer::OnNodeInfoChange(const NodeInfo& info)
@@ -287,28 +371,120 @@ Error IAMServer::SubjectsChanged(const Array<StaticString<cSubjectIDLen>>& messa
     return ErrorEnum::eNone;
 }
 
+Error IAMServer::InitCredentials()
+{
+    try {
+        certhandler::CertInfo certInfo;
+
+        auto err = mCertHandler->GetCertificate(String(mConfig.mCertStorage.c_str()), {}, {}, certInfo);
+        if (!err.IsNone()) {
+            return AOS_ERROR_WRAP(err);
+        }
+
+        if (err = mCredentials.Init(certInfo, mConfig.mCACert, *mCertLoader, *mCryptoProvider); !err.IsNone()) {
+            return AOS_ERROR_WRAP(err);
+        }
+
+        std::lock_guard lock {mServerMutex};
+
+        mPublicCred    = mCredentials.GetTLSCredentials();
+        mProtectedCred = mCredentials.GetMTLSCredentials();
+    } catch (const std::exception& e) {
+        return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error IAMServer::SubscribeCertChanged()
+{
+    if (mProvisioningMode || mCertChangedSubscribed) {
+        return ErrorEnum::eNone;
+    }
+
+    if (auto err = mCertHandler->SubscribeCertChanged(String(mConfig.mCertStorage.c_str()), *this); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    mCertChangedSubscribed = true;
+
+    return ErrorEnum::eNone;
+}
+
 void IAMServer::OnCertChanged(const certhandler::CertInfo& info)
 {
-    mPublicCred = common::utils::GetTLSServerCredentials(info, *mCertLoader, *mCryptoProvider);
-    mProtectedCred
-        = common::utils::GetMTLSServerCredentials(info, mConfig.mCACert.c_str(), *mCertLoader, *mCryptoProvider);
-
-    // postpone restart so it didn't block ApplyCert
-    mCertChangedResult = std::async(std::launch::async, [this]() {
-        sleep(1);
-        Stop();
-        Start();
-    });
+    LOG_DBG() << "Process on cert changed: certURL=" << info.mCertURL;
+
+    // key material is reloaded by running servers: new handshakes get the new certificate, established connections
+    // and streams are kept
+    if (auto err = mCredentials.Update(info); !err.IsNone()) {
+        LOG_ERR() << "Can't update server credentials: err=" << err;
+    }
+}
+
+Error IAMServer::CreateLocalServer()
+{
+    if (mConfig.mIAMPublicServerSocket.empty()) {
+        return ErrorEnum::eNone;
+    }
+
+    LOG_DBG() << "Process create local server: path=" << mConfig.mIAMPublicServerSocket.c_str();
+
+    grpc::ServerBuilder builder;
+
+    // local clients are authorized by socket file permissions, so TLS is not needed there
+    builder.AddListeningPort(cUnixSocketScheme + mConfig.mIAMPublicServerSocket, grpc::InsecureServerCredentials());
+
+    ApplyServerLimits(mConfig.mGRPCServer, mResourceQuota, builder);
+    builder.experimental().SetInterceptorCreators(
+        CreateInterceptorFactories(ToChronoDuration(mConfig.mSlowRPCThreshold)));
+
+    mPublicMessageHandler.RegisterServices(builder);
+
+    // Socket is bound by BuildAndStart with owner only access, so nobody else connects before the configured mode
+    // is set. Umask is process wide: files created by other threads meanwhile get more restrictive mode only.
+    const auto mask = umask(S_IXUSR | S_IRWXG | S_IRWXO);
+
+    mLocalServer = builder.BuildAndStart();
+
+    umask(mask);
+
+    if (!mLocalServer) {
+        return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "can't start local server"));
+    }
+
+    if (chmod(mConfig.mIAMPublicServerSocket.c_str(), mConfig.mIAMPublicServerSocketMode) != 0) {
+        auto err = Error(errno);
+
+        LOG_ERR() << "Can't set public server socket mode: path=" << mConfig.mIAMPublicServerSocket.c_str()
+                  << ", err=" << err;
+
+        mLocalServer->Shutdown();
+        mLocalServer->Wait();
+        mLocalServer.reset();
+
+        return AOS_ERROR_WRAP(err);
+    }
+
+    return ErrorEnum::eNone;
 }
 
 void IAMServer::CreatePublicServer(const std::string& addr, const std::shared_ptr<grpc::ServerCredentials>& credentials)
 {
+    if (!credentials) {
+        return;
+    }
+
     LOG_DBG() << "Process create public server: URL=" << addr.c_str();
 
     grpc::ServerBuilder builder;
 
     builder.AddListeningPort(addr, credentials);
 
+    ApplyServerLimits(mConfig.mGRPCServer, mResourceQuota, builder);
+    builder.experimental().SetInterceptorCreators(
+        CreateInterceptorFactories(ToChronoDuration(mConfig.mSlowRPCThreshold)));
+
     mPublicMessageHandler.RegisterServices(builder);
 
     mPublicServer = builder.BuildAndStart();
@@ -317,12 +493,20 @@ void IAMServer::CreatePublicServer(const std::string& addr, const std::shared_pt
 void IAMServer::CreateProtectedServer(
     const std::string& addr, const std::shared_ptr<grpc::ServerCredentials>& credentials)
 {
+    if (!credentials) {
+        return;
+    }
+
     LOG_DBG() << "Process create protected server: URL=" << addr.c_str();
 
     grpc::ServerBuilder builder;
 
     builder.AddListeningPort(addr, credentials);
 
+    ApplyServerLimits(mConfig.mGRPCServer, mResourceQuota, builder);
+    builder.experimental().SetInterceptorCreators(
+        CreateInterceptorFactories(ToChronoDuration(mConfig.mSlowRPCThreshold)));
+
     mProtectedMessageHandler.RegisterServices(builder);
 
     mProtectedServer = builder.BuildAndStart();
@@ -9,10 +9,13 @@
 #define IAMSERVER_HPP_
 
 #include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include <grpcpp/resource_quota.h>
 #include <grpcpp/server_builder.h>
 
 #include <aos/common/crypto/utils.hpp>
@@ -28,6 +31,7 @@
 
 #include "protectedmessagehandler.hpp"
 #include "publicmessagehandler.hpp"
+#include "reloadablecredentials.hpp"
 
 namespace aos::iam::iamserver {
 
@@ -80,6 +84,24 @@ public:
      */
     Error Stop();
 
+    /**
+     * Marks server component as pending: requests depending on it return UNAVAILABLE with retry hint until the
+     * component is ready. Should be called before Init. If certificates are pending, the server is started serving
+     * only the public local socket.
+     *
+     * @param component server component.
+     */
+    void SetComponentPending(ServerComponent component);
+
+    /**
+     * Marks server component as ready. Once certificates are ready, TLS credentials are loaded and the public and
+     * protected servers are started. Should be called after Init.
+     *
+     * @param component server component.
+     * @returns Error.
+     */
+    Error SetComponentReady(ServerComponent component);
+
     /**
      * Called when provisioning starts.
      *
@@ -133,7 +155,11 @@ private:
     // certhandler::CertReceiverItf interface
     void OnCertChanged(const certhandler::CertInfo& info) override;
 
+    Error InitCredentials();
+    Error SubscribeCertChanged();
+
     // creating routines
+    Error CreateLocalServer();
     void CreatePublicServer(const std::string& addr, const std::shared_ptr<grpc::ServerCredentials>& credentials);
     void CreateProtectedServer(const std::string& addr, const std::shared_ptr<grpc::ServerCredentials>& credentials);
 
@@ -145,11 +171,16 @@ private:
     NodeController                           mNodeController;
     PublicMessageHandler                     mPublicMessageHandler;
     ProtectedMessageHandler                  mProtectedMessageHandler;
-    std::unique_ptr<grpc::Server>            mPublicServer, mProtectedServer;
+    ComponentReadiness                       mReadiness;
+    std::mutex                               mStateMutex;
+    std::mutex                               mServerMutex;
+    ReloadableCredentials                    mCredentials;
+    std::unique_ptr<grpc::Server>            mLocalServer, mPublicServer, mProtectedServer;
+    grpc::ResourceQuota                      mResourceQuota;
     std::shared_ptr<grpc::ServerCredentials> mPublicCred, mProtectedCred;
 
-    std::atomic<bool> mIsStarted = false;
-    std::future<void> mCertChangedResult;
+    std::atomic<bool> mIsStarted             = false;
+    bool              mCertChangedSubscribed = false;
 
     bool mProvisioningMode {};
 };
@@ -5,16 +5,112 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
 #include <thread>
 
 #include <pbconvert/common.hpp>
 #include <utils/exception.hpp>
 
 #include "logger/logmodule.hpp"
+#include "metrics/metrics.hpp"
 #include "nodecontroller.hpp"
+#include "tracer/protocarrier.hpp"
+#include "tracer/tracer.hpp"
 
 namespace aos::iam::iamserver {
 
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+constexpr auto cTraceTag         = "node stream";
+constexpr auto cCancelCheckPeriod = std::chrono::milliseconds(100);
+
+/***********************************************************************************************************************
+ * Types
+ **********************************************************************************************************************/
+
+using IncomingMessages = iamproto::IAMIncomingMessages;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+metrics::Gauge& ActiveStreamsGauge()
+{
+    static auto& gauge = metrics::GetRegistry().GetGauge("aos_iam_node_streams", "Number of active node streams");
+
+    return gauge;
+}
+
+metrics::Gauge& PendingRequestsGauge()
+{
+    static auto& gauge
+        = metrics::GetRegistry().GetGauge("aos_iam_node_pending_requests", "Number of requests forwarded to nodes");
+
+    return gauge;
+}
+
+/**
+ * Lends request to the incoming message without copying it. The incoming message is not arena allocated, so it just
+ * stores the pointer, which is released before the guard goes out of scope.
+ */
+template <typename T>
+class BorrowedRequest {
+public:
+    using Setter   = void (IncomingMessages::*)(T*);
+    using Releaser = T* (IncomingMessages::*)();
+
+    BorrowedRequest(IncomingMessages& message, const T* request, Setter set, Releaser release)
+        : mMessage(message)
+        , mRelease(release)
+    {
+        (mMessage.*set)(const_cast<T*>(request));
+    }
+
+    ~BorrowedRequest() { (mMessage.*mRelease)(); }
+
+    BorrowedRequest(const BorrowedRequest&)            = delete;
+    BorrowedRequest& operator=(const BorrowedRequest&) = delete;
+
+private:
+    IncomingMessages& mMessage;
+    Releaser          mRelease;
+};
+
+PendingMessageKey GetPendingKey(const iamproto::IAMOutgoingMessages& message)
+{
+    if (message.has_create_key_response()) {
+        return {message.IAMOutgoingMessage_case(), message.create_key_response().type()};
+    }
+
+    if (message.has_apply_cert_response()) {
+        return {message.IAMOutgoingMessage_case(), message.apply_cert_response().type()};
+    }
+
+    return {message.IAMOutgoingMessage_case(), {}};
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+std::optional<std::chrono::steady_clock::time_point> GetCallDeadline(const grpc::ServerContextBase* context)
+{
+    // gRPC reports infinite deadline as max time point
+    if (!context || context->deadline() == std::chrono::system_clock::time_point::max()) {
+        return std::nullopt;
+    }
+
+    return std::chrono::steady_clock::now()
+        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            context->deadline() - std::chrono::system_clock::now());
+}
+
 /***********************************************************************************************************************
  * NodeStreamHandler
  **********************************************************************************************************************/
@@ -48,12 +144,14 @@ void NodeStreamHandler::Close()
     mContext->TryCancel();
 
     mPendingMessages.clear();
+    mPendingCondVar.notify_all();
 }
 
 Error NodeStreamHandler::HandleStream()
 {
     LOG_DBG() << "Process stream handler";
 
+    metrics::ScopedGauge          activeStream {ActiveStreamsGauge()};
     Error                         err = ErrorEnum::eNone;
     iamproto::IAMOutgoingMessages outgoing;
 
@@ -78,8 +176,12 @@ Error NodeStreamHandler::HandleStream()
         std::lock_guard lock {mMutex};
 
         try {
-            if (auto it = mPendingMessages.find(messageCase); it != mPendingMessages.end()) {
+            if (auto it = mPendingMessages.find(GetPendingKey(outgoing)); it != mPendingMessages.end()) {
+                tracer::Record(tracer::EventType::ePendingFulfil, cTraceTag, messageCase);
+
                 it->second.set_value(std::move(outgoing));
+                mPendingMessages.erase(it);
+                mPendingCondVar.notify_all();
             }
         } catch (const std::exception& e) {
             err = AOS_ERROR_WRAP(common::utils::ToAosError(e));
@@ -94,15 +196,19 @@ Error NodeStreamHandler::HandleStream()
 }
 
 grpc::Status NodeStreamHandler::GetCertTypes(const iamproto::GetCertTypesRequest* request,
-    iamproto::CertTypes* response, const std::chrono::seconds responseTimeout)
+    iamproto::CertTypes* response, const std::chrono::seconds responseTimeout,
+    const grpc::ServerContextBase* callerContext)
 {
     iamproto::IAMIncomingMessages incoming;
     iamproto::IAMOutgoingMessages outgoing;
 
     outgoing.mutable_cert_types_response();
-    incoming.mutable_get_cert_types_request()->CopyFrom(*request);
 
-    if (auto err = SendMessage(incoming, outgoing, responseTimeout); !err.IsNone()) {
+    BorrowedRequest borrowed {incoming, request,
+        &IncomingMessages::unsafe_arena_set_allocated_get_cert_types_request,
+        &IncomingMessages::unsafe_arena_release_get_cert_types_request};
+
+    if (auto err = SendMessage(incoming, outgoing, responseTimeout, callerContext); !err.IsNone()) {
         return common::pbconvert::ConvertAosErrorToGrpcStatus(err);
     }
 
@@ -110,21 +216,25 @@ grpc::Status NodeStreamHandler::GetCertTypes(const iamproto::GetCertTypesRequest
         return grpc::Status::CANCELLED;
     }
 
-    response->CopyFrom(outgoing.cert_types_response());
+    response->Swap(outgoing.mutable_cert_types_response());
 
     return grpc::Status::OK;
 }
 
 grpc::Status NodeStreamHandler::StartProvisioning(const iamproto::StartProvisioningRequest* request,
-    iamproto::StartProvisioningResponse* response, const std::chrono::seconds responseTimeout)
+    iamproto::StartProvisioningResponse* response, const std::chrono::seconds responseTimeout,
+    const grpc::ServerContextBase* callerContext)
 {
     iamproto::IAMIncomingMessages incoming;
     iamproto::IAMOutgoingMessages outgoing;
 
     outgoing.mutable_start_provisioning_response();
-    incoming.mutable_start_provisioning_request()->CopyFrom(*request);
 
-    if (auto err = SendMessage(incoming, outgoing, responseTimeout); !err.IsNone()) {
+    BorrowedRequest borrowed {incoming, request,
+        &IncomingMessages::unsafe_arena_set_allocated_start_provisioning_request,
+        &IncomingMessages::unsafe_arena_release_start_provisioning_request};
+
+    if (auto err = SendMessage(incoming, outgoing, responseTimeout, callerContext); !err.IsNone()) {
         return common::pbconvert::ConvertAosErrorToGrpcStatus(err);
     }
 
@@ -132,21 +242,25 @@ grpc::Status NodeStreamHandler::StartProvisioning(const iamproto::StartProvision
         return grpc::Status::CANCELLED;
     }
 
-    response->CopyFrom(outgoing.start_provisioning_response());
+    response->Swap(outgoing.mutable_start_provisioning_response());
 
     return grpc::Status::OK;
 }
 
 grpc::Status NodeStreamHandler::FinishProvisioning(const iamproto::FinishProvisioningRequest* request,
-    iamproto::FinishProvisioningResponse* response, const std::chrono::seconds responseTimeout)
+    iamproto::FinishProvisioningResponse* response, const std::chrono::seconds responseTimeout,
+    const grpc::ServerContextBase* callerContext)
 {
     iamproto::IAMIncomingMessages incoming;
     iamproto::IAMOutgoingMessages outgoing;
 
     outgoing.mutable_finish_provisioning_response();
-    incoming.mutable_finish_provisioning_request()->CopyFrom(*request);
 
-    if (auto err = SendMessage(incoming, outgoing, responseTimeout); !err.IsNone()) {
+    BorrowedRequest borrowed {incoming, request,
+        &IncomingMessages::unsafe_arena_set_allocated_finish_provisioning_request,
+        &IncomingMessages::unsafe_arena_release_finish_provisioning_request};
+
+    if (auto err = SendMessage(incoming, outgoing, responseTimeout, callerContext); !err.IsNone()) {
         return common::pbconvert::ConvertAosErrorToGrpcStatus(err);
     }
 
@@ -154,21 +268,25 @@ grpc::Status NodeStreamHandler::FinishProvisioning(const iamproto::FinishProvisi
         return grpc::Status::CANCELLED;
     }
 
-    response->CopyFrom(outgoing.finish_provisioning_response());
+    response->Swap(outgoing.mutable_finish_provisioning_response());
 
     return grpc::Status::OK;
 }
 
 grpc::Status NodeStreamHandler::Deprovision(const iamproto::DeprovisionRequest* request,
-    iamproto::DeprovisionResponse* response, const std::chrono::seconds responseTimeout)
+    iamproto::DeprovisionResponse* response, const std::chrono::seconds responseTimeout,
+    const grpc::ServerContextBase* callerContext)
 {
     iamproto::IAMIncomingMessages incoming;
     iamproto::IAMOutgoingMessages outgoing;
 
     outgoing.mutable_deprovision_response();
-    incoming.mutable_deprovision_request()->CopyFrom(*request);
 
-    if (auto err = SendMessage(incoming, outgoing, responseTimeout); !err.IsNone()) {
+    BorrowedRequest borrowed {incoming, request,
+        &IncomingMessages::unsafe_arena_set_allocated_deprovision_request,
+        &IncomingMessages::unsafe_arena_release_deprovision_request};
+
+    if (auto err = SendMessage(incoming, outgoing, responseTimeout, callerContext); !err.IsNone()) {
         return common::pbconvert::ConvertAosErrorToGrpcStatus(err);
     }
 
@@ -176,21 +294,25 @@ grpc::Status NodeStreamHandler::Deprovision(const iamproto::DeprovisionRequest*
         return grpc::Status::CANCELLED;
     }
 
-    response->CopyFrom(outgoing.deprovision_response());
+    response->Swap(outgoing.mutable_deprovision_response());
 
     return grpc::Status::OK;
 }
 
 grpc::Status NodeStreamHandler::PauseNode(const iamproto::PauseNodeRequest* request,
-    iamproto::PauseNodeResponse* response, const std::chrono::seconds responseTimeout)
+    iamproto::PauseNodeResponse* response, const std::chrono::seconds responseTimeout,
+    const grpc::ServerContextBase* callerContext)
 {
     iamproto::IAMIncomingMessages incoming;
     iamproto::IAMOutgoingMessages outgoing;
 
     outgoing.mutable_pause_node_response();
-    incoming.mutable_pause_node_request()->CopyFrom(*request);
 
-    if (auto err = SendMessage(incoming, outgoing, responseTimeout); !err.IsNone()) {
+    BorrowedRequest borrowed {incoming, request,
+        &IncomingMessages::unsafe_arena_set_allocated_pause_node_request,
+        &IncomingMessages::unsafe_arena_release_pause_node_request};
+
+    if (auto err = SendMessage(incoming, outgoing, responseTimeout, callerContext); !err.IsNone()) {
         return common::pbconvert::ConvertAosErrorToGrpcStatus(err);
     }
 
@@ -198,21 +320,25 @@ grpc::Status NodeStreamHandler::PauseNode(const iamproto::PauseNodeRequest* requ
         return grpc::Status::CANCELLED;
     }
 
-    response->CopyFrom(outgoing.pause_node_response());
+    response->Swap(outgoing.mutable_pause_node_response());
 
     return grpc::Status::OK;
 }
 
 grpc::Status NodeStreamHandler::ResumeNode(const iamproto::ResumeNodeRequest* request,
-    iamproto::ResumeNodeResponse* response, const std::chrono::seconds responseTimeout)
+    iamproto::ResumeNodeResponse* response, const std::chrono::seconds responseTimeout,
+    const grpc::ServerContextBase* callerContext)
 {
     iamproto::IAMIncomingMessages incoming;
     iamproto::IAMOutgoingMessages outgoing;
 
     outgoing.mutable_resume_node_response();
-    incoming.mutable_resume_node_request()->CopyFrom(*request);
 
-    if (auto err = SendMessage(incoming, outgoing, responseTimeout); !err.IsNone()) {
+    BorrowedRequest borrowed {incoming, request,
+        &IncomingMessages::unsafe_arena_set_allocated_resume_node_request,
+        &IncomingMessages::unsafe_arena_release_resume_node_request};
+
+    if (auto err = SendMessage(incoming, outgoing, responseTimeout, callerContext); !err.IsNone()) {
         return common::pbconvert::ConvertAosErrorToGrpcStatus(err);
     }
 
@@ -220,21 +346,25 @@ grpc::Status NodeStreamHandler::ResumeNode(const iamproto::ResumeNodeRequest* re
         return grpc::Status::CANCELLED;
     }
 
-    response->CopyFrom(outgoing.resume_node_response());
+    response->Swap(outgoing.mutable_resume_node_response());
 
     return grpc::Status::OK;
 }
 
 grpc::Status NodeStreamHandler::CreateKey(const iamproto::CreateKeyRequest* request,
-    iamproto::CreateKeyResponse* response, const std::chrono::seconds responseTimeout)
+    iamproto::CreateKeyResponse* response, const std::chrono::seconds responseTimeout,
+    const grpc::ServerContextBase* callerContext)
 {
     iamproto::IAMIncomingMessages incoming;
     iamproto::IAMOutgoingMessages outgoing;
 
-    outgoing.mutable_create_key_response();
-    incoming.mutable_create_key_request()->CopyFrom(*request);
+    outgoing.mutable_create_key_response()->set_type(request->type());
+
+    BorrowedRequest borrowed {incoming, request,
+        &IncomingMessages::unsafe_arena_set_allocated_create_key_request,
+        &IncomingMessages::unsafe_arena_release_create_key_request};
 
-    if (auto err = SendMessage(incoming, outgoing, responseTimeout); !err.IsNone()) {
+    if (auto err = SendMessage(incoming, outgoing, responseTimeout, callerContext); !err.IsNone()) {
         return common::pbconvert::ConvertAosErrorToGrpcStatus(err);
     }
 
@@ -242,21 +372,25 @@ grpc::Status NodeStreamHandler::CreateKey(const iamproto::CreateKeyRequest* requ
         return grpc::Status::CANCELLED;
     }
 
-    response->CopyFrom(outgoing.create_key_response());
+    response->Swap(outgoing.mutable_create_key_response());
 
     return grpc::Status::OK;
 }
 
 grpc::Status NodeStreamHandler::ApplyCert(const iamproto::ApplyCertRequest* request,
-    iamproto::ApplyCertResponse* response, const std::chrono::seconds responseTimeout)
+    iamproto::ApplyCertResponse* response, const std::chrono::seconds responseTimeout,
+    const grpc::ServerContextBase* callerContext)
 {
     iamproto::IAMIncomingMessages incoming;
     iamproto::IAMOutgoingMessages outgoing;
 
-    outgoing.mutable_apply_cert_response();
-    incoming.mutable_apply_cert_request()->CopyFrom(*request);
+    outgoing.mutable_apply_cert_response()->set_type(request->type());
+
+    BorrowedRequest borrowed {incoming, request,
+        &IncomingMessages::unsafe_arena_set_allocated_apply_cert_request,
+        &IncomingMessages::unsafe_arena_release_apply_cert_request};
 
-    if (auto err = SendMessage(incoming, outgoing, responseTimeout); !err.IsNone()) {
+    if (auto err = SendMessage(incoming, outgoing, responseTimeout, callerContext); !err.IsNone()) {
         return common::pbconvert::ConvertAosErrorToGrpcStatus(err);
     }
 
@@ -264,7 +398,7 @@ grpc::Status NodeStreamHandler::ApplyCert(const iamproto::ApplyCertRequest* requ
         return grpc::Status::CANCELLED;
     }
 
-    response->CopyFrom(outgoing.apply_cert_response());
+    response->Swap(outgoing.mutable_apply_cert_response());
 
     return grpc::Status::OK;
 }
@@ -283,29 +417,101 @@ NodeStreamHandler::NodeStreamHandler(const std::vector<NodeStatus>& allowedStatu
 {
 }
 
-Error NodeStreamHandler::SendMessage(const iamproto::IAMIncomingMessages& request,
-    iamproto::IAMOutgoingMessages& response, const std::chrono::seconds responseTimeout)
+Error NodeStreamHandler::SendMessage(iamproto::IAMIncomingMessages& request,
+    iamproto::IAMOutgoingMessages& response, const std::chrono::seconds responseTimeout,
+    const grpc::ServerContextBase* callerContext)
 {
     if (mIsClosed) {
         return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "stream is closed"));
     }
 
-    if (!mStream->Write(request)) {
-        return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "failed to send message"));
+    auto deadline = std::chrono::steady_clock::now() + responseTimeout;
+
+    if (auto callDeadline = GetCallDeadline(callerContext); callDeadline.has_value()) {
+        deadline = std::min(deadline, *callDeadline);
+    }
+
+    const auto timeLeft
+        = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    if (timeLeft.count() <= 0) {
+        return AOS_ERROR_WRAP(Error(ErrorEnum::eTimeout, "call deadline exceeded"));
     }
 
+    metrics::ScopedGauge pendingRequest {PendingRequestsGauge()};
+    tracer::Span         span {cTraceTag};
+
+    // secondary IAM continues the trace from the span context carried by the request and skips work which can't be
+    // completed in time
+    tracer::InjectSpanContext(request, span.GetContext());
+    tracer::InjectDeadline(request, timeLeft);
+
+    const auto key = GetPendingKey(response);
+
     try {
         std::promise<iamproto::IAMOutgoingMessages> promise;
         auto                                        responseFuture = promise.get_future();
 
         {
-            std::lock_guard lock {mMutex};
+            std::unique_lock lock {mMutex};
 
-            mPendingMessages[response.IAMOutgoingMessage_case()] = std::move(promise);
+            // node messages have no request ID: requests with the same key are sent one by one, so a response always
+            // matches the only pending request
+            while (mPendingMessages.count(key) != 0) {
+                if (mIsClosed) {
+                    return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "stream is closed"));
+                }
+
+                if (callerContext && callerContext->IsCancelled()) {
+                    return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "call is canceled"));
+                }
+
+                if (std::chrono::steady_clock::now() >= deadline) {
+                    return AOS_ERROR_WRAP(Error(ErrorEnum::eTimeout, "response timeout"));
+                }
+
+                mPendingCondVar.wait_until(
+                    lock, std::min(deadline, std::chrono::steady_clock::now() + cCancelCheckPeriod));
+            }
+
+            // response may come before write returns, so the request is registered first
+            mPendingMessages.emplace(key, std::move(promise));
+        }
+
+        tracer::Record(tracer::EventType::ePendingSet, cTraceTag, key.first);
+
+        Error err;
+
+        {
+            std::lock_guard lock {mWriteMutex};
+
+            if (!mStream->Write(request)) {
+                err = Error(ErrorEnum::eFailed, "failed to send message");
+            }
+        }
+
+        // sync gRPC API doesn't notify about cancellation, so it is checked periodically while waiting
+        while (err.IsNone()
+            && responseFuture.wait_until(std::min(deadline, std::chrono::steady_clock::now() + cCancelCheckPeriod))
+                != std::future_status::ready) {
+            if (callerContext && callerContext->IsCancelled()) {
+                err = Error(ErrorEnum::eFailed, "call is canceled");
+            } else if (std::chrono::steady_clock::now() >= deadline) {
+                tracer::Record(tracer::EventType::ePendingTimeout, cTraceTag, key.first);
+
+                err = Error(ErrorEnum::eTimeout, "response timeout");
+            }
         }
 
-        if (responseFuture.wait_for(responseTimeout) != std::future_status::ready) {
-            return AOS_ERROR_WRAP(Error(ErrorEnum::eTimeout, "response timeout"));
+        if (!err.IsNone()) {
+            std::lock_guard lock {mMutex};
+
+            // fulfilled request is already removed and the key may be reused by another request
+            if (responseFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                mPendingMessages.erase(key);
+                mPendingCondVar.notify_all();
+            }
+
+            return AOS_ERROR_WRAP(err);
         }
 
         response = responseFuture.get();
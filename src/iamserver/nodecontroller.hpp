@@ -8,8 +8,10 @@
 #ifndef NODECONTROLLER_HPP_
 #define NODECONTROLLER_HPP_
 
+#include <condition_variable>
 #include <future>
 #include <map>
+#include <optional>
 #include <string>
 
 #include <Poco/Event.h>
@@ -23,10 +25,19 @@ namespace aos::iam::iamserver {
 
 namespace iamproto = iamanager::v5;
 
+/**
+ * Returns deadline of the call.
+ *
+ * @param context server context.
+ * @return std::optional<std::chrono::steady_clock::time_point> empty if the call has no deadline.
+ */
+std::optional<std::chrono::steady_clock::time_point> GetCallDeadline(const grpc::ServerContextBase* context);
+
 using NodeServerReaderWriter = grpc::ServerReaderWriter<iamproto::IAMIncomingMessages, iamproto::IAMOutgoingMessages>;
 
-using PendingMessagesMap
-    = std::map<iamproto::IAMOutgoingMessages::IAMOutgoingMessageCase, std::promise<iamproto::IAMOutgoingMessages>>;
+// certificate responses are matched by cert type as well to allow concurrent requests for different types
+using PendingMessageKey  = std::pair<iamproto::IAMOutgoingMessages::IAMOutgoingMessageCase, std::string>;
+using PendingMessagesMap = std::map<PendingMessageKey, std::promise<iamproto::IAMOutgoingMessages>>;
 
 /**
  * Handles register node input/output stream.
@@ -89,10 +100,12 @@ public:
      * @param request get cert types request.
      * @param response[out] cert types response.
      * @param responseTimeout response timeout.
+     * @param callerContext context of the forwarded call, its deadline and cancellation are honored.
      * @return grpc::Status.
      */
     grpc::Status GetCertTypes(const iamproto::GetCertTypesRequest* request, iamproto::CertTypes* response,
-        const std::chrono::seconds responseTimeout);
+        const std::chrono::seconds responseTimeout,
+        const grpc::ServerContextBase* callerContext = nullptr);
 
     /**
      * Sends start provisioning request and waits for response with timeout.
@@ -100,10 +113,12 @@ public:
      * @param request start provisioning request.
      * @param[out] response start provisioning response.
      * @param responseTimeout response timeout.
+     * @param callerContext context of the forwarded call, its deadline and cancellation are honored.
      * @return grpc::Status.
      */
     grpc::Status StartProvisioning(const iamproto::StartProvisioningRequest* request,
-        iamproto::StartProvisioningResponse* response, const std::chrono::seconds responseTimeout);
+        iamproto::StartProvisioningResponse* response, const std::chrono::seconds responseTimeout,
+        const grpc::ServerContextBase* callerContext = nullptr);
 
     /**
      * Sends finish provisioning request and waits for response with timeout.
@@ -111,10 +126,12 @@ public:
      * @param request finish provisioning request.
      * @param[out] response finish provisioning response.
      * @param responseTimeout response timeout.
+     * @param callerContext context of the forwarded call, its deadline and cancellation are honored.
      * @return grpc::Status.
      */
     grpc::Status FinishProvisioning(const iamproto::FinishProvisioningRequest* request,
-        iamproto::FinishProvisioningResponse* response, const std::chrono::seconds responseTimeout);
+        iamproto::FinishProvisioningResponse* response, const std::chrono::seconds responseTimeout,
+        const grpc::ServerContextBase* callerContext = nullptr);
 
     /**
      * Sends deprovision request and waits for response with timeout.
@@ -122,10 +139,12 @@ public:
      * @param request deprovision request.
      * @param[out] response deprovision response.
      * @param responseTimeout response timeout.
+     * @param callerContext context of the forwarded call, its deadline and cancellation are honored.
      * @return grpc::Status.
      */
     grpc::Status Deprovision(const iamproto::DeprovisionRequest* request, iamproto::DeprovisionResponse* response,
-        const std::chrono::seconds responseTimeout);
+        const std::chrono::seconds responseTimeout,
+        const grpc::ServerContextBase* callerContext = nullptr);
 
     /**
      * Sends pause node request and waits for response with timeout.
@@ -133,10 +152,12 @@ public:
      * @param request pause node request.
      * @param[out] response pause node response.
      * @param responseTimeout response timeout.
+     * @param callerContext context of the forwarded call, its deadline and cancellation are honored.
      * @return grpc::Status.
      */
     grpc::Status PauseNode(const iamproto::PauseNodeRequest* request, iamproto::PauseNodeResponse* response,
-        const std::chrono::seconds responseTimeout);
+        const std::chrono::seconds responseTimeout,
+        const grpc::ServerContextBase* callerContext = nullptr);
 
     /**
      * Sends resume node request and waits for response with timeout.
@@ -144,10 +165,12 @@ public:
      * @param request resume node request.
      * @param[out] response resume node response.
      * @param responseTimeout response timeout.
+     * @param callerContext context of the forwarded call, its deadline and cancellation are honored.
      * @return grpc::Status.
      */
     grpc::Status ResumeNode(const iamproto::ResumeNodeRequest* request, iamproto::ResumeNodeResponse* response,
-        const std::chrono::seconds responseTimeout);
+        const std::chrono::seconds responseTimeout,
+        const grpc::ServerContextBase* callerContext = nullptr);
 
     /**
      * Sends create key request and waits for response with timeout.
@@ -155,10 +178,12 @@ public:
      * @param request create key request.
      * @param[out] response create key response.
      * @param responseTimeout response timeout.
+     * @param callerContext context of the forwarded call, its deadline and cancellation are honored.
      * @return grpc::Status.
      */
     grpc::Status CreateKey(const iamproto::CreateKeyRequest* request, iamproto::CreateKeyResponse* response,
-        const std::chrono::seconds responseTimeout);
+        const std::chrono::seconds responseTimeout,
+        const grpc::ServerContextBase* callerContext = nullptr);
 
     /**
      * Sends apply cert request and waits for response with timeout.
@@ -166,17 +191,19 @@ public:
      * @param request apply certificate request.
      * @param[out] response apply certificate response.
      * @param responseTimeout response timeout.
+     * @param callerContext context of the forwarded call, its deadline and cancellation are honored.
      * @return grpc::Status.
      */
     grpc::Status ApplyCert(const iamproto::ApplyCertRequest* request, iamproto::ApplyCertResponse* response,
-        const std::chrono::seconds responseTimeout);
+        const std::chrono::seconds responseTimeout,
+        const grpc::ServerContextBase* callerContext = nullptr);
 
 private:
     NodeStreamHandler(const std::vector<NodeStatus>& allowedStatuses, NodeServerReaderWriter* stream,
         grpc::ServerContext* context, iam::nodemanager::NodeManagerItf* nodeManager, StreamRegistryItf* streamRegistry);
 
-    Error SendMessage(const iamproto::IAMIncomingMessages& request, iamproto::IAMOutgoingMessages& response,
-        const std::chrono::seconds responseTimeout);
+    Error SendMessage(iamproto::IAMIncomingMessages& request, iamproto::IAMOutgoingMessages& response,
+        const std::chrono::seconds responseTimeout, const grpc::ServerContextBase* callerContext);
     Error HandleNodeInfo(const iamproto::NodeInfo& info);
 
     std::vector<NodeStatus>           mAllowedStatuses;
@@ -185,8 +212,10 @@ private:
     iam::nodemanager::NodeManagerItf* mNodeManager    = nullptr;
     StreamRegistryItf*                mStreamRegistry = nullptr;
     std::mutex                        mMutex;
+    std::mutex                        mWriteMutex;
     std::atomic_bool                  mIsClosed = false;
     PendingMessagesMap                mPendingMessages;
+    std::condition_variable           mPendingCondVar;
 };
 
 /**
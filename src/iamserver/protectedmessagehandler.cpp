@@ -6,6 +6,8 @@
  */
 
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <aos/common/crypto/crypto.hpp>
 #include <aos/common/crypto/utils.hpp>
@@ -16,8 +18,11 @@
 #include <pbconvert/common.hpp>
 #include <pbconvert/iam.hpp>
 
+#include "allcerttypes.hpp"
+#include "commandrunner.hpp"
 #include "logger/logmodule.hpp"
 #include "protectedmessagehandler.hpp"
+#include "tracer/span.hpp"
 
 namespace aos::iam::iamserver {
 
@@ -29,6 +34,105 @@ namespace {
 
 const Error cStreamNotFoundError = {ErrorEnum::eNotFound, "stream not found"};
 
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+std::optional<tracer::SpanContext> GetTraceParent(const grpc::ServerContextBase* context)
+{
+    const auto& metadata = context->client_metadata();
+
+    if (auto it = metadata.find(tracer::cTraceParentHeader); it != metadata.end()) {
+        return tracer::ParseTraceParent(std::string(it->second.data(), it->second.size()));
+    }
+
+    return std::nullopt;
+}
+
+bool IsAllCertTypesRequested(const grpc::ServerContextBase* context)
+{
+    const auto& metadata = context->client_metadata();
+
+    if (auto it = metadata.find(cAllCertTypesMetadataKey); it != metadata.end()) {
+        return std::string(it->second.data(), it->second.size()) == "true";
+    }
+
+    return false;
+}
+
+// returns error status if queued create key shouldn't be processed anymore
+grpc::Status CheckQueuedCreateKey(const grpc::CallbackServerContext* context, bool canceled)
+{
+    if (canceled) {
+        return grpc::Status(grpc::StatusCode::UNAVAILABLE, "handler is closed");
+    }
+
+    if (context->IsCancelled()) {
+        return grpc::Status::CANCELLED;
+    }
+
+    if (context->deadline() <= std::chrono::system_clock::now()) {
+        return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "deadline exceeded in queue");
+    }
+
+    return grpc::Status::OK;
+}
+
+grpc::Status ConvertPostError(const Error& err)
+{
+    return grpc::Status(
+        err.Is(ErrorEnum::eNoMemory) ? grpc::StatusCode::RESOURCE_EXHAUSTED : grpc::StatusCode::UNAVAILABLE,
+        err.Message());
+}
+
+/**
+ * Collects create key responses of all certificate types. The call is finished when the last certificate type is
+ * completed.
+ */
+class CertTypeKeys {
+public:
+    CertTypeKeys(size_t numCertTypes, iamproto::CreateKeyResponse& response, grpc::ServerUnaryReactor& reactor)
+        : mResponse(response)
+        , mReactor(reactor)
+        , mResponses(numCertTypes)
+        , mPending(numCertTypes)
+    {
+    }
+
+    iamproto::CreateKeyResponse& GetResponse(size_t index) { return mResponses[index]; }
+
+    void Complete(const grpc::Status& status)
+    {
+        {
+            std::lock_guard lock {mMutex};
+
+            if (!status.ok() && mStatus.ok()) {
+                mStatus = status;
+            }
+
+            if (--mPending != 0) {
+                return;
+            }
+
+            if (mStatus.ok()) {
+                for (const auto& response : mResponses) {
+                    AddCertTypeResponse(mResponse, response);
+                }
+            }
+        }
+
+        mReactor.Finish(mStatus);
+    }
+
+private:
+    std::mutex                               mMutex;
+    iamproto::CreateKeyResponse&             mResponse;
+    grpc::ServerUnaryReactor&                mReactor;
+    std::vector<iamproto::CreateKeyResponse> mResponses;
+    size_t                                   mPending;
+    grpc::Status                             mStatus;
+};
+
 } // namespace
 
 /***********************************************************************************************************************
@@ -48,6 +152,15 @@ Error ProtectedMessageHandler::Init(NodeController& nodeController, iam::identha
         nodeController, identHandler, permHandler, nodeInfoProvider, nodeManager, certProvider);
 }
 
+// cppcheck-suppress duplInheritedMember
+void ProtectedMessageHandler::Start()
+{
+    PublicMessageHandler::Start();
+
+    mCryptoWorkers.Start();
+    mForwardWorkers.Start();
+}
+
 // cppcheck-suppress duplInheritedMember
 void ProtectedMessageHandler::RegisterServices(grpc::ServerBuilder& builder)
 {
@@ -72,6 +185,9 @@ void ProtectedMessageHandler::Close()
     LOG_DBG() << "Close message handler: handler=protected";
 
     PublicMessageHandler::Close();
+
+    mCryptoWorkers.Stop();
+    mForwardWorkers.Stop();
 }
 
 /***********************************************************************************************************************
@@ -95,7 +211,7 @@ grpc::Status ProtectedMessageHandler::RegisterNode(grpc::ServerContext*
  * IAMNodesService implementation
  **********************************************************************************************************************/
 
-grpc::Status ProtectedMessageHandler::PauseNode([[maybe_unused]] grpc::ServerContext* context,
+grpc::Status ProtectedMessageHandler::PauseNode(grpc::ServerContext* context,
     const iamproto::PauseNodeRequest* request, iamproto::PauseNodeResponse* response)
 {
     const auto& nodeID = request->node_id();
@@ -103,13 +219,15 @@ grpc::Status ProtectedMessageHandler::PauseNode([[maybe_unused]] grpc::ServerCon
     LOG_DBG() << "Process pause node: nodeID=" << nodeID.c_str();
 
     if (!ProcessOnThisNode(nodeID)) {
-        if (auto status = RequestWithRetry([&]() {
+        tracer::Span span {"PauseNode", GetTraceParent(context)};
+
+        if (auto status = RequestWithRetry(context, [&]() {
                 auto handler = GetNodeController()->GetNodeStreamHandler(nodeID);
                 if (!handler) {
                     return common::pbconvert::ConvertAosErrorToGrpcStatus(cStreamNotFoundError);
                 }
 
-                return handler->PauseNode(request, response, cDefaultTimeout);
+                return handler->PauseNode(request, response, cDefaultTimeout, context);
             });
             !status.ok()) {
             return status;
@@ -125,7 +243,7 @@ grpc::Status ProtectedMessageHandler::PauseNode([[maybe_unused]] grpc::ServerCon
     return grpc::Status::OK;
 }
 
-grpc::Status ProtectedMessageHandler::ResumeNode([[maybe_unused]] grpc::ServerContext* context,
+grpc::Status ProtectedMessageHandler::ResumeNode(grpc::ServerContext* context,
     const iamproto::ResumeNodeRequest* request, iamproto::ResumeNodeResponse* response)
 {
     const auto& nodeID = request->node_id();
@@ -133,13 +251,15 @@ grpc::Status ProtectedMessageHandler::ResumeNode([[maybe_unused]] grpc::ServerCo
     LOG_DBG() << "Process resume node: nodeID=" << nodeID.c_str();
 
     if (!ProcessOnThisNode(nodeID)) {
-        if (auto status = RequestWithRetry([&]() {
+        tracer::Span span {"ResumeNode", GetTraceParent(context)};
+
+        if (auto status = RequestWithRetry(context, [&]() {
                 auto handler = GetNodeController()->GetNodeStreamHandler(nodeID);
                 if (!handler) {
                     return common::pbconvert::ConvertAosErrorToGrpcStatus(cStreamNotFoundError);
                 }
 
-                return handler->ResumeNode(request, response, cDefaultTimeout);
+                return handler->ResumeNode(request, response, cDefaultTimeout, context);
             });
             !status.ok()) {
             return status;
@@ -159,21 +279,27 @@ grpc::Status ProtectedMessageHandler::ResumeNode([[maybe_unused]] grpc::ServerCo
  * IAMProvisioningService implementation
  **********************************************************************************************************************/
 
-grpc::Status ProtectedMessageHandler::GetCertTypes([[maybe_unused]] grpc::ServerContext* context,
+grpc::Status ProtectedMessageHandler::GetCertTypes(grpc::ServerContext* context,
     const iamproto::GetCertTypesRequest* request, iamproto::CertTypes* response)
 {
     const auto& nodeID = request->node_id();
 
     LOG_DBG() << "Process get cert types: ID = " << nodeID.c_str();
 
+    if (auto status = CheckReady(context, ServerComponent::eCertificates); !status.ok()) {
+        return status;
+    }
+
     if (!ProcessOnThisNode(nodeID)) {
-        return RequestWithRetry([&]() {
+        tracer::Span span {"GetCertTypes", GetTraceParent(context)};
+
+        return RequestWithRetry(context, [&]() {
             auto handler = GetNodeController()->GetNodeStreamHandler(nodeID);
             if (!handler) {
                 return common::pbconvert::ConvertAosErrorToGrpcStatus(cStreamNotFoundError);
             }
 
-            return handler->GetCertTypes(request, response, cDefaultTimeout);
+            return handler->GetCertTypes(request, response, cDefaultTimeout, context);
         });
     }
 
@@ -194,24 +320,32 @@ grpc::Status ProtectedMessageHandler::GetCertTypes([[maybe_unused]] grpc::Server
     return grpc::Status::OK;
 }
 
-grpc::Status ProtectedMessageHandler::StartProvisioning([[maybe_unused]] grpc::ServerContext* context,
+grpc::Status ProtectedMessageHandler::StartProvisioning(grpc::ServerContext* context,
     const iamproto::StartProvisioningRequest* request, iamproto::StartProvisioningResponse* response)
 {
     const auto& nodeID = request->node_id();
 
     LOG_DBG() << "Process start provisioning request: nodeID=" << nodeID.c_str();
 
+    if (auto status = CheckReady(context, ServerComponent::eCertificates); !status.ok()) {
+        return status;
+    }
+
     if (!ProcessOnThisNode(nodeID)) {
-        return RequestWithRetry([&]() {
+        tracer::Span span {"StartProvisioning", GetTraceParent(context)};
+
+        return RequestWithRetry(context, [&]() {
             auto handler = GetNodeController()->GetNodeStreamHandler(nodeID);
             if (!handler) {
                 return common::pbconvert::ConvertAosErrorToGrpcStatus(cStreamNotFoundError);
             }
 
-            return handler->StartProvisioning(request, response, cProvisioningTimeout);
+            return handler->StartProvisioning(request, response, cProvisioningTimeout, context);
         });
     }
 
+    CallDeadlineScope deadlineScope {context->deadline()};
+
     if (auto err = mProvisionManager->StartProvisioning(request->password().c_str()); !err.IsNone()) {
         LOG_ERR() << "Start provisioning error: error=" << err;
 
@@ -221,26 +355,34 @@ grpc::Status ProtectedMessageHandler::StartProvisioning([[maybe_unused]] grpc::S
     return grpc::Status::OK;
 }
 
-grpc::Status ProtectedMessageHandler::FinishProvisioning([[maybe_unused]] grpc::ServerContext* context,
+grpc::Status ProtectedMessageHandler::FinishProvisioning(grpc::ServerContext* context,
     const iamproto::FinishProvisioningRequest* request, iamproto::FinishProvisioningResponse* response)
 {
     const auto& nodeID = request->node_id();
 
     LOG_DBG() << "Process finish provisioning request: nodeID=" << nodeID.c_str();
 
+    if (auto status = CheckReady(context, ServerComponent::eCertificates); !status.ok()) {
+        return status;
+    }
+
     if (!ProcessOnThisNode(nodeID)) {
-        if (auto status = RequestWithRetry([&]() {
+        tracer::Span span {"FinishProvisioning", GetTraceParent(context)};
+
+        if (auto status = RequestWithRetry(context, [&]() {
                 auto handler = GetNodeController()->GetNodeStreamHandler(nodeID);
                 if (!handler) {
                     return common::pbconvert::ConvertAosErrorToGrpcStatus(cStreamNotFoundError);
                 }
 
-                return handler->FinishProvisioning(request, response, cProvisioningTimeout);
+                return handler->FinishProvisioning(request, response, cProvisioningTimeout, context);
             });
             !status.ok()) {
             return status;
         }
     } else {
+        CallDeadlineScope deadlineScope {context->deadline()};
+
         if (auto err = mProvisionManager->FinishProvisioning(request->password().c_str()); !err.IsNone()) {
             LOG_ERR() << "Finish provisioning failed: error=" << err;
 
@@ -259,26 +401,34 @@ grpc::Status ProtectedMessageHandler::FinishProvisioning([[maybe_unused]] grpc::
     return grpc::Status::OK;
 }
 
-grpc::Status ProtectedMessageHandler::Deprovision([[maybe_unused]] grpc::ServerContext* context,
+grpc::Status ProtectedMessageHandler::Deprovision(grpc::ServerContext* context,
     const iamproto::DeprovisionRequest* request, iamproto::DeprovisionResponse* response)
 {
     const auto& nodeID = request->node_id();
 
     LOG_DBG() << "Process deprovision request: nodeID=" << nodeID.c_str();
 
+    if (auto status = CheckReady(context, ServerComponent::eCertificates); !status.ok()) {
+        return status;
+    }
+
     if (!ProcessOnThisNode(nodeID)) {
-        if (auto status = RequestWithRetry([&]() {
+        tracer::Span span {"Deprovision", GetTraceParent(context)};
+
+        if (auto status = RequestWithRetry(context, [&]() {
                 auto handler = GetNodeController()->GetNodeStreamHandler(nodeID);
                 if (!handler) {
                     return common::pbconvert::ConvertAosErrorToGrpcStatus(cStreamNotFoundError);
                 }
 
-                return handler->Deprovision(request, response, cProvisioningTimeout);
+                return handler->Deprovision(request, response, cProvisioningTimeout, context);
             });
             !status.ok()) {
             return status;
         }
     } else {
+        CallDeadlineScope deadlineScope {context->deadline()};
+
         if (auto err = mProvisionManager->Deprovision(request->password().c_str()); !err.IsNone()) {
             LOG_ERR() << "Deprovision failed: error=" << err;
 
@@ -301,14 +451,131 @@ grpc::Status ProtectedMessageHandler::Deprovision([[maybe_unused]] grpc::ServerC
  * IAMCertificateService implementation
  **********************************************************************************************************************/
 
-grpc::Status ProtectedMessageHandler::CreateKey([[maybe_unused]] grpc::ServerContext* context,
+grpc::ServerUnaryReactor* ProtectedMessageHandler::CreateKey(grpc::CallbackServerContext* context,
+    const iamproto::CreateKeyRequest* request, iamproto::CreateKeyResponse* response)
+{
+    auto reactor = context->DefaultReactor();
+
+    LOG_DBG() << "Process create key request: nodeID=" << request->node_id().c_str()
+              << ", type=" << request->type().c_str();
+
+    if (auto status = CheckReady(context, ServerComponent::eCertificates); !status.ok()) {
+        reactor->Finish(status);
+
+        return reactor;
+    }
+
+    // empty subject is replaced by system ID provided by identifier
+    if (request->subject().empty()) {
+        if (auto status = CheckReady(context, ServerComponent::eIdentifier); !status.ok()) {
+            reactor->Finish(status);
+
+            return reactor;
+        }
+    }
+
+    const auto allCertTypes = IsAllCertTypesRequested(context);
+
+    if (allCertTypes && !request->type().empty()) {
+        reactor->Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "type should be empty for all cert types"));
+
+        return reactor;
+    }
+
+    // keys of all cert types of other nodes are generated by the node itself
+    if (allCertTypes && ProcessOnThisNode(request->node_id())) {
+        CreateKeysForAllCertTypes(context, request, response, reactor);
+
+        return reactor;
+    }
+
+    // key generation may take seconds on HSM, keys of the same type are generated in the request order. Forwarded
+    // requests only wait for the node, they have own workers to not take crypto workers from local key generation.
+    auto& workers = ProcessOnThisNode(request->node_id()) ? mCryptoWorkers : mForwardWorkers;
+
+    auto err = workers.Post(request->node_id() + "/" + request->type(),
+        [this, context, request, response, reactor](bool canceled) {
+            if (auto status = CheckQueuedCreateKey(context, canceled); !status.ok()) {
+                reactor->Finish(status);
+
+                return;
+            }
+
+            CallDeadlineScope deadlineScope {context->deadline()};
+
+            reactor->Finish(ProcessCreateKey(context, request, response));
+        });
+    if (!err.IsNone()) {
+        LOG_ERR() << "Can't schedule create key: error=" << err;
+
+        reactor->Finish(ConvertPostError(err));
+    }
+
+    return reactor;
+}
+
+void ProtectedMessageHandler::CreateKeysForAllCertTypes(grpc::CallbackServerContext* context,
+    const iamproto::CreateKeyRequest* request, iamproto::CreateKeyResponse* response, grpc::ServerUnaryReactor* reactor)
+{
+    const auto& nodeID = request->node_id();
+
+    auto [certTypes, err] = mProvisionManager->GetCertTypes();
+    if (!err.IsNone()) {
+        LOG_ERR() << "Get certificate types error: " << AOS_ERROR_WRAP(err);
+
+        common::pbconvert::SetErrorInfo(err, *response);
+        reactor->Finish(grpc::Status::OK);
+
+        return;
+    }
+
+    response->set_node_id(nodeID);
+
+    if (certTypes.IsEmpty()) {
+        reactor->Finish(grpc::Status::OK);
+
+        return;
+    }
+
+    auto keys = std::make_shared<CertTypeKeys>(certTypes.Size(), *response, *reactor);
+
+    // each type is queued as a single type request: keys of different types are generated concurrently as far as
+    // crypto workers allow, keys of the same type keep the request order
+    for (size_t i = 0; i < certTypes.Size(); i++) {
+        const std::string certType = certTypes[i].CStr();
+
+        err = mCryptoWorkers.Post(nodeID + "/" + certType, [this, context, request, keys, i, certType](bool canceled) {
+            if (auto status = CheckQueuedCreateKey(context, canceled); !status.ok()) {
+                keys->Complete(status);
+
+                return;
+            }
+
+            iamproto::CreateKeyRequest certTypeRequest = *request;
+            auto&                      certTypeResponse = keys->GetResponse(i);
+
+            certTypeRequest.set_type(certType);
+            certTypeResponse.set_node_id(certTypeRequest.node_id());
+            certTypeResponse.set_type(certType);
+
+            CallDeadlineScope deadlineScope {context->deadline()};
+
+            keys->Complete(ProcessCreateKey(context, &certTypeRequest, &certTypeResponse));
+        });
+        if (!err.IsNone()) {
+            LOG_ERR() << "Can't schedule create key: type=" << certType.c_str() << ", error=" << err;
+
+            keys->Complete(ConvertPostError(err));
+        }
+    }
+}
+
+grpc::Status ProtectedMessageHandler::ProcessCreateKey(grpc::ServerContextBase* context,
     const iamproto::CreateKeyRequest* request, iamproto::CreateKeyResponse* response)
 {
     const auto& nodeID   = request->node_id();
     const auto  certType = String(request->type().c_str());
 
-    LOG_DBG() << "Process create key request: nodeID=" << nodeID.c_str() << ", type=" << certType;
-
     StaticString<cSystemIDLen> subject = request->subject().c_str();
 
     if (subject.IsEmpty() && !GetIdentHandler()) {
@@ -335,7 +602,9 @@ grpc::Status ProtectedMessageHandler::CreateKey([[maybe_unused]] grpc::ServerCon
     }
 
     if (!ProcessOnThisNode(nodeID)) {
-        return RequestWithRetry([&]() {
+        tracer::Span span {"CreateKey", GetTraceParent(context)};
+
+        return RequestWithRetry(context, [&]() {
             auto handler = GetNodeController()->GetNodeStreamHandler(nodeID);
             if (!handler) {
                 return common::pbconvert::ConvertAosErrorToGrpcStatus(cStreamNotFoundError);
@@ -345,7 +614,13 @@ grpc::Status ProtectedMessageHandler::CreateKey([[maybe_unused]] grpc::ServerCon
 
             keyRequest.set_subject(subject.CStr());
 
-            return handler->CreateKey(&keyRequest, response, cDefaultTimeout);
+            if (!IsAllCertTypesRequested(context)) {
+                return handler->CreateKey(&keyRequest, response, cDefaultTimeout, context);
+            }
+
+            SetAllCertTypes(keyRequest);
+
+            return handler->CreateKey(&keyRequest, response, cProvisioningTimeout, context);
         });
     }
 
@@ -367,7 +642,7 @@ grpc::Status ProtectedMessageHandler::CreateKey([[maybe_unused]] grpc::ServerCon
     return grpc::Status::OK;
 }
 
-grpc::Status ProtectedMessageHandler::ApplyCert([[maybe_unused]] grpc::ServerContext* context,
+grpc::Status ProtectedMessageHandler::ApplyCert(grpc::ServerContext* context,
     const iamproto::ApplyCertRequest* request, iamproto::ApplyCertResponse* response)
 {
     const auto& nodeID   = request->node_id();
@@ -375,17 +650,23 @@ grpc::Status ProtectedMessageHandler::ApplyCert([[maybe_unused]] grpc::ServerCon
 
     LOG_DBG() << "Process apply cert request: nodeID=" << nodeID.c_str() << ",type=" << certType;
 
+    if (auto status = CheckReady(context, ServerComponent::eCertificates); !status.ok()) {
+        return status;
+    }
+
     response->set_node_id(nodeID);
     response->set_type(certType.CStr());
 
     if (!ProcessOnThisNode(nodeID)) {
-        return RequestWithRetry([&]() {
+        tracer::Span span {"ApplyCert", GetTraceParent(context)};
+
+        return RequestWithRetry(context, [&]() {
             auto handler = GetNodeController()->GetNodeStreamHandler(nodeID);
             if (!handler) {
                 return common::pbconvert::ConvertAosErrorToGrpcStatus(cStreamNotFoundError);
             }
 
-            return handler->ApplyCert(request, response, cDefaultTimeout);
+            return handler->ApplyCert(request, response, cDefaultTimeout, context);
         });
     }
 
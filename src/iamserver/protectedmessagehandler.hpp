@@ -24,6 +24,7 @@
 
 #include <iamanager/v5/iamanager.grpc.pb.h>
 
+#include "cryptoworkerpool.hpp"
 #include "nodecontroller.hpp"
 #include "publicmessagehandler.hpp"
 
@@ -38,7 +39,7 @@ class ProtectedMessageHandler :
     // protected services
     private iamproto::IAMNodesService::Service,
     private iamproto::IAMProvisioningService::Service,
-    private iamproto::IAMCertificateService::Service,
+    private iamproto::IAMCertificateService::WithCallbackMethod_CreateKey<iamproto::IAMCertificateService::Service>,
     private iamproto::IAMPermissionsService::Service {
 public:
     /**
@@ -65,6 +66,12 @@ public:
     // cppcheck-suppress duplInheritedMember
     void RegisterServices(grpc::ServerBuilder& builder);
 
+    /**
+     * Starts protected message handler.
+     */
+    // cppcheck-suppress duplInheritedMember
+    void Start();
+
     using PublicMessageHandler::OnNodeInfoChange;
     using PublicMessageHandler::OnNodeRemoved;
 
@@ -81,6 +88,10 @@ private:
     static constexpr auto       cDefaultTimeout      = std::chrono::minutes(1);
     static constexpr auto       cProvisioningTimeout = std::chrono::minutes(5);
     static constexpr std::array cAllowedStatuses     = {NodeStatusEnum::eProvisioned, NodeStatusEnum::ePaused};
+    static constexpr auto       cCryptoWorkers       = 4;
+    static constexpr auto       cMaxCryptoTasks      = 64;
+    static constexpr auto       cForwardWorkers      = 8;
+    static constexpr auto       cMaxForwardTasks     = 64;
 
     // IAMPublicNodesService interface
     grpc::Status RegisterNode(grpc::ServerContext*                                              context,
@@ -103,8 +114,8 @@ private:
         iamproto::DeprovisionResponse* response) override;
 
     // IAMCertificateService interface
-    grpc::Status CreateKey(grpc::ServerContext* context, const iamproto::CreateKeyRequest* request,
-        iamproto::CreateKeyResponse* response) override;
+    grpc::ServerUnaryReactor* CreateKey(grpc::CallbackServerContext* context,
+        const iamproto::CreateKeyRequest* request, iamproto::CreateKeyResponse* response) override;
     grpc::Status ApplyCert(grpc::ServerContext* context, const iamproto::ApplyCertRequest* request,
         iamproto::ApplyCertResponse* response) override;
 
@@ -114,7 +125,14 @@ private:
     grpc::Status UnregisterInstance(grpc::ServerContext* context, const iamproto::UnregisterInstanceRequest* request,
         google::protobuf::Empty* response) override;
 
+    void CreateKeysForAllCertTypes(grpc::CallbackServerContext* context, const iamproto::CreateKeyRequest* request,
+        iamproto::CreateKeyResponse* response, grpc::ServerUnaryReactor* reactor);
+    grpc::Status ProcessCreateKey(grpc::ServerContextBase* context, const iamproto::CreateKeyRequest* request,
+        iamproto::CreateKeyResponse* response);
+
     iam::provisionmanager::ProvisionManagerItf* mProvisionManager = nullptr;
+    CryptoWorkerPool                            mCryptoWorkers {cCryptoWorkers, cMaxCryptoTasks};
+    CryptoWorkerPool                            mForwardWorkers {cForwardWorkers, cMaxForwardTasks};
 };
 
 } // namespace aos::iam::iamserver
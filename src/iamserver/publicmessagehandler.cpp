@@ -5,7 +5,11 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <vector>
 
 #include <aos/common/crypto/crypto.hpp>
 #include <aos/common/crypto/utils.hpp>
@@ -19,6 +23,100 @@
 
 namespace aos::iam::iamserver {
 
+namespace {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+std::optional<std::string> GetClientMetadata(const grpc::ServerContextBase* context, const std::string& key)
+{
+    const auto& metadata = context->client_metadata();
+
+    if (auto it = metadata.find(key); it != metadata.end()) {
+        return std::string(it->second.data(), it->second.size());
+    }
+
+    return std::nullopt;
+}
+
+std::set<std::string> GetClientMetadataValues(const grpc::ServerContextBase* context, const std::string& key)
+{
+    std::set<std::string> values;
+
+    for (auto [it, end] = context->client_metadata().equal_range(key); it != end; ++it) {
+        values.emplace(it->second.data(), it->second.size());
+    }
+
+    return values;
+}
+
+grpc::Status GetResumeSequence(const grpc::ServerContextBase* context, std::optional<uint64_t>& sequence)
+{
+    auto value = GetClientMetadata(context, cResumeSequenceMetadataKey);
+    if (!value.has_value()) {
+        return grpc::Status::OK;
+    }
+
+    try {
+        size_t pos = 0;
+
+        sequence = std::stoull(*value, &pos);
+
+        if (pos != value->size()) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "invalid resume sequence");
+        }
+    } catch (const std::exception&) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "invalid resume sequence");
+    }
+
+    // sequence issued by another process instance, e.g. before restart, doesn't match the current history
+    if (GetClientMetadata(context, cResumeInstanceMetadataKey) != std::to_string(GetInstanceID())) {
+        return grpc::Status(grpc::StatusCode::ABORTED, cResyncRequired);
+    }
+
+    return grpc::Status::OK;
+}
+
+StreamWriter<iamproto::NodeInfo>::Filter CreateNodeFilter(const grpc::ServerContextBase* context)
+{
+    auto nodeIDs       = GetClientMetadataValues(context, cNodeIDMetadataKey);
+    auto nodeTypes     = GetClientMetadataValues(context, cNodeTypeMetadataKey);
+    auto statusChanges = GetClientMetadata(context, cNodeStatusChangesMetadataKey) == "true";
+
+    if (nodeIDs.empty() && nodeTypes.empty() && !statusChanges) {
+        return {};
+    }
+
+    // the filter belongs to one stream, so it may keep the last status seen by the stream
+    return [nodeIDs = std::move(nodeIDs), nodeTypes = std::move(nodeTypes), statusChanges,
+               statuses = std::map<std::string, std::string>()](const iamproto::NodeInfo& info) mutable {
+        if (!nodeIDs.empty() && nodeIDs.count(info.node_id()) == 0) {
+            return false;
+        }
+
+        if (!nodeTypes.empty() && nodeTypes.count(info.node_type()) == 0) {
+            return false;
+        }
+
+        if (statusChanges) {
+            auto [it, inserted] = statuses.try_emplace(info.node_id(), info.status());
+
+            if (!inserted) {
+                if (it->second == info.status()) {
+                    return false;
+                }
+
+                it->second = info.status();
+            }
+        }
+
+        return true;
+    };
+}
+
+} // namespace
+
 /***********************************************************************************************************************
  * Public
  **********************************************************************************************************************/
@@ -115,7 +213,7 @@ void PublicMessageHandler::Close()
     }
 
     mClose = true;
-    mRetryCondVar.notify_one();
+    mRetryCondVar.notify_all();
 }
 
 /***********************************************************************************************************************
@@ -143,10 +241,45 @@ bool PublicMessageHandler::ProcessOnThisNode(const std::string& nodeID)
     return nodeID.empty() || String(nodeID.c_str()) == GetNodeInfo().mNodeID;
 }
 
+grpc::Status PublicMessageHandler::CheckReady(grpc::ServerContextBase* context, ServerComponent component)
+{
+    if (!mReadiness) {
+        return grpc::Status::OK;
+    }
+
+    return mReadiness->Check(context, component);
+}
+
 /***********************************************************************************************************************
  * Private
  **********************************************************************************************************************/
 
+Error PublicMessageHandler::GetNodesSnapshot(std::vector<iamproto::NodeInfo>& nodes)
+{
+    StaticArray<StaticString<cNodeIDLen>, cMaxNumNodes> nodeIDs;
+
+    if (auto err = mNodeManager->GetAllNodeIds(nodeIDs); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    auto nodeInfo = std::make_unique<NodeInfo>();
+
+    for (const auto& id : nodeIDs) {
+        if (auto err = mNodeManager->GetNodeInfo(id, *nodeInfo); !err.IsNone()) {
+            // node may be removed after its ID is taken
+            if (err.Is(ErrorEnum::eNotFound)) {
+                continue;
+            }
+
+            return AOS_ERROR_WRAP(err);
+        }
+
+        nodes.push_back(common::pbconvert::ConvertToProto(*nodeInfo));
+    }
+
+    return ErrorEnum::eNone;
+}
+
 /***********************************************************************************************************************
  * IAMVersionService implementation
  **********************************************************************************************************************/
@@ -175,12 +308,16 @@ grpc::Status PublicMessageHandler::GetNodeInfo([[maybe_unused]] grpc::ServerCont
     return grpc::Status::OK;
 }
 
-grpc::Status PublicMessageHandler::GetCert([[maybe_unused]] grpc::ServerContext* context,
+grpc::Status PublicMessageHandler::GetCert(grpc::ServerContext* context,
     const iamproto::GetCertRequest* request, iamproto::CertInfo* response)
 {
     LOG_DBG() << "Process get cert request: type=" << request->type().c_str()
               << ", serial=" << request->serial().c_str();
 
+    if (auto status = CheckReady(context, ServerComponent::eCertificates); !status.ok()) {
+        return status;
+    }
+
     response->set_type(request->type());
 
     auto issuer
@@ -210,12 +347,23 @@ grpc::Status PublicMessageHandler::GetCert([[maybe_unused]] grpc::ServerContext*
     return grpc::Status::OK;
 }
 
-grpc::Status PublicMessageHandler::SubscribeCertChanged([[maybe_unused]] grpc::ServerContext* context,
+grpc::Status PublicMessageHandler::SubscribeCertChanged(grpc::ServerContext* context,
     const iamanager::v5::SubscribeCertChangedRequest* request, grpc::ServerWriter<iamanager::v5::CertInfo>* writer)
 {
     LOG_DBG() << "Process subscribe cert changed: type=" << request->type().c_str();
 
-    auto certWriter = std::make_shared<CertWriter>(request->type());
+    if (auto status = CheckReady(context, ServerComponent::eCertificates); !status.ok()) {
+        return status;
+    }
+
+    // one stream may watch several cert types listed in metadata besides the request one
+    auto certTypes = GetClientMetadataValues(context, cCertTypeMetadataKey);
+
+    if (!request->type().empty() || certTypes.empty()) {
+        certTypes.insert(request->type());
+    }
+
+    auto certWriter = std::make_shared<CertWriter>(std::vector<std::string>(certTypes.begin(), certTypes.end()));
 
     {
         std::lock_guard lock {mCertWritersLock};
@@ -223,20 +371,33 @@ grpc::Status PublicMessageHandler::SubscribeCertChanged([[maybe_unused]] grpc::S
         mCertWriters.push_back(certWriter);
     }
 
-    auto err = mCertProvider->SubscribeCertChanged(request->type().c_str(), *certWriter);
-    if (!err.IsNone()) {
-        LOG_ERR() << "Failed to subscribe cert changed, err=" << err;
+    auto status = grpc::Status::OK;
 
-        return common::pbconvert::ConvertAosErrorToGrpcStatus(err);
+    for (const auto& receiver : certWriter->GetReceivers()) {
+        if (auto err = mCertProvider->SubscribeCertChanged(receiver->GetCertType().c_str(), *receiver);
+            !err.IsNone()) {
+            LOG_ERR() << "Failed to subscribe cert changed: type=" << receiver->GetCertType().c_str()
+                      << ", err=" << err;
+
+            status = common::pbconvert::ConvertAosErrorToGrpcStatus(err);
+
+            break;
+        }
     }
 
-    auto status = certWriter->HandleStream(context, writer);
+    if (status.ok()) {
+        status = certWriter->HandleStream(context, writer);
+    }
 
-    err = mCertProvider->UnsubscribeCertChanged(*certWriter);
-    if (!err.IsNone()) {
-        LOG_ERR() << "Failed to unsubscribe cert changed, err=" << err;
+    for (const auto& receiver : certWriter->GetReceivers()) {
+        if (auto err = mCertProvider->UnsubscribeCertChanged(*receiver); !err.IsNone()) {
+            LOG_ERR() << "Failed to unsubscribe cert changed: type=" << receiver->GetCertType().c_str()
+                      << ", err=" << err;
 
-        return common::pbconvert::ConvertAosErrorToGrpcStatus(err);
+            if (status.ok()) {
+                status = common::pbconvert::ConvertAosErrorToGrpcStatus(err);
+            }
+        }
     }
 
     {
@@ -253,11 +414,15 @@ grpc::Status PublicMessageHandler::SubscribeCertChanged([[maybe_unused]] grpc::S
  * IAMPublicIdentityService implementation
  **********************************************************************************************************************/
 
-grpc::Status PublicMessageHandler::GetSystemInfo([[maybe_unused]] grpc::ServerContext* context,
+grpc::Status PublicMessageHandler::GetSystemInfo(grpc::ServerContext* context,
     [[maybe_unused]] const google::protobuf::Empty* request, iamproto::SystemInfo* response)
 {
     LOG_DBG() << "Process get system info";
 
+    if (auto status = CheckReady(context, ServerComponent::eIdentifier); !status.ok()) {
+        return status;
+    }
+
     StaticString<cSystemIDLen> systemID;
     Error                      err;
 
@@ -283,11 +448,15 @@ grpc::Status PublicMessageHandler::GetSystemInfo([[maybe_unused]] grpc::ServerCo
     return grpc::Status::OK;
 }
 
-grpc::Status PublicMessageHandler::GetSubjects([[maybe_unused]] grpc::ServerContext* context,
+grpc::Status PublicMessageHandler::GetSubjects(grpc::ServerContext* context,
     [[maybe_unused]] const google::protobuf::Empty* request, iamproto::Subjects* response)
 {
     LOG_DBG() << "Process get subjects";
 
+    if (auto status = CheckReady(context, ServerComponent::eIdentifier); !status.ok()) {
+        return status;
+    }
+
     StaticArray<StaticString<cSubjectIDLen>, cMaxSubjectIDSize> subjects;
 
     if (auto err = GetIdentHandler()->GetSubjects(subjects); !err.IsNone()) {
@@ -303,12 +472,22 @@ grpc::Status PublicMessageHandler::GetSubjects([[maybe_unused]] grpc::ServerCont
     return grpc::Status::OK;
 }
 
-grpc::Status PublicMessageHandler::SubscribeSubjectsChanged([[maybe_unused]] grpc::ServerContext* context,
+grpc::Status PublicMessageHandler::SubscribeSubjectsChanged(grpc::ServerContext* context,
     [[maybe_unused]] const google::protobuf::Empty* request, grpc::ServerWriter<iamproto::Subjects>* writer)
 {
     LOG_DBG() << "Process subscribe subjects changed";
 
-    return mSubjectsChangedController.HandleStream(context, writer);
+    if (auto status = CheckReady(context, ServerComponent::eIdentifier); !status.ok()) {
+        return status;
+    }
+
+    std::optional<uint64_t> resumeSequence;
+
+    if (auto status = GetResumeSequence(context, resumeSequence); !status.ok()) {
+        return status;
+    }
+
+    return mSubjectsChangedController.HandleStream(context, writer, resumeSequence);
 }
 
 /***********************************************************************************************************************
@@ -390,12 +569,51 @@ grpc::Status PublicMessageHandler::GetNodeInfo([[maybe_unused]] grpc::ServerCont
     return grpc::Status::OK;
 }
 
-grpc::Status PublicMessageHandler::SubscribeNodeChanged([[maybe_unused]] grpc::ServerContext* context,
+grpc::Status PublicMessageHandler::SubscribeNodeChanged(grpc::ServerContext* context,
     [[maybe_unused]] const google::protobuf::Empty* request, grpc::ServerWriter<iamproto::NodeInfo>* writer)
 {
     LOG_DBG() << "Process subscribe node changed";
 
-    return mNodeChangedController.HandleStream(context, writer);
+    auto                    filter = CreateNodeFilter(context);
+    std::optional<uint64_t> resumeSequence;
+
+    if (auto status = GetResumeSequence(context, resumeSequence); !status.ok()) {
+        return status;
+    }
+
+    // resumed stream gets missed notifications only, snapshot is requested by the client on resync
+    if (resumeSequence.has_value() || GetClientMetadata(context, cSnapshotMetadataKey) != "true") {
+        return mNodeChangedController.HandleStream(context, writer, resumeSequence, filter);
+    }
+
+    // sequence is taken before the snapshot, so changes made while it is collected are sent as notifications as well,
+    // node info holds the whole node state and applying it twice is harmless
+    const auto                      sequence = mNodeChangedController.GetLastSequence();
+    std::vector<iamproto::NodeInfo> nodes;
+
+    if (auto err = GetNodesSnapshot(nodes); !err.IsNone()) {
+        LOG_ERR() << "Failed to get nodes snapshot: err=" << err;
+
+        return common::pbconvert::ConvertAosErrorToGrpcStatus(err);
+    }
+
+    if (filter) {
+        nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [&filter](const auto& node) { return !filter(node); }),
+            nodes.end());
+    }
+
+    context->AddInitialMetadata(cSnapshotSizeMetadataKey, std::to_string(nodes.size()));
+    writer->SendInitialMetadata();
+
+    for (auto& node : nodes) {
+        SetSequence(node, sequence);
+
+        if (!writer->Write(node)) {
+            return grpc::Status::OK;
+        }
+    }
+
+    return mNodeChangedController.HandleStream(context, writer, sequence, filter);
 }
 
 grpc::Status PublicMessageHandler::RegisterNode(grpc::ServerContext*                        context,
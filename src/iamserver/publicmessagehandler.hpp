@@ -8,7 +8,9 @@
 #ifndef PUBLICMESSAGEHANDLER_HPP_
 #define PUBLICMESSAGEHANDLER_HPP_
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <optional>
 #include <shared_mutex>
 #include <string>
@@ -27,6 +29,7 @@
 #include <iamanager/version.grpc.pb.h>
 
 #include "nodecontroller.hpp"
+#include "readiness.hpp"
 #include "streamwriter.hpp"
 
 namespace aos::iam::iamserver {
@@ -60,6 +63,13 @@ public:
         iam::permhandler::PermHandlerItf& permHandler, iam::nodeinfoprovider::NodeInfoProviderItf& nodeInfoProvider,
         iam::nodemanager::NodeManagerItf& nodeManager, iam::certprovider::CertProviderItf& certProvider);
 
+    /**
+     * Sets readiness of components handled requests depend on. Without it all components are considered ready.
+     *
+     * @param readiness component readiness.
+     */
+    void SetReadiness(const ComponentReadiness& readiness) { mReadiness = &readiness; }
+
     /**
      * Registers grpc services.
      *
@@ -108,24 +118,47 @@ protected:
     iam::nodemanager::NodeManagerItf*           GetNodeManager() { return mNodeManager; }
     Error                                       SetNodeStatus(const std::string& nodeID, const NodeStatus& status);
     bool                                        ProcessOnThisNode(const std::string& nodeID);
+    grpc::Status                                CheckReady(grpc::ServerContextBase* context, ServerComponent component);
 
     template <typename R>
-    grpc::Status RequestWithRetry(R request)
+    grpc::Status RequestWithRetry(const grpc::ServerContextBase* context, R request)
     {
-        std::unique_lock lock {mMutex};
-
-        grpc::Status status = grpc::Status::OK;
+        const auto   deadline = GetCallDeadline(context);
+        grpc::Status status   = grpc::Status::OK;
 
         for (auto i = 0; i < cRequestRetryMaxTry; i++) {
-            if (mClose) {
-                return common::pbconvert::ConvertAosErrorToGrpcStatus({ErrorEnum::eWrongState, "handler is closed"});
+            {
+                std::lock_guard lock {mMutex};
+
+                if (mClose) {
+                    return common::pbconvert::ConvertAosErrorToGrpcStatus(
+                        {ErrorEnum::eWrongState, "handler is closed"});
+                }
+            }
+
+            // retry makes no sense when the caller is gone or its deadline is exceeded
+            if (context->IsCancelled()) {
+                return grpc::Status::CANCELLED;
             }
 
+            if (deadline.has_value() && std::chrono::steady_clock::now() >= *deadline) {
+                return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "call deadline exceeded");
+            }
+
+            // lock is not held while the request is in progress to not block other requests
             if (status = request(); status.ok()) {
                 return status;
             }
 
-            mRetryCondVar.wait_for(lock, cRequestRetryTimeout, [this] { return mClose; });
+            auto retryTime = std::chrono::steady_clock::now() + cRequestRetryTimeout;
+
+            if (deadline.has_value()) {
+                retryTime = std::min(retryTime, *deadline);
+            }
+
+            std::unique_lock lock {mMutex};
+
+            mRetryCondVar.wait_until(lock, retryTime, [this] { return mClose; });
         }
 
         return status;
@@ -137,6 +170,8 @@ private:
     static constexpr auto       cRequestRetryTimeout = std::chrono::seconds(10);
     static constexpr auto       cRequestRetryMaxTry  = 3;
 
+    Error GetNodesSnapshot(std::vector<iamproto::NodeInfo>& nodes);
+
     // IAMVersionService interface
     grpc::Status GetAPIVersion(
         grpc::ServerContext* context, const google::protobuf::Empty* request, iamanager::APIVersion* response) override;
@@ -178,6 +213,7 @@ private:
     iam::nodemanager::NodeManagerItf*           mNodeManager      = nullptr;
     iam::certprovider::CertProviderItf*         mCertProvider     = nullptr;
     NodeController*                             mNodeController   = nullptr;
+    const ComponentReadiness*                   mReadiness        = nullptr;
     StreamWriter<iamproto::NodeInfo>            mNodeChangedController;
     StreamWriter<iamproto::Subjects>            mSubjectsChangedController;
     NodeInfo                                    mNodeInfo;
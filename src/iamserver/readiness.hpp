@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef READINESS_HPP_
+#define READINESS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#include <grpcpp/server_context.h>
+
+namespace aos::iam::iamserver {
+
+/**
+ * Server components initialized independently from the server start.
+ */
+enum class ServerComponent {
+    eIdentifier,
+    eCertificates,
+};
+
+/**
+ * Tracks readiness of server components. All components are ready unless explicitly marked as pending.
+ */
+class ComponentReadiness {
+public:
+    /**
+     * Metadata key with retry delay hint recognized by gRPC client retry policy.
+     */
+    static constexpr auto cRetryPushbackKey = "grpc-retry-pushback-ms";
+
+    /**
+     * Retry delay hint for requests to not ready components.
+     */
+    static constexpr auto cRetryPushback = std::chrono::milliseconds(1000);
+
+    /**
+     * Marks component as pending.
+     *
+     * @param component component.
+     */
+    void SetPending(ServerComponent component) { mPending |= Mask(component); }
+
+    /**
+     * Marks component as ready.
+     *
+     * @param component component.
+     */
+    void SetReady(ServerComponent component) { mPending &= ~Mask(component); }
+
+    /**
+     * Checks if component is ready.
+     *
+     * @param component component.
+     * @return bool.
+     */
+    bool IsReady(ServerComponent component) const { return (mPending & Mask(component)) == 0; }
+
+    /**
+     * Checks if component required by the request is ready. If not, sets retry hint to the call trailing metadata.
+     *
+     * @param context server context.
+     * @param component component.
+     * @return grpc::Status OK if ready, UNAVAILABLE otherwise.
+     */
+    grpc::Status Check(grpc::ServerContextBase* context, ServerComponent component) const
+    {
+        if (IsReady(component)) {
+            return grpc::Status::OK;
+        }
+
+        if (context) {
+            context->AddTrailingMetadata(cRetryPushbackKey, std::to_string(cRetryPushback.count()));
+        }
+
+        return grpc::Status(grpc::StatusCode::UNAVAILABLE,
+            component == ServerComponent::eIdentifier ? "identifier is not ready" : "certificates are not ready");
+    }
+
+private:
+    static uint32_t Mask(ServerComponent component) { return 1U << static_cast<uint32_t>(component); }
+
+    std::atomic<uint32_t> mPending {0};
+};
+
+} // namespace aos::iam::iamserver
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#include <grpcpp/security/tls_credentials_options.h>
+
+#include <utils/exception.hpp>
+
+#include "logger/logmodule.hpp"
+#include "reloadablecredentials.hpp"
+
+namespace aos::iam::iamserver {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Statics
+ **********************************************************************************************************************/
+
+// gRPC loads private keys starting with "engine:" through the OpenSSL engine, so the key stays in the HSM
+constexpr auto cPKCS11EnginePrefix = "engine:pkcs11:";
+
+void WriteFile(const std::filesystem::path& path, const std::string& content)
+{
+    std::ofstream file(path, std::ios::trunc);
+
+    if (!file || !(file << content) || !file.flush()) {
+        AOS_ERROR_THROW(ErrorEnum::eFailed, "can't write key material");
+    }
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+ReloadableCredentials::~ReloadableCredentials()
+{
+    mProvider.reset();
+
+    RemoveDir();
+}
+
+Error ReloadableCredentials::Init(const certhandler::CertInfo& certInfo, const std::string& caCert,
+    crypto::CertLoaderItf& certLoader, crypto::x509::ProviderItf& cryptoProvider)
+{
+    std::lock_guard lock {mMutex};
+
+    LOG_DBG() << "Init reloadable credentials";
+
+    mCertLoader     = &certLoader;
+    mCryptoProvider = &cryptoProvider;
+
+    try {
+        RemoveDir();
+
+        auto dir = (std::filesystem::temp_directory_path() / "aos-iamserver-XXXXXX").string();
+
+        // directory is created with 0700 mode: key material is accessible by the owner only
+        if (mkdtemp(dir.data()) == nullptr) {
+            AOS_ERROR_THROW(Error(errno), "can't create key material directory");
+        }
+
+        mDir        = dir;
+        mGeneration = 0;
+
+        WriteKeyMaterial(certInfo);
+
+        const auto current = std::filesystem::path(mDir) / cCurrentDir;
+
+        // provider reads the files in constructor, so servers are never started without key material
+        mProvider = std::make_shared<grpc::experimental::FileWatcherCertificateProvider>(
+            (current / cKeyFile).string(), (current / cCertFile).string(), caCert, cRefreshIntervalSec);
+    } catch (const std::exception& e) {
+        return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error ReloadableCredentials::Update(const certhandler::CertInfo& certInfo)
+{
+    std::lock_guard lock {mMutex};
+
+    LOG_DBG() << "Update reloadable credentials: certURL=" << certInfo.mCertURL;
+
+    if (!mProvider) {
+        return AOS_ERROR_WRAP(ErrorEnum::eWrongState);
+    }
+
+    try {
+        WriteKeyMaterial(certInfo);
+    } catch (const std::exception& e) {
+        return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+    }
+
+    return ErrorEnum::eNone;
+}
+
+std::shared_ptr<grpc::ServerCredentials> ReloadableCredentials::GetTLSCredentials() const
+{
+    grpc::experimental::TlsServerCredentialsOptions options {mProvider};
+
+    options.watch_identity_key_cert_pairs();
+    options.set_cert_request_type(GRPC_SSL_DONT_REQUEST_CLIENT_CERTIFICATE);
+
+    return grpc::experimental::TlsServerCredentials(options);
+}
+
+std::shared_ptr<grpc::ServerCredentials> ReloadableCredentials::GetMTLSCredentials() const
+{
+    grpc::experimental::TlsServerCredentialsOptions options {mProvider};
+
+    options.watch_identity_key_cert_pairs();
+    options.watch_root_certs();
+    options.set_cert_request_type(GRPC_SSL_REQUEST_AND_REQUIRE_CLIENT_CERTIFICATE_AND_VERIFY);
+
+    return grpc::experimental::TlsServerCredentials(options);
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+void ReloadableCredentials::WriteKeyMaterial(const certhandler::CertInfo& certInfo)
+{
+    const auto generationDir = std::filesystem::path(GetGenerationDir(mGeneration + 1));
+
+    std::filesystem::create_directory(generationDir);
+
+    WriteFile(generationDir / cKeyFile, cPKCS11EnginePrefix + std::string(certInfo.mKeyURL.CStr()));
+    WriteFile(generationDir / cCertFile, GetCertChainPEM(certInfo));
+
+    // Key and certificate are switched together by replacing the symlink, so the watcher never reads a key of one
+    // generation with a certificate of another one. The previous generation is kept as the watcher may be reading it.
+    const auto current = std::filesystem::path(mDir) / cCurrentDir;
+    const auto link    = std::filesystem::path(mDir) / (std::string(cCurrentDir) + ".tmp");
+
+    std::filesystem::remove(link);
+    std::filesystem::create_directory_symlink(generationDir.filename(), link);
+    std::filesystem::rename(link, current);
+
+    if (mGeneration > 0) {
+        std::filesystem::remove_all(GetGenerationDir(mGeneration - 1));
+    }
+
+    mGeneration++;
+}
+
+std::string ReloadableCredentials::GetCertChainPEM(const certhandler::CertInfo& certInfo)
+{
+    auto [chain, err] = mCertLoader->LoadCertsChainByURL(certInfo.mCertURL);
+    AOS_ERROR_CHECK_AND_THROW(err, "can't load certificate chain");
+
+    std::string chainPEM;
+
+    for (const auto& cert : *chain) {
+        StaticString<crypto::cCertPEMLen> certPEM;
+
+        err = mCryptoProvider->X509CertToPEM(cert, certPEM);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't convert certificate to PEM");
+
+        chainPEM += certPEM.CStr();
+    }
+
+    return chainPEM;
+}
+
+std::string ReloadableCredentials::GetGenerationDir(uint64_t generation) const
+{
+    return (std::filesystem::path(mDir) / std::to_string(generation)).string();
+}
+
+void ReloadableCredentials::RemoveDir()
+{
+    if (mDir.empty()) {
+        return;
+    }
+
+    std::error_code ec;
+
+    if (std::filesystem::remove_all(mDir, ec); ec) {
+        LOG_WRN() << "Can't remove key material directory: path=" << mDir.c_str() << ", err=" << ec.message().c_str();
+    }
+
+    mDir.clear();
+}
+
+} // namespace aos::iam::iamserver
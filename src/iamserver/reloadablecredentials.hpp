@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef RELOADABLECREDENTIALS_HPP_
+#define RELOADABLECREDENTIALS_HPP_
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <grpcpp/security/server_credentials.h>
+#include <grpcpp/security/tls_certificate_provider.h>
+
+#include <aos/common/crypto/utils.hpp>
+#include <aos/iam/certhandler.hpp>
+
+namespace aos::iam::iamserver {
+
+/**
+ * TLS server credentials with reloadable key material. Servers built with the credentials are kept running on key
+ * material update: new handshakes get the new certificate, established connections and streams are not affected.
+ */
+class ReloadableCredentials {
+public:
+    /**
+     * Destructor.
+     */
+    ~ReloadableCredentials();
+
+    /**
+     * Initializes credentials.
+     *
+     * @param certInfo certificate info.
+     * @param caCert path to CA certificate used to verify clients.
+     * @param certLoader certificate loader.
+     * @param cryptoProvider crypto provider.
+     * @returns Error.
+     */
+    Error Init(const certhandler::CertInfo& certInfo, const std::string& caCert, crypto::CertLoaderItf& certLoader,
+        crypto::x509::ProviderItf& cryptoProvider);
+
+    /**
+     * Updates key material.
+     *
+     * @param certInfo certificate info.
+     * @returns Error.
+     */
+    Error Update(const certhandler::CertInfo& certInfo);
+
+    /**
+     * Returns TLS credentials.
+     *
+     * @return std::shared_ptr<grpc::ServerCredentials>.
+     */
+    std::shared_ptr<grpc::ServerCredentials> GetTLSCredentials() const;
+
+    /**
+     * Returns mTLS credentials.
+     *
+     * @return std::shared_ptr<grpc::ServerCredentials>.
+     */
+    std::shared_ptr<grpc::ServerCredentials> GetMTLSCredentials() const;
+
+private:
+    // file watcher doesn't support shorter intervals
+    static constexpr unsigned cRefreshIntervalSec = 1;
+    static constexpr auto     cCurrentDir         = "current";
+    static constexpr auto     cKeyFile            = "key.pem";
+    static constexpr auto     cCertFile           = "cert.pem";
+
+    void        WriteKeyMaterial(const certhandler::CertInfo& certInfo);
+    std::string GetCertChainPEM(const certhandler::CertInfo& certInfo);
+    std::string GetGenerationDir(uint64_t generation) const;
+    void        RemoveDir();
+
+    std::mutex                                                           mMutex;
+    crypto::CertLoaderItf*                                               mCertLoader     = nullptr;
+    crypto::x509::ProviderItf*                                           mCryptoProvider = nullptr;
+    std::string                                                          mDir;
+    uint64_t                                                             mGeneration = 0;
+    std::shared_ptr<grpc::experimental::FileWatcherCertificateProvider> mProvider;
+};
+
+} // namespace aos::iam::iamserver
+
+#endif
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <google/protobuf/message_lite.h>
+#include <grpcpp/server_context.h>
+#include <grpcpp/support/byte_buffer.h>
+
+#include "logger/logmodule.hpp"
+#include "metrics/metrics.hpp"
+#include "rpcinterceptor.hpp"
+#include "tracer/tracer.hpp"
+
+namespace aos::iam::iamserver {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+const std::vector<double> cMessageSizeBuckets = {64, 256, 1024, 4096, 16384, 65536, 262144, 1048576};
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+// full method name is /package.Service/Method, trace tag has room for the method only
+const char* GetShortMethodName(const char* method)
+{
+    if (!method) {
+        return "";
+    }
+
+    const auto pos = strrchr(method, '/');
+
+    return pos ? pos + 1 : method;
+}
+
+// all IAM services exchange protobuf messages. Received message is already parsed, so its size is computed again by
+// ByteSizeLong: one walk over the message fields, paid only while metrics are enabled, which is accepted.
+size_t GetMessageSize(const void* message)
+{
+    return message ? static_cast<const google::protobuf::MessageLite*>(message)->ByteSizeLong() : 0;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * RPCInterceptor
+ **********************************************************************************************************************/
+
+struct RPCInterceptor::MethodMetrics {
+    metrics::Counter&   mCalls;
+    metrics::Histogram& mDuration;
+    metrics::Histogram& mRequestSize;
+    metrics::Histogram& mResponseSize;
+};
+
+std::atomic<uint64_t> RPCInterceptor::sCallID {0};
+
+RPCInterceptor::RPCInterceptor(
+    grpc::experimental::ServerRpcInfo* info, std::chrono::nanoseconds slowCallThreshold)
+    : mInfo(info)
+    , mMethod(GetShortMethodName(info->method()))
+    , mCallID(sCallID.fetch_add(1, std::memory_order_relaxed))
+    , mSlowCallThreshold(slowCallThreshold)
+    , mStart(std::chrono::steady_clock::now())
+{
+    tracer::Record(tracer::EventType::eRPCStart, mMethod, mCallID);
+
+    if (metrics::IsEnabled()) {
+        mMetrics = &GetMethodMetrics(mMethod);
+    }
+}
+
+void RPCInterceptor::Intercept(grpc::experimental::InterceptorBatchMethods* methods)
+{
+    using grpc::experimental::InterceptionHookPoints;
+
+    if (mMetrics && methods->QueryInterceptionHookPoint(InterceptionHookPoints::POST_RECV_MESSAGE)) {
+        mMetrics->mRequestSize.Observe(GetMessageSize(methods->GetRecvMessage()));
+    }
+
+    // response is serialized here instead of later in gRPC, and the serialized buffer is sent, so its size is free
+    if (mMetrics && methods->QueryInterceptionHookPoint(InterceptionHookPoints::PRE_SEND_MESSAGE)) {
+        const auto buffer = methods->GetSerializedSendMessage();
+
+        mMetrics->mResponseSize.Observe(buffer ? buffer->Length() : 0);
+    }
+
+    if (methods->QueryInterceptionHookPoint(InterceptionHookPoints::PRE_SEND_STATUS)) {
+        OnCallEnd(methods->GetSendStatus());
+    }
+
+    methods->Proceed();
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+const RPCInterceptor::MethodMetrics& RPCInterceptor::GetMethodMetrics(const char* method)
+{
+    static std::mutex                           sMutex;
+    static std::map<std::string, MethodMetrics> sMethods;
+
+    std::lock_guard lock {sMutex};
+
+    if (auto it = sMethods.find(method); it != sMethods.end()) {
+        return it->second;
+    }
+
+    auto&                 registry = metrics::GetRegistry();
+    const metrics::Labels labels   = {{"method", method}};
+
+    return sMethods
+        .emplace(method,
+            MethodMetrics {registry.GetCounter("aos_iam_rpc_total", "Number of handled RPCs", labels),
+                registry.GetHistogram("aos_iam_rpc_duration_seconds", "RPC handling duration", labels),
+                registry.GetHistogram(
+                    "aos_iam_rpc_request_bytes", "RPC request message size", labels, cMessageSizeBuckets),
+                registry.GetHistogram(
+                    "aos_iam_rpc_response_bytes", "RPC response message size", labels, cMessageSizeBuckets)})
+        .first->second;
+}
+
+void RPCInterceptor::OnCallEnd(const grpc::Status& status)
+{
+    const auto duration = std::chrono::steady_clock::now() - mStart;
+    const auto code     = status.error_code();
+
+    tracer::Record(tracer::EventType::eRPCEnd, mMethod, mCallID, code);
+
+    if (mMetrics) {
+        mMetrics->mCalls.Inc();
+        mMetrics->mDuration.Observe(std::chrono::duration<double>(duration).count());
+
+        if (code != grpc::StatusCode::OK) {
+            metrics::GetRegistry()
+                .GetCounter("aos_iam_rpc_errors_total", "Number of RPCs finished with error",
+                    {{"method", mMethod}, {"code", std::to_string(code)}})
+                .Inc();
+        }
+    }
+
+    // streaming calls live as long as the client is subscribed, only unary calls are checked
+    if (mSlowCallThreshold.count() == 0 || duration < mSlowCallThreshold
+        || mInfo->type() != grpc::experimental::ServerRpcInfo::Type::UNARY) {
+        return;
+    }
+
+    LOG_WRN() << "Slow call: method=" << mMethod << ", peer=" << mInfo->server_context()->peer().c_str()
+              << ", duration=" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count()
+              << "ms, code=" << static_cast<int>(code);
+}
+
+/***********************************************************************************************************************
+ * RPCInterceptorFactory
+ **********************************************************************************************************************/
+
+RPCInterceptorFactory::RPCInterceptorFactory(std::chrono::nanoseconds slowCallThreshold)
+    : mSlowCallThreshold(slowCallThreshold)
+{
+}
+
+grpc::experimental::Interceptor* RPCInterceptorFactory::CreateServerInterceptor(
+    grpc::experimental::ServerRpcInfo* info)
+{
+    return new RPCInterceptor(info, mSlowCallThreshold);
+}
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+std::vector<std::unique_ptr<grpc::experimental::ServerInterceptorFactoryInterface>> CreateInterceptorFactories(
+    std::chrono::nanoseconds slowCallThreshold)
+{
+    std::vector<std::unique_ptr<grpc::experimental::ServerInterceptorFactoryInterface>> factories;
+
+    factories.push_back(std::make_unique<RPCInterceptorFactory>(slowCallThreshold));
+
+    return factories;
+}
+
+} // namespace aos::iam::iamserver
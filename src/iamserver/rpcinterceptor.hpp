@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef RPCINTERCEPTOR_HPP_
+#define RPCINTERCEPTOR_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <grpcpp/support/server_interceptor.h>
+
+namespace aos::iam::iamserver {
+
+/**
+ * Server interceptor accounting RPC latency, status codes and message sizes. It records RPC start and end to the trace
+ * ring and reports unary calls slower than the threshold.
+ */
+class RPCInterceptor : public grpc::experimental::Interceptor {
+public:
+    /**
+     * Constructor.
+     *
+     * @param info RPC info.
+     * @param slowCallThreshold slow unary call threshold, zero disables slow call reporting.
+     */
+    RPCInterceptor(grpc::experimental::ServerRpcInfo* info, std::chrono::nanoseconds slowCallThreshold);
+
+    /**
+     * Intercepts RPC hook point.
+     *
+     * @param methods interceptor batch methods.
+     */
+    void Intercept(grpc::experimental::InterceptorBatchMethods* methods) override;
+
+private:
+    static std::atomic<uint64_t> sCallID;
+
+    struct MethodMetrics;
+
+    static const MethodMetrics& GetMethodMetrics(const char* method);
+
+    void OnCallEnd(const grpc::Status& status);
+
+    grpc::experimental::ServerRpcInfo*    mInfo;
+    const char*                           mMethod;
+    uint64_t                              mCallID;
+    std::chrono::nanoseconds              mSlowCallThreshold;
+    const MethodMetrics*                  mMetrics = nullptr;
+    std::chrono::steady_clock::time_point mStart;
+};
+
+/**
+ * RPC interceptor factory.
+ */
+class RPCInterceptorFactory : public grpc::experimental::ServerInterceptorFactoryInterface {
+public:
+    /**
+     * Constructor.
+     *
+     * @param slowCallThreshold slow unary call threshold, zero disables slow call reporting.
+     */
+    explicit RPCInterceptorFactory(std::chrono::nanoseconds slowCallThreshold);
+
+    /**
+     * Creates interceptor for RPC.
+     *
+     * @param info RPC info.
+     * @return grpc::experimental::Interceptor*.
+     */
+    grpc::experimental::Interceptor* CreateServerInterceptor(grpc::experimental::ServerRpcInfo* info) override;
+
+private:
+    std::chrono::nanoseconds mSlowCallThreshold;
+};
+
+/**
+ * Creates server interceptor factories.
+ *
+ * @param slowCallThreshold slow unary call threshold, zero disables slow call reporting.
+ * @return std::vector<std::unique_ptr<grpc::experimental::ServerInterceptorFactoryInterface>>.
+ */
+std::vector<std::unique_ptr<grpc::experimental::ServerInterceptorFactoryInterface>> CreateInterceptorFactories(
+    std::chrono::nanoseconds slowCallThreshold);
+
+} // namespace aos::iam::iamserver
+
+#endif
@@ -8,25 +8,179 @@
 #ifndef STREAMWRITER_HPP_
 #define STREAMWRITER_HPP_
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <google/protobuf/unknown_field_set.h>
 #include <iamanager/v5/iamanager.grpc.pb.h>
 
+#include "metrics/metrics.hpp"
+
 namespace aos::iam::iamserver {
 
 /**
- * Controls writes to streams.
+ * Client metadata key requesting subscription to start with the current state snapshot, the value should be "true".
+ */
+constexpr auto cSnapshotMetadataKey = "aos-snapshot";
+
+/**
+ * Initial metadata key holding the number of snapshot messages sent before notifications.
+ */
+constexpr auto cSnapshotSizeMetadataKey = "aos-snapshot-size";
+
+/**
+ * Client metadata key resuming subscription after the notification with the given sequence number.
+ */
+constexpr auto cResumeSequenceMetadataKey = "aos-resume-sequence";
+
+/**
+ * Client metadata key holding the instance ID of the notification given in the resume sequence metadata.
+ */
+constexpr auto cResumeInstanceMetadataKey = "aos-resume-instance";
+
+/**
+ * Client metadata key limiting node subscription to the node ID, may be repeated.
+ */
+constexpr auto cNodeIDMetadataKey = "aos-node-id";
+
+/**
+ * Client metadata key limiting node subscription to the node type, may be repeated.
+ */
+constexpr auto cNodeTypeMetadataKey = "aos-node-type";
+
+/**
+ * Client metadata key limiting node subscription to node status transitions, the value should be "true".
+ */
+constexpr auto cNodeStatusChangesMetadataKey = "aos-node-status-changes";
+
+/**
+ * Client metadata key adding certificate type to certificate subscription, may be repeated.
+ */
+constexpr auto cCertTypeMetadataKey = "aos-cert-type";
+
+/**
+ * Status message of stream finished as the client should resync its state and subscribe again.
+ */
+constexpr auto cResyncRequired = "resync required";
+
+/**
+ * Field number carrying notification sequence number in stream messages. The field is not declared in the proto
+ * schema: it is kept as unknown field, so clients not aware of it ignore it.
+ */
+constexpr int cSequenceFieldNumber = 536870002;
+
+/**
+ * Field number carrying instance ID in stream messages. The field is kept as unknown field as the sequence one.
+ */
+constexpr int cInstanceFieldNumber = 536870003;
+
+/**
+ * Returns instance ID of the process. The ID is random, so sequence numbers issued by a restarted process are not
+ * mixed up with the old ones.
+ *
+ * @return uint64_t.
+ */
+inline uint64_t GetInstanceID()
+{
+    static const uint64_t sInstanceID = []() {
+        std::random_device device;
+
+        return (static_cast<uint64_t>(device()) << 32) | device();
+    }();
+
+    return sInstanceID;
+}
+
+/**
+ * Returns varint unknown field of message.
+ *
+ * @param message message.
+ * @param number field number.
+ * @return std::optional<uint64_t>.
+ */
+inline std::optional<uint64_t> GetVarintField(const google::protobuf::Message& message, int number)
+{
+    const auto& fields = message.GetReflection()->GetUnknownFields(message);
+
+    for (int i = 0; i < fields.field_count(); i++) {
+        const auto& field = fields.field(i);
+
+        if (field.number() == number && field.type() == google::protobuf::UnknownField::TYPE_VARINT) {
+            return field.varint();
+        }
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * Sets notification sequence number and instance ID to stream message.
+ *
+ * @param message message.
+ * @param sequence sequence number.
+ */
+inline void SetSequence(google::protobuf::Message& message, uint64_t sequence)
+{
+    auto fields = message.GetReflection()->MutableUnknownFields(&message);
+
+    fields->DeleteByNumber(cSequenceFieldNumber);
+    fields->AddVarint(cSequenceFieldNumber, sequence);
+    fields->DeleteByNumber(cInstanceFieldNumber);
+    fields->AddVarint(cInstanceFieldNumber, GetInstanceID());
+}
+
+/**
+ * Returns notification sequence number of stream message.
+ *
+ * @param message message.
+ * @return std::optional<uint64_t>.
+ */
+inline std::optional<uint64_t> GetSequence(const google::protobuf::Message& message)
+{
+    return GetVarintField(message, cSequenceFieldNumber);
+}
+
+/**
+ * Returns instance ID of stream message.
+ *
+ * @param message message.
+ * @return std::optional<uint64_t>.
+ */
+inline std::optional<uint64_t> GetInstanceID(const google::protobuf::Message& message)
+{
+    return GetVarintField(message, cInstanceFieldNumber);
+}
+
+/**
+ * Controls writes to streams. Recent notifications are kept, so each stream gets all of them in order even if
+ * notifications come faster than the stream is written.
  */
 template <typename T>
 class StreamWriter {
 public:
     /**
-     * Closes all streams.
+     * Stream filter, returns true if notification should be sent to the stream.
+     */
+    using Filter = std::function<bool(const T&)>;
+
+    /**
+     * Starts stream writer.
      */
     void Start()
     {
         std::lock_guard lock {mMutex};
 
-        mIsRunning      = true;
-        mNotificationID = 0;
+        mIsRunning = true;
     }
 
     /**
@@ -38,7 +192,7 @@ public:
             std::lock_guard lock {mMutex};
 
             mIsRunning = false;
-            mLastMessage.reset();
+            mNotifications.clear();
         }
 
         mCV.notify_all();
@@ -54,75 +208,153 @@ public:
         {
             std::lock_guard lock {mMutex};
 
-            ++mNotificationID;
-            mLastMessage = message;
+            mNotifications.emplace_back(++mSequence, message);
+
+            if (mNotifications.size() > cMaxNotifications) {
+                mNotifications.pop_front();
+            }
         }
 
         mCV.notify_all();
     }
 
+    /**
+     * Returns sequence number of the last notification.
+     *
+     * @return uint64_t.
+     */
+    uint64_t GetLastSequence()
+    {
+        std::shared_lock lock {mMutex};
+
+        return mSequence;
+    }
+
     /**
      * Handles stream. Blocks the caller until the stream is closed.
      *
+     * If the start sequence is not set, the stream begins with the last notification. Otherwise, notifications
+     * following the start sequence are sent. If any of them is already dropped, or the sequence is unknown, the stream
+     * is finished with ABORTED status: the client should resync its state and subscribe again.
+     *
      * @param context server context.
      * @param writer server writer.
+     * @param startSequence sequence number of the last notification known to the client.
+     * @param filter stream filter, called once per notification from the stream thread only.
      * @return grpc::Status.
      */
-    grpc::Status HandleStream(grpc::ServerContext* context, grpc::ServerWriter<T>* writer)
+    grpc::Status HandleStream(grpc::ServerContext* context, grpc::ServerWriter<T>* writer,
+        std::optional<uint64_t> startSequence = std::nullopt, const Filter& filter = {})
     {
-        uint32_t lastNotificationID = 0;
+        static auto& subscribers = metrics::GetRegistry().GetGauge(
+            "aos_iam_stream_subscribers", "Number of subscribed streams", {{"message", T::descriptor()->name()}});
 
-        while (mIsRunning && !context->IsCancelled()) {
-            std::shared_lock lock {mMutex};
+        metrics::ScopedGauge subscriber {subscribers};
+        uint64_t             lastSequence = 0;
 
-            bool timedOut = !mCV.wait_for(lock, cWaitTimeout, [this, lastNotificationID] {
-                return (mNotificationID != lastNotificationID && mLastMessage.has_value()) || !mIsRunning;
-            });
+        {
+            std::shared_lock lock {mMutex};
 
-            if (!mIsRunning) {
-                break;
+            if (startSequence.has_value() && !IsResumable(*startSequence)) {
+                return grpc::Status(grpc::StatusCode::ABORTED, cResyncRequired);
             }
 
-            if (timedOut) {
-                continue;
-            }
+            lastSequence = startSequence.value_or(mNotifications.empty() ? mSequence : mSequence - 1);
+        }
+
+        while (!context->IsCancelled()) {
+            std::vector<T> messages;
+
+            {
+                std::shared_lock lock {mMutex};
+
+                bool timedOut = !mCV.wait_for(lock, cWaitTimeout, [this, lastSequence] {
+                    return (mSequence != lastSequence && !mNotifications.empty()) || !mIsRunning;
+                });
+
+                if (!mIsRunning) {
+                    break;
+                }
+
+                if (timedOut) {
+                    continue;
+                }
+
+                if (mNotifications.front().first > lastSequence + 1) {
+                    if (startSequence.has_value()) {
+                        return grpc::Status(grpc::StatusCode::ABORTED, cResyncRequired);
+                    }
+
+                    lastSequence = mNotifications.front().first - 1;
+                }
+
+                for (const auto& [sequence, message] : mNotifications) {
+                    // filtered out notifications are neither copied nor written
+                    if (sequence > lastSequence && (!filter || filter(message))) {
+                        messages.push_back(message);
+                        SetSequence(messages.back(), sequence);
+                    }
+                }
 
-            // got notification, send it to the client
-            if (!writer->Write(*mLastMessage)) {
-                break;
+                lastSequence = mSequence;
             }
 
-            lastNotificationID = mNotificationID;
+            // messages are written without lock to not block notifications by slow clients
+            for (const auto& message : messages) {
+                if (!writer->Write(message)) {
+                    return grpc::Status::OK;
+                }
+            }
         }
 
         return grpc::Status::OK;
     }
 
 private:
-    static constexpr auto cWaitTimeout = std::chrono::seconds(10);
+    static constexpr auto   cWaitTimeout      = std::chrono::seconds(10);
+    static constexpr size_t cMaxNotifications = 64;
+
+    // should be called under lock
+    bool IsResumable(uint64_t sequence) const
+    {
+        if (sequence == mSequence) {
+            return true;
+        }
 
-    bool                        mIsRunning = true;
-    std::condition_variable_any mCV;
-    std::shared_mutex           mMutex;
-    uint32_t                    mNotificationID = 0;
-    std::optional<T>            mLastMessage;
+        return sequence < mSequence && !mNotifications.empty() && mNotifications.front().first <= sequence + 1;
+    }
+
+    bool                               mIsRunning = true;
+    std::condition_variable_any        mCV;
+    std::shared_mutex                  mMutex;
+    uint64_t                           mSequence = 0;
+    std::deque<std::pair<uint64_t, T>> mNotifications;
 };
 
 /**
- * Sends certificate updates to GRPC streams.
+ * Writes updates of one certificate type to the stream writer.
  */
-class CertWriter : public StreamWriter<iamanager::v5::CertInfo>, public aos::iam::certhandler::CertReceiverItf {
+class CertReceiver : public aos::iam::certhandler::CertReceiverItf {
 public:
     /**
-     * CertWriter constructor.
+     * CertReceiver constructor.
      *
      * @param certType certificate type.
+     * @param writer stream writer.
      */
-    explicit CertWriter(const std::string& certType)
+    CertReceiver(const std::string& certType, StreamWriter<iamanager::v5::CertInfo>& writer)
         : mCertType(certType)
+        , mWriter(writer)
     {
     }
 
+    /**
+     * Returns certificate type.
+     *
+     * @return const std::string&.
+     */
+    const std::string& GetCertType() const { return mCertType; }
+
 private:
     void OnCertChanged(const aos::iam::certhandler::CertInfo& info) override
     {
@@ -132,10 +364,39 @@ private:
         grpcCertInfo.set_key_url(info.mKeyURL.CStr());
         grpcCertInfo.set_cert_url(info.mCertURL.CStr());
 
-        WriteToStreams(grpcCertInfo);
+        mWriter.WriteToStreams(grpcCertInfo);
     }
 
-    std::string mCertType;
+    std::string                            mCertType;
+    StreamWriter<iamanager::v5::CertInfo>& mWriter;
+};
+
+/**
+ * Sends updates of certificate types subscribed by the stream.
+ */
+class CertWriter : public StreamWriter<iamanager::v5::CertInfo> {
+public:
+    /**
+     * CertWriter constructor.
+     *
+     * @param certTypes certificate types.
+     */
+    explicit CertWriter(const std::vector<std::string>& certTypes)
+    {
+        for (const auto& certType : certTypes) {
+            mReceivers.push_back(std::make_unique<CertReceiver>(certType, *this));
+        }
+    }
+
+    /**
+     * Returns certificate receivers, one per certificate type.
+     *
+     * @return const std::vector<std::unique_ptr<CertReceiver>>&.
+     */
+    const std::vector<std::unique_ptr<CertReceiver>>& GetReceivers() const { return mReceivers; }
+
+private:
+    std::vector<std::unique_ptr<CertReceiver>> mReceivers;
 };
 
 } // namespace aos::iam::iamserver
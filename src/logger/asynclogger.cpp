@@ -0,0 +1,319 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <syslog.h>
+
+#include <systemd/sd-journal.h>
+
+#include "asynclogger.hpp"
+
+namespace aos::iam::logger {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+void CopyString(char* dst, size_t dstSize, const String& src)
+{
+    auto size = std::min(src.Size(), dstSize - 1);
+
+    memcpy(dst, src.CStr(), size);
+    dst[size] = '\0';
+}
+
+const char* LevelToString(LogLevel level)
+{
+    switch (level.GetValue()) {
+    case LogLevelEnum::eDebug:
+        return "DBG";
+
+    case LogLevelEnum::eInfo:
+        return "INF";
+
+    case LogLevelEnum::eWarning:
+        return "WRN";
+
+    case LogLevelEnum::eError:
+        return "ERR";
+
+    default:
+        return "???";
+    }
+}
+
+int LevelToPriority(LogLevel level)
+{
+    switch (level.GetValue()) {
+    case LogLevelEnum::eDebug:
+        return LOG_DEBUG;
+
+    case LogLevelEnum::eInfo:
+        return LOG_INFO;
+
+    case LogLevelEnum::eWarning:
+        return LOG_WARNING;
+
+    case LogLevelEnum::eError:
+        return LOG_ERR;
+
+    default:
+        return LOG_NOTICE;
+    }
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+std::atomic<AsyncLogger*> AsyncLogger::sInstance {nullptr};
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+AsyncLogger::~AsyncLogger()
+{
+    Stop();
+
+    auto instance = this;
+
+    sInstance.compare_exchange_strong(instance, nullptr);
+}
+
+Error AsyncLogger::Init(Backend backend, LogLevel level)
+{
+    return Init(backend == Backend::eJournald ? Sink(WriteJournald) : Sink(WriteStdIO), level);
+}
+
+Error AsyncLogger::Init(Sink sink, LogLevel level)
+{
+    if (!sink) {
+        return AOS_ERROR_WRAP(ErrorEnum::eInvalidArgument);
+    }
+
+    mSink  = std::move(sink);
+    mLevel = level;
+    mQueue = std::make_unique<std::array<Entry, cQueueSize>>();
+
+    for (size_t i = 0; i < cQueueSize; i++) {
+        (*mQueue)[i].mSequence.store(i, std::memory_order_relaxed);
+    }
+
+    mEnqueuePos.store(0, std::memory_order_relaxed);
+    mDequeuePos = 0;
+
+    return ErrorEnum::eNone;
+}
+
+Error AsyncLogger::Start()
+{
+    if (!mQueue) {
+        return AOS_ERROR_WRAP(ErrorEnum::eWrongState);
+    }
+
+    if (mRunning.exchange(true)) {
+        return AOS_ERROR_WRAP(ErrorEnum::eWrongState);
+    }
+
+    mThread = std::thread(&AsyncLogger::Run, this);
+
+    sInstance.store(this, std::memory_order_release);
+    Log::SetCallback(LogCallback);
+
+    return ErrorEnum::eNone;
+}
+
+Error AsyncLogger::Stop()
+{
+    {
+        std::lock_guard lock {mMutex};
+
+        if (!mRunning.exchange(false)) {
+            return ErrorEnum::eNone;
+        }
+
+        mCondVar.notify_one();
+    }
+
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+
+    // wait for producers which have seen the logger running, then write their messages
+    while (mProducerCount.load() != 0) {
+        std::this_thread::yield();
+    }
+
+    // synchronous writes after stop hold the mutex as well
+    std::lock_guard lock {mMutex};
+
+    while (Pop()) { }
+
+    ReportDropped();
+
+    return ErrorEnum::eNone;
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+void AsyncLogger::LogCallback(const String& module, LogLevel level, const String& message)
+{
+    auto instance = sInstance.load(std::memory_order_acquire);
+    if (!instance || level.GetValue() < instance->mLevel.GetValue()) {
+        return;
+    }
+
+    // producer count and running flag are seq_cst: either Stop sees this producer or the producer sees it stopped
+    instance->mProducerCount.fetch_add(1);
+
+    if (instance->mRunning.load()) {
+        if (!instance->Push(module, level, message)) {
+            instance->mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        instance->mProducerCount.fetch_sub(1, std::memory_order_release);
+
+        return;
+    }
+
+    instance->mProducerCount.fetch_sub(1, std::memory_order_relaxed);
+
+    std::lock_guard lock {instance->mMutex};
+
+    instance->mSink(std::chrono::system_clock::now(), module.CStr(), level, message.CStr());
+}
+
+void AsyncLogger::WriteStdIO(
+    std::chrono::system_clock::time_point time, const char* module, LogLevel level, const char* message)
+{
+    auto    seconds = std::chrono::system_clock::to_time_t(time);
+    auto    millis  = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000;
+    std::tm tm {};
+    char    timeStr[32];
+
+    localtime_r(&seconds, &tm);
+    strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &tm);
+
+    printf("%s.%03d [%s] %s %s\n", timeStr, static_cast<int>(millis), module, LevelToString(level), message);
+    fflush(stdout);
+}
+
+void AsyncLogger::WriteJournald(
+    std::chrono::system_clock::time_point time, const char* module, LogLevel level, const char* message)
+{
+    (void)time;
+
+    sd_journal_send("MESSAGE=[%s] %s", module, message, "PRIORITY=%i", LevelToPriority(level), nullptr);
+}
+
+bool AsyncLogger::Push(const String& module, LogLevel level, const String& message)
+{
+    auto   pos   = mEnqueuePos.load(std::memory_order_relaxed);
+    Entry* entry = nullptr;
+
+    // bounded MPMC queue by D. Vyukov: entry sequence equal to position means the entry is free for this position
+    while (true) {
+        entry = &(*mQueue)[pos & (cQueueSize - 1)];
+
+        auto diff = static_cast<intptr_t>(entry->mSequence.load(std::memory_order_acquire))
+            - static_cast<intptr_t>(pos);
+
+        if (diff == 0) {
+            if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = mEnqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    entry->mTime  = std::chrono::system_clock::now();
+    entry->mLevel = level;
+    CopyString(entry->mModule, sizeof(entry->mModule), module);
+    CopyString(entry->mMessage, sizeof(entry->mMessage), message);
+
+    entry->mSequence.store(pos + 1);
+
+    if (mConsumerWaiting.load()) {
+        std::lock_guard lock {mMutex};
+
+        mCondVar.notify_one();
+    }
+
+    return true;
+}
+
+bool AsyncLogger::Pop()
+{
+    auto& entry = (*mQueue)[mDequeuePos & (cQueueSize - 1)];
+
+    if (entry.mSequence.load(std::memory_order_acquire) != mDequeuePos + 1) {
+        return false;
+    }
+
+    mSink(entry.mTime, entry.mModule, entry.mLevel, entry.mMessage);
+
+    entry.mSequence.store(mDequeuePos + cQueueSize, std::memory_order_release);
+    mDequeuePos++;
+
+    return true;
+}
+
+void AsyncLogger::Run()
+{
+    while (true) {
+        while (Pop()) { }
+
+        ReportDropped();
+
+        std::unique_lock lock {mMutex};
+
+        if (!mRunning.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        mConsumerWaiting.store(true);
+
+        // recheck as producer could push before seeing the waiting flag, timeout is a safety net only
+        if ((*mQueue)[mDequeuePos & (cQueueSize - 1)].mSequence.load() != mDequeuePos + 1) {
+            mCondVar.wait_for(lock, cWaitTimeout);
+        }
+
+        mConsumerWaiting.store(false);
+    }
+}
+
+void AsyncLogger::ReportDropped()
+{
+    auto dropped = mDroppedCount.load(std::memory_order_relaxed);
+
+    if (dropped == mReportedDroppedCount) {
+        return;
+    }
+
+    char message[64];
+
+    snprintf(message, sizeof(message), "Log messages dropped: count=%zu", dropped - mReportedDroppedCount);
+
+    mSink(std::chrono::system_clock::now(), "logger", LogLevelEnum::eWarning, message);
+
+    mReportedDroppedCount = dropped;
+}
+
+} // namespace aos::iam::logger
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ASYNCLOGGER_HPP_
+#define ASYNCLOGGER_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <aos/common/tools/log.hpp>
+
+namespace aos::iam::logger {
+
+/**
+ * Logger which takes formatting result from the calling thread and writes it to the sink from a background thread.
+ * Messages are passed through a bounded lock-free queue: logging never blocks and messages are dropped if the queue is
+ * full.
+ */
+class AsyncLogger {
+public:
+    /**
+     * Log backend.
+     */
+    enum class Backend {
+        eStdIO,
+        eJournald,
+    };
+
+    /**
+     * Log sink.
+     */
+    using Sink = std::function<void(
+        std::chrono::system_clock::time_point time, const char* module, LogLevel level, const char* message)>;
+
+    /**
+     * Queue size, should be power of two.
+     */
+    static constexpr size_t cQueueSize = 1024;
+
+    /**
+     * Max module name length.
+     */
+    static constexpr size_t cMaxModuleLen = 32;
+
+    /**
+     * Max message length, longer messages are truncated.
+     */
+    static constexpr size_t cMaxMessageLen = 512;
+
+    /**
+     * Destructor.
+     */
+    ~AsyncLogger();
+
+    /**
+     * Initializes logger with predefined backend.
+     *
+     * @param backend log backend.
+     * @param level log level.
+     * @return Error.
+     */
+    Error Init(Backend backend, LogLevel level);
+
+    /**
+     * Initializes logger with custom sink.
+     *
+     * @param sink log sink.
+     * @param level log level.
+     * @return Error.
+     */
+    Error Init(Sink sink, LogLevel level);
+
+    /**
+     * Starts background sink thread and redirects log to the logger.
+     *
+     * @return Error.
+     */
+    Error Start();
+
+    /**
+     * Writes queued messages and stops background sink thread. Waits for producers which have seen the logger running
+     * to finish pushing, so no queued message is lost. Messages logged after stop are written synchronously.
+     *
+     * @return Error.
+     */
+    Error Stop();
+
+    /**
+     * Returns number of messages dropped due to queue overflow.
+     *
+     * @return size_t.
+     */
+    size_t GetDroppedCount() const { return mDroppedCount.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr auto cWaitTimeout = std::chrono::milliseconds(100);
+
+    static_assert((cQueueSize & (cQueueSize - 1)) == 0, "queue size should be power of two");
+
+    struct Entry {
+        std::atomic<size_t>                   mSequence;
+        std::chrono::system_clock::time_point mTime;
+        LogLevel                              mLevel;
+        char                                  mModule[cMaxModuleLen];
+        char                                  mMessage[cMaxMessageLen];
+    };
+
+    static void LogCallback(const String& module, LogLevel level, const String& message);
+    static void WriteStdIO(
+        std::chrono::system_clock::time_point time, const char* module, LogLevel level, const char* message);
+    static void WriteJournald(
+        std::chrono::system_clock::time_point time, const char* module, LogLevel level, const char* message);
+
+    bool Push(const String& module, LogLevel level, const String& message);
+    bool Pop();
+    void Run();
+    void ReportDropped();
+
+    static std::atomic<AsyncLogger*> sInstance;
+
+    Sink                                           mSink;
+    LogLevel                                       mLevel;
+    std::unique_ptr<std::array<Entry, cQueueSize>> mQueue;
+
+    // producers and consumer positions are on separate cache lines
+    alignas(64) std::atomic<size_t> mEnqueuePos {0};
+    alignas(64) size_t              mDequeuePos {0};
+
+    std::atomic_bool        mConsumerWaiting {false};
+    std::atomic_bool        mRunning {false};
+    std::atomic<size_t>     mProducerCount {0};
+    std::atomic<size_t>     mDroppedCount {0};
+    size_t                  mReportedDroppedCount {0};
+    std::mutex              mMutex;
+    std::condition_variable mCondVar;
+    std::thread             mThread;
+};
+
+} // namespace aos::iam::logger
+
+#endif
@@ -8,6 +8,7 @@
 #ifndef LOGMODULE_HPP_
 #define LOGMODULE_HPP_
 
+#include <atomic>
 #include <sstream>
 
 #include <aos/common/tools/log.hpp>
@@ -16,8 +17,59 @@
 #define LOG_MODULE "default"
 #endif
 
-#define LOG_DBG() LOG_MODULE_DBG(LOG_MODULE)
-#define LOG_INF() LOG_MODULE_INF(LOG_MODULE)
+namespace aos::iam::logger {
+
+/**
+ * Returns minimal level of emitted messages.
+ *
+ * @return std::atomic<LogLevelEnum>&.
+ */
+inline std::atomic<LogLevelEnum>& MinLogLevel()
+{
+    static std::atomic<LogLevelEnum> sMinLogLevel {LogLevelEnum::eDebug};
+
+    return sMinLogLevel;
+}
+
+/**
+ * Sets minimal level of emitted messages. Messages of lower levels are skipped before their arguments are formatted.
+ *
+ * @param level log level.
+ */
+inline void SetLogLevel(LogLevel level)
+{
+    MinLogLevel().store(level.GetValue(), std::memory_order_relaxed);
+}
+
+/**
+ * Checks if messages of the level are emitted.
+ *
+ * @param level log level.
+ * @return bool.
+ */
+inline bool IsLogLevelEnabled(LogLevelEnum level)
+{
+    return level >= MinLogLevel().load(std::memory_order_relaxed);
+}
+
+/**
+ * Turns log stream expression into void to be used as a branch of conditional operator.
+ */
+struct LogVoidify {
+    template <typename T>
+    void operator&(const T&) const
+    {
+    }
+};
+
+} // namespace aos::iam::logger
+
+// stream arguments are evaluated only if the level is enabled
+#define LOG_IF_ENABLED(level, log)                                                                                     \
+    !::aos::iam::logger::IsLogLevelEnabled(level) ? (void)0 : ::aos::iam::logger::LogVoidify() & log
+
+#define LOG_DBG() LOG_IF_ENABLED(::aos::LogLevelEnum::eDebug, LOG_MODULE_DBG(LOG_MODULE))
+#define LOG_INF() LOG_IF_ENABLED(::aos::LogLevelEnum::eInfo, LOG_MODULE_INF(LOG_MODULE))
 #define LOG_WRN() LOG_MODULE_WRN(LOG_MODULE)
 #define LOG_ERR() LOG_MODULE_ERR(LOG_MODULE)
 
@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+
+#include <utils/exception.hpp>
+
+#include "metrics.hpp"
+
+namespace aos::iam::metrics {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+std::string EscapeLabelValue(const std::string& value)
+{
+    std::string result;
+
+    result.reserve(value.size());
+
+    for (auto c : value) {
+        switch (c) {
+        case '\\':
+            result += "\\\\";
+            break;
+
+        case '"':
+            result += "\\\"";
+            break;
+
+        case '\n':
+            result += "\\n";
+            break;
+
+        default:
+            result += c;
+            break;
+        }
+    }
+
+    return result;
+}
+
+std::string FormatLabels(const Labels& labels)
+{
+    std::string result;
+
+    for (const auto& [name, value] : labels) {
+        if (!result.empty()) {
+            result += ",";
+        }
+
+        result += name + "=\"" + EscapeLabelValue(value) + "\"";
+    }
+
+    return result;
+}
+
+std::string FormatDouble(double value)
+{
+    char buffer[32];
+
+    snprintf(buffer, sizeof(buffer), "%.9g", value);
+
+    return buffer;
+}
+
+std::string FormatSample(const std::string& name, const std::string& labels, const std::string& extraLabel = "")
+{
+    std::string all = labels;
+
+    if (!extraLabel.empty()) {
+        all += (all.empty() ? "" : ",") + extraLabel;
+    }
+
+    return all.empty() ? name : name + "{" + all + "}";
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+const std::vector<double>& DefaultLatencyBuckets()
+{
+    static const std::vector<double> sBuckets
+        = {0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30};
+
+    return sBuckets;
+}
+
+/***********************************************************************************************************************
+ * Histogram
+ **********************************************************************************************************************/
+
+Histogram::Histogram(std::vector<double> bounds)
+    : mBounds(std::move(bounds))
+    , mCounts(new std::atomic<uint64_t>[mBounds.size() + 1])
+{
+    std::sort(mBounds.begin(), mBounds.end());
+
+    for (size_t i = 0; i <= mBounds.size(); i++) {
+        mCounts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::Observe(double value)
+{
+    if (!IsEnabled()) {
+        return;
+    }
+
+    // the last counter is the +Inf bucket
+    const auto index = std::lower_bound(mBounds.begin(), mBounds.end(), value) - mBounds.begin();
+
+    mCounts[index].fetch_add(1, std::memory_order_relaxed);
+    mCount.fetch_add(1, std::memory_order_relaxed);
+
+    auto sum = mSum.load(std::memory_order_relaxed);
+
+    while (!mSum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) { }
+}
+
+Histogram::Snapshot Histogram::GetSnapshot() const
+{
+    Snapshot snapshot {mBounds, std::vector<uint64_t>(mBounds.size() + 1), 0, mSum.load(std::memory_order_relaxed)};
+    uint64_t total = 0;
+
+    for (size_t i = 0; i <= mBounds.size(); i++) {
+        total += mCounts[i].load(std::memory_order_relaxed);
+        snapshot.mCumulativeCounts[i] = total;
+    }
+
+    // use bucket total as count to keep the snapshot consistent under concurrent updates
+    snapshot.mCount = total;
+
+    return snapshot;
+}
+
+/***********************************************************************************************************************
+ * Registry
+ **********************************************************************************************************************/
+
+Counter& Registry::GetCounter(const std::string& name, const std::string& help, const Labels& labels)
+{
+    std::lock_guard lock {mMutex};
+
+    auto& metric = GetFamily(name, help, Type::eCounter).mCounters[FormatLabels(labels)];
+    if (!metric) {
+        metric = std::make_unique<Counter>();
+    }
+
+    return *metric;
+}
+
+Gauge& Registry::GetGauge(const std::string& name, const std::string& help, const Labels& labels)
+{
+    std::lock_guard lock {mMutex};
+
+    auto& metric = GetFamily(name, help, Type::eGauge).mGauges[FormatLabels(labels)];
+    if (!metric) {
+        metric = std::make_unique<Gauge>();
+    }
+
+    return *metric;
+}
+
+Histogram& Registry::GetHistogram(
+    const std::string& name, const std::string& help, const Labels& labels, const std::vector<double>& bounds)
+{
+    std::lock_guard lock {mMutex};
+
+    auto& metric = GetFamily(name, help, Type::eHistogram).mHistograms[FormatLabels(labels)];
+    if (!metric) {
+        metric = std::make_unique<Histogram>(bounds);
+    }
+
+    return *metric;
+}
+
+std::string Registry::Render() const
+{
+    std::lock_guard    lock {mMutex};
+    std::ostringstream out;
+
+    for (const auto& [name, family] : mFamilies) {
+        out << "# HELP " << name << " " << family.mHelp << "\n";
+
+        switch (family.mType) {
+        case Type::eCounter:
+            out << "# TYPE " << name << " counter\n";
+
+            for (const auto& [labels, counter] : family.mCounters) {
+                out << FormatSample(name, labels) << " " << counter->Get() << "\n";
+            }
+
+            break;
+
+        case Type::eGauge:
+            out << "# TYPE " << name << " gauge\n";
+
+            for (const auto& [labels, gauge] : family.mGauges) {
+                out << FormatSample(name, labels) << " " << gauge->Get() << "\n";
+            }
+
+            break;
+
+        case Type::eHistogram:
+            out << "# TYPE " << name << " histogram\n";
+
+            for (const auto& [labels, histogram] : family.mHistograms) {
+                const auto snapshot = histogram->GetSnapshot();
+
+                for (size_t i = 0; i < snapshot.mBounds.size(); i++) {
+                    out << FormatSample(name + "_bucket", labels, "le=\"" + FormatDouble(snapshot.mBounds[i]) + "\"")
+                        << " " << snapshot.mCumulativeCounts[i] << "\n";
+                }
+
+                out << FormatSample(name + "_bucket", labels, "le=\"+Inf\"") << " " << snapshot.mCount << "\n";
+                out << FormatSample(name + "_sum", labels) << " " << FormatDouble(snapshot.mSum) << "\n";
+                out << FormatSample(name + "_count", labels) << " " << snapshot.mCount << "\n";
+            }
+
+            break;
+        }
+    }
+
+    return out.str();
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+Registry::Family& Registry::GetFamily(const std::string& name, const std::string& help, Type type)
+{
+    auto [it, inserted] = mFamilies.try_emplace(name);
+
+    if (inserted) {
+        it->second.mType = type;
+        it->second.mHelp = help;
+    } else if (it->second.mType != type) {
+        AOS_ERROR_THROW(ErrorEnum::eInvalidArgument, "metric type mismatch");
+    }
+
+    return it->second;
+}
+
+/***********************************************************************************************************************
+ * Registry instance
+ **********************************************************************************************************************/
+
+Registry& GetRegistry()
+{
+    static Registry sRegistry;
+
+    return sRegistry;
+}
+
+} // namespace aos::iam::metrics
@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef METRICS_HPP_
+#define METRICS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace aos::iam::metrics {
+
+/**
+ * Metric labels.
+ */
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * Default latency histogram buckets, seconds.
+ */
+const std::vector<double>& DefaultLatencyBuckets();
+
+/**
+ * Returns metrics collection enabled flag.
+ *
+ * @return std::atomic_bool&.
+ */
+inline std::atomic_bool& EnabledFlag()
+{
+    static std::atomic_bool sEnabled {false};
+
+    return sEnabled;
+}
+
+/**
+ * Enables or disables metrics collection. Metrics updates are skipped while disabled.
+ *
+ * @param enabled enabled flag.
+ */
+inline void SetEnabled(bool enabled)
+{
+    EnabledFlag().store(enabled, std::memory_order_relaxed);
+}
+
+/**
+ * Checks if metrics collection is enabled.
+ *
+ * @return bool.
+ */
+inline bool IsEnabled()
+{
+    return EnabledFlag().load(std::memory_order_relaxed);
+}
+
+/**
+ * Monotonically increasing counter.
+ */
+class Counter {
+public:
+    /**
+     * Increments counter.
+     *
+     * @param value increment value.
+     */
+    void Inc(uint64_t value = 1)
+    {
+        if (IsEnabled()) {
+            mValue.fetch_add(value, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Returns counter value.
+     *
+     * @return uint64_t.
+     */
+    uint64_t Get() const { return mValue.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> mValue {0};
+};
+
+/**
+ * Gauge.
+ */
+class Gauge {
+public:
+    /**
+     * Sets gauge value.
+     *
+     * @param value value.
+     */
+    void Set(int64_t value)
+    {
+        if (IsEnabled()) {
+            mValue.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Increments gauge.
+     *
+     * @param value increment value.
+     */
+    void Inc(int64_t value = 1)
+    {
+        if (IsEnabled()) {
+            mValue.fetch_add(value, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Decrements gauge.
+     *
+     * @param value decrement value.
+     */
+    void Dec(int64_t value = 1)
+    {
+        if (IsEnabled()) {
+            mValue.fetch_sub(value, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Returns gauge value.
+     *
+     * @return int64_t.
+     */
+    int64_t Get() const { return mValue.load(std::memory_order_relaxed); }
+
+private:
+    friend class ScopedGauge;
+
+    std::atomic<int64_t> mValue {0};
+};
+
+/**
+ * Histogram with fixed buckets.
+ */
+class Histogram {
+public:
+    /**
+     * Histogram snapshot.
+     */
+    struct Snapshot {
+        std::vector<double>   mBounds;
+        std::vector<uint64_t> mCumulativeCounts;
+        uint64_t              mCount;
+        double                mSum;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param bounds bucket upper bounds in ascending order.
+     */
+    explicit Histogram(std::vector<double> bounds);
+
+    /**
+     * Observes value.
+     *
+     * @param value value.
+     */
+    void Observe(double value);
+
+    /**
+     * Returns histogram snapshot.
+     *
+     * @return Snapshot.
+     */
+    Snapshot GetSnapshot() const;
+
+private:
+    std::vector<double>                      mBounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> mCounts;
+    std::atomic<uint64_t>                    mCount {0};
+    std::atomic<double>                      mSum {0};
+};
+
+/**
+ * Observes scope duration in seconds to the histogram. Clock is not read while metrics are disabled.
+ */
+class ScopedTimer {
+public:
+    /**
+     * Constructor.
+     *
+     * @param histogram histogram.
+     */
+    explicit ScopedTimer(Histogram& histogram)
+        : mHistogram(histogram)
+        , mEnabled(IsEnabled())
+    {
+        if (mEnabled) {
+            mStart = std::chrono::steady_clock::now();
+        }
+    }
+
+    /**
+     * Destructor.
+     */
+    ~ScopedTimer()
+    {
+        if (mEnabled) {
+            mHistogram.Observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count());
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&)            = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram&                            mHistogram;
+    bool                                  mEnabled;
+    std::chrono::steady_clock::time_point mStart;
+};
+
+/**
+ * Increments gauge for the scope lifetime. Enabled state is taken at construction, so the gauge stays balanced if
+ * metrics are enabled or disabled within the scope.
+ */
+class ScopedGauge {
+public:
+    /**
+     * Constructor.
+     *
+     * @param gauge gauge.
+     */
+    explicit ScopedGauge(Gauge& gauge)
+        : mGauge(gauge)
+        , mEnabled(IsEnabled())
+    {
+        if (mEnabled) {
+            mGauge.mValue.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Destructor.
+     */
+    ~ScopedGauge()
+    {
+        if (mEnabled) {
+            mGauge.mValue.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    ScopedGauge(const ScopedGauge&)            = delete;
+    ScopedGauge& operator=(const ScopedGauge&) = delete;
+
+private:
+    Gauge& mGauge;
+    bool   mEnabled;
+};
+
+/**
+ * Metrics registry. Metrics are created on first request and live until the registry is destroyed, so references to
+ * them may be cached by callers.
+ */
+class Registry {
+public:
+    /**
+     * Returns counter.
+     *
+     * @param name metric name.
+     * @param help metric description.
+     * @param labels metric labels.
+     * @return Counter&.
+     */
+    Counter& GetCounter(const std::string& name, const std::string& help, const Labels& labels = {});
+
+    /**
+     * Returns gauge.
+     *
+     * @param name metric name.
+     * @param help metric description.
+     * @param labels metric labels.
+     * @return Gauge&.
+     */
+    Gauge& GetGauge(const std::string& name, const std::string& help, const Labels& labels = {});
+
+    /**
+     * Returns histogram.
+     *
+     * @param name metric name.
+     * @param help metric description.
+     * @param labels metric labels.
+     * @param bounds bucket upper bounds, used on creation only.
+     * @return Histogram&.
+     */
+    Histogram& GetHistogram(const std::string& name, const std::string& help, const Labels& labels = {},
+        const std::vector<double>& bounds = DefaultLatencyBuckets());
+
+    /**
+     * Renders all metrics in Prometheus text exposition format.
+     *
+     * @return std::string.
+     */
+    std::string Render() const;
+
+private:
+    enum class Type {
+        eCounter,
+        eGauge,
+        eHistogram,
+    };
+
+    struct Family {
+        Type                                              mType;
+        std::string                                       mHelp;
+        std::map<std::string, std::unique_ptr<Counter>>   mCounters;
+        std::map<std::string, std::unique_ptr<Gauge>>     mGauges;
+        std::map<std::string, std::unique_ptr<Histogram>> mHistograms;
+    };
+
+    Family& GetFamily(const std::string& name, const std::string& help, Type type);
+
+    mutable std::mutex            mMutex;
+    std::map<std::string, Family> mFamilies;
+};
+
+/**
+ * Returns process wide metrics registry.
+ *
+ * @return Registry&.
+ */
+Registry& GetRegistry();
+
+} // namespace aos::iam::metrics
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <Poco/Net/HTTPRequestHandler.h>
+#include <Poco/Net/HTTPRequestHandlerFactory.h>
+#include <Poco/Net/HTTPServerParams.h>
+#include <Poco/Net/HTTPServerRequest.h>
+#include <Poco/Net/HTTPServerResponse.h>
+#include <Poco/Net/ServerSocket.h>
+
+#include <utils/exception.hpp>
+
+#include "logger/logmodule.hpp"
+#include "metricsserver.hpp"
+
+namespace aos::iam::metrics {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+constexpr auto cContentType = "text/plain; version=0.0.4; charset=utf-8";
+
+/***********************************************************************************************************************
+ * Types
+ **********************************************************************************************************************/
+
+class MetricsRequestHandler : public Poco::Net::HTTPRequestHandler {
+public:
+    explicit MetricsRequestHandler(const Registry& registry)
+        : mRegistry(registry)
+    {
+    }
+
+    void handleRequest(Poco::Net::HTTPServerRequest& request, Poco::Net::HTTPServerResponse& response) override
+    {
+        if (request.getMethod() != Poco::Net::HTTPRequest::HTTP_GET) {
+            response.setStatusAndReason(Poco::Net::HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
+            response.send();
+
+            return;
+        }
+
+        if (request.getURI() != MetricsServer::cMetricsPath) {
+            response.setStatusAndReason(Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
+            response.send();
+
+            return;
+        }
+
+        const auto body = mRegistry.Render();
+
+        response.setContentType(cContentType);
+        response.sendBuffer(body.data(), body.size());
+    }
+
+private:
+    const Registry& mRegistry;
+};
+
+class MetricsRequestHandlerFactory : public Poco::Net::HTTPRequestHandlerFactory {
+public:
+    explicit MetricsRequestHandlerFactory(const Registry& registry)
+        : mRegistry(registry)
+    {
+    }
+
+    Poco::Net::HTTPRequestHandler* createRequestHandler(const Poco::Net::HTTPServerRequest& request) override
+    {
+        (void)request;
+
+        return new MetricsRequestHandler(mRegistry);
+    }
+
+private:
+    const Registry& mRegistry;
+};
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+Error MetricsServer::Start(const std::string& url, const Registry& registry)
+{
+    LOG_DBG() << "Start metrics server: url=" << url.c_str();
+
+    if (mServer) {
+        return AOS_ERROR_WRAP(ErrorEnum::eWrongState);
+    }
+
+    try {
+        Poco::Net::ServerSocket socket(Poco::Net::SocketAddress(url));
+        auto                    params = new Poco::Net::HTTPServerParams();
+
+        params->setMaxThreads(cMaxThreads);
+
+        mServer = std::make_unique<Poco::Net::HTTPServer>(
+            new MetricsRequestHandlerFactory(registry), socket, Poco::Net::HTTPServerParams::Ptr(params));
+
+        mServer->start();
+    } catch (const std::exception& e) {
+        mServer.reset();
+
+        return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+    }
+
+    SetEnabled(true);
+
+    return ErrorEnum::eNone;
+}
+
+Error MetricsServer::Stop()
+{
+    if (!mServer) {
+        return ErrorEnum::eNone;
+    }
+
+    LOG_DBG() << "Stop metrics server";
+
+    SetEnabled(false);
+
+    try {
+        mServer->stopAll(true);
+        mServer.reset();
+    } catch (const std::exception& e) {
+        return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+    }
+
+    return ErrorEnum::eNone;
+}
+
+uint16_t MetricsServer::GetPort() const
+{
+    return mServer ? mServer->port() : 0;
+}
+
+} // namespace aos::iam::metrics
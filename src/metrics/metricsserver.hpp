@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef METRICSSERVER_HPP_
+#define METRICSSERVER_HPP_
+
+#include <memory>
+#include <string>
+
+#include <Poco/Net/HTTPServer.h>
+
+#include <aos/common/tools/error.hpp>
+
+#include "metrics.hpp"
+
+namespace aos::iam::metrics {
+
+/**
+ * HTTP server exposing metrics registry in Prometheus text format on /metrics.
+ */
+class MetricsServer {
+public:
+    /**
+     * Metrics path.
+     */
+    static constexpr auto cMetricsPath = "/metrics";
+
+    /**
+     * Starts server and enables metrics collection.
+     *
+     * @param url server address in host:port format.
+     * @param registry metrics registry.
+     * @return Error.
+     */
+    Error Start(const std::string& url, const Registry& registry = GetRegistry());
+
+    /**
+     * Stops server.
+     *
+     * @return Error.
+     */
+    Error Stop();
+
+    /**
+     * Returns server port, useful if started on port 0.
+     *
+     * @return uint16_t.
+     */
+    uint16_t GetPort() const;
+
+private:
+    static constexpr auto cMaxThreads = 1;
+
+    std::unique_ptr<Poco::Net::HTTPServer> mServer;
+};
+
+} // namespace aos::iam::metrics
+
+#endif
@@ -5,8 +5,12 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
+#include <memory>
 #include <sys/utsname.h>
 
 #include <utils/exception.hpp>
@@ -19,6 +23,17 @@ namespace aos::iam::nodeinfoprovider {
 
 namespace {
 
+/***********************************************************************************************************************
+ * Constants
+ **********************************************************************************************************************/
+
+constexpr auto cUsedRAMAttribute       = "UsedRAM";
+constexpr auto cCPULoadAttribute       = "CPULoad";
+constexpr auto cEffectiveCPUsAttribute = "EffectiveCPUs";
+constexpr auto cEffectiveRAMAttribute  = "EffectiveRAM";
+constexpr auto cMaxCPUsLen             = 32;
+constexpr auto cMaxProbeRetries        = 3;
+
 /***********************************************************************************************************************
  * Static
  **********************************************************************************************************************/
@@ -71,6 +86,17 @@ Error GetNodeID(const std::string& path, String& nodeID)
     return ErrorEnum::eNone;
 }
 
+Error ApplyPartitionProbe(PartitionInfo& partitionInfo, const RetWithError<utils::FSUsage>& result)
+{
+    if (!result.mError.IsNone()) {
+        return result.mError;
+    }
+
+    partitionInfo.mTotalSize = result.mValue.mTotalSize;
+
+    return ErrorEnum::eNone;
+}
+
 } // namespace
 
 /***********************************************************************************************************************
@@ -107,6 +133,10 @@ Error NodeInfoProvider::Init(const iam::config::NodeInfoConfig& config)
         return AOS_ERROR_WRAP(err);
     }
 
+    if (err = InitEffectiveCapacity(config); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
     if (err = InitPartitionInfo(config); !err.IsNone()) {
         return AOS_ERROR_WRAP(err);
     }
@@ -116,6 +146,54 @@ Error NodeInfoProvider::Init(const iam::config::NodeInfoConfig& config)
         return AOS_ERROR_WRAP(err);
     }
 
+    if (err = mResourceSampler.Init(config); !err.IsNone()) {
+        LOG_WRN() << "Failed to sample node resources: err=" << err;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error NodeInfoProvider::Start()
+{
+    // attributes are sampled in background, so observers get node info on each sample
+    if (auto err = mResourceSampler.Start([this]() { NotifyNodeInfoUpdated(); }); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    std::lock_guard lock {mMutex};
+
+    if (mPendingPartitionProbes.empty() || mProbeThread.joinable()) {
+        return ErrorEnum::eNone;
+    }
+
+    mStopProbes = false;
+
+    try {
+        mProbeThread = std::thread(&NodeInfoProvider::RunPartitionProbes, this);
+    } catch (const std::exception& e) {
+        return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error NodeInfoProvider::Stop()
+{
+    {
+        std::lock_guard lock {mMutex};
+
+        mStopProbes = true;
+        mProbeCondVar.notify_all();
+    }
+
+    if (mProbeThread.joinable()) {
+        mProbeThread.join();
+    }
+
+    if (auto err = mResourceSampler.Stop(); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
     return ErrorEnum::eNone;
 }
 
@@ -134,6 +212,8 @@ Error NodeInfoProvider::GetNodeInfo(NodeInfo& nodeInfo) const
     nodeInfo         = mNodeInfo;
     nodeInfo.mStatus = status;
 
+    AddResourceUsageAttributes(nodeInfo);
+
     return ErrorEnum::eNone;
 }
 
@@ -198,6 +278,41 @@ Error NodeInfoProvider::UnsubscribeNodeStatusChanged(iam::nodeinfoprovider::Node
     return ErrorEnum::eNone;
 }
 
+Error NodeInfoProvider::SubscribeNodeInfoUpdated(NodeInfoObserverItf& observer)
+{
+    std::lock_guard lock {mMutex};
+
+    LOG_DBG() << "Subscribe node info updated observer";
+
+    try {
+        mNodeInfoObservers.insert(&observer);
+    } catch (const std::exception& e) {
+        return common::utils::ToAosError(e);
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error NodeInfoProvider::UnsubscribeNodeInfoUpdated(NodeInfoObserverItf& observer)
+{
+    std::lock_guard lock {mMutex};
+
+    LOG_DBG() << "Unsubscribe node info updated observer";
+
+    mNodeInfoObservers.erase(&observer);
+
+    return ErrorEnum::eNone;
+}
+
+Error NodeInfoProvider::GetResourceUsage(ResourceUsage& usage) const
+{
+    if (!mResourceSampler.IsEnabled()) {
+        return AOS_ERROR_WRAP(Error(ErrorEnum::eNotSupported, "resource sampling is disabled"));
+    }
+
+    return mResourceSampler.GetResourceUsage(usage);
+}
+
 /***********************************************************************************************************************
  * Private
  **********************************************************************************************************************/
@@ -222,19 +337,107 @@ Error NodeInfoProvider::InitAtrributesInfo(const iam::config::NodeInfoConfig& co
     return ErrorEnum::eNone;
 }
 
+Error NodeInfoProvider::InitEffectiveCapacity(const iam::config::NodeInfoConfig& config)
+{
+    auto [limits, err] = utils::GetCGroupLimits(config.mProcCGroupPath, config.mCGroupRootPath);
+    if (!err.IsNone()) {
+        // no cgroup v2 hierarchy: raw capacity is the effective one
+        LOG_DBG() << "Can't get cgroup limits: err=" << err;
+
+        return ErrorEnum::eNone;
+    }
+
+    double   cpus = 0.0;
+    uint64_t ram  = mNodeInfo.mTotalRAM;
+
+    for (const auto& cpuInfo : mNodeInfo.mCPUs) {
+        cpus += cpuInfo.mNumThreads;
+    }
+
+    if (limits.mNumCPUs != 0) {
+        cpus = std::min(cpus, static_cast<double>(limits.mNumCPUs));
+    }
+
+    if (limits.mCPUQuota > 0.0) {
+        cpus = std::min(cpus, limits.mCPUQuota);
+    }
+
+    if (limits.mMemLimit != 0) {
+        ram = std::min(ram, limits.mMemLimit);
+    }
+
+    LOG_DBG() << "Effective capacity: cpus=" << cpus << ", ram=" << ram;
+
+    char cpusStr[cMaxCPUsLen];
+
+    snprintf(cpusStr, sizeof(cpusStr), "%.2f", cpus);
+
+    const std::pair<const char*, std::string> attributes[] = {
+        {cEffectiveCPUsAttribute, cpusStr},
+        {cEffectiveRAMAttribute, std::to_string(ram)},
+    };
+
+    // effective capacity is informational, so node info without it is still valid
+    for (const auto& [name, value] : attributes) {
+        if (err = mNodeInfo.mAttrs.PushBack(NodeAttribute {name, value.c_str()}); !err.IsNone()) {
+            LOG_WRN() << "Can't add effective capacity attribute: name=" << name << ", err=" << err;
+
+            break;
+        }
+    }
+
+    return ErrorEnum::eNone;
+}
+
 Error NodeInfoProvider::InitPartitionInfo(const iam::config::NodeInfoConfig& config)
 {
-    for (const auto& partition : config.mPartitions) {
+    std::vector<utils::FSUsageFuture> probes;
+
+    try {
+        // probe all partitions concurrently, so startup is bounded by the slowest healthy mount
+        for (const auto& partition : config.mPartitions) {
+            probes.push_back(utils::ProbeMountFSUsage(partition.mPath));
+        }
+    } catch (const std::exception& e) {
+        return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+    }
+
+    mPartitionProbeTimeout = config.mPartitionProbeTimeout.Nanoseconds() > 0
+        ? std::chrono::nanoseconds(config.mPartitionProbeTimeout.Nanoseconds())
+        : utils::cDefaultProbeTimeout;
+
+    const auto deadline = std::chrono::steady_clock::now() + mPartitionProbeTimeout;
+
+    for (size_t i = 0; i < config.mPartitions.size(); i++) {
+        const auto&   partition     = config.mPartitions[i];
         PartitionInfo partitionInfo = {};
 
         partitionInfo.mName = partition.mName.c_str();
         partitionInfo.mPath = partition.mPath.c_str();
 
         Error err;
+        bool  pending = true;
+
+        if (probes[i].wait_until(deadline) == std::future_status::ready) {
+            if (err = ApplyPartitionProbe(partitionInfo, probes[i].get()); err.IsNone()) {
+                pending = false;
+            } else {
+                LOG_WRN() << "Failed to get total size for partition: path=" << partition.mPath.c_str()
+                          << ", err=" << err;
 
-        Tie(partitionInfo.mTotalSize, err) = utils::GetMountFSTotalSize(partition.mPath);
-        if (!err.IsNone()) {
-            LOG_WRN() << "Failed to get total size for partition: path=" << partition.mPath.c_str() << ", err=" << err;
+                // failed probe is restarted in background
+                probes[i] = {};
+            }
+        } else {
+            LOG_WRN() << "Partition probe timed out, size is unknown: path=" << partition.mPath.c_str();
+        }
+
+        if (pending) {
+            try {
+                mPendingPartitionProbes.push_back({i, probes[i]});
+            } catch (const std::exception& e) {
+                return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+            }
         }
 
         for (const auto& type : partition.mTypes) {
@@ -251,6 +454,107 @@ Error NodeInfoProvider::InitPartitionInfo(const iam::config::NodeInfoConfig& con
     return ErrorEnum::eNone;
 }
 
+void NodeInfoProvider::RunPartitionProbes()
+{
+    while (true) {
+        bool updated = false, done = false;
+
+        {
+            std::unique_lock lock {mMutex};
+
+            mProbeCondVar.wait_for(lock, mPartitionProbeTimeout, [this]() { return mStopProbes; });
+            if (mStopProbes) {
+                return;
+            }
+
+            updated = ApplyPendingPartitionProbes();
+            done    = mPendingPartitionProbes.empty();
+        }
+
+        // late partition size is reported the same way as sampled resource usage
+        if (updated) {
+            NotifyNodeInfoUpdated();
+        }
+
+        if (done) {
+            return;
+        }
+    }
+}
+
+bool NodeInfoProvider::ApplyPendingPartitionProbes()
+{
+    bool updated = false;
+
+    for (auto it = mPendingPartitionProbes.begin(); it != mPendingPartitionProbes.end();) {
+        auto& partitionInfo = mNodeInfo.mPartitions[it->mIndex];
+
+        if (it->mProbe.valid() && it->mProbe.wait_for(std::chrono::seconds::zero()) == std::future_status::ready) {
+            auto err = ApplyPartitionProbe(partitionInfo, it->mProbe.get());
+            if (err.IsNone()) {
+                LOG_DBG() << "Partition size updated: path=" << partitionInfo.mPath
+                          << ", size=" << partitionInfo.mTotalSize;
+
+                updated = true;
+                it      = mPendingPartitionProbes.erase(it);
+
+                continue;
+            }
+
+            LOG_DBG() << "Partition probe failed: path=" << partitionInfo.mPath << ", err=" << err;
+
+            it->mProbe = {};
+        }
+
+        if (it->mRetries >= cMaxProbeRetries) {
+            LOG_WRN() << "Partition size is unknown, stop probing: path=" << partitionInfo.mPath;
+
+            it = mPendingPartitionProbes.erase(it);
+
+            continue;
+        }
+
+        it->mRetries++;
+
+        // hung probe keeps waiting on its own thread, only failed probe is restarted
+        if (!it->mProbe.valid()) {
+            it->mProbe = utils::ProbeMountFSUsage(partitionInfo.mPath.CStr());
+        }
+
+        it++;
+    }
+
+    return updated;
+}
+
+void NodeInfoProvider::AddResourceUsageAttributes(NodeInfo& nodeInfo) const
+{
+    if (!mResourceSampler.IsEnabled()) {
+        return;
+    }
+
+    ResourceUsage usage;
+
+    if (auto err = mResourceSampler.GetResourceUsage(usage); !err.IsNone()) {
+        LOG_WRN() << "Failed to get resource usage: err=" << err;
+
+        return;
+    }
+
+    const std::pair<const char*, std::string> attributes[] = {
+        {cUsedRAMAttribute, std::to_string(usage.mUsedRAM)},
+        {cCPULoadAttribute, std::to_string(static_cast<uint32_t>(usage.mCPULoad + 0.5))},
+    };
+
+    for (const auto& [name, value] : attributes) {
+        if (auto err = nodeInfo.mAttrs.PushBack(NodeAttribute {name, value.c_str()}); !err.IsNone()) {
+            LOG_WRN() << "Can't add resource usage attribute: name=" << name << ", err=" << err;
+
+            return;
+        }
+    }
+}
+
 Error NodeInfoProvider::NotifyNodeStatusChanged()
 {
     Error err;
@@ -268,4 +572,32 @@ Error NodeInfoProvider::NotifyNodeStatusChanged()
     return err;
 }
 
+void NodeInfoProvider::NotifyNodeInfoUpdated()
+{
+    auto nodeInfo = std::make_unique<NodeInfo>();
+
+    if (auto err = GetNodeInfo(*nodeInfo); !err.IsNone()) {
+        LOG_ERR() << "Can't get node info: err=" << err;
+
+        return;
+    }
+
+    std::vector<NodeInfoObserverItf*> observers;
+
+    try {
+        std::lock_guard lock {mMutex};
+
+        observers.assign(mNodeInfoObservers.begin(), mNodeInfoObservers.end());
+    } catch (const std::exception& e) {
+        LOG_ERR() << "Can't notify node info observers: err=" << common::utils::ToAosError(e);
+
+        return;
+    }
+
+    // observers are notified without lock, so they may request node info
+    for (auto observer : observers) {
+        observer->OnNodeInfoUpdated(*nodeInfo);
+    }
+}
+
 } // namespace aos::iam::nodeinfoprovider
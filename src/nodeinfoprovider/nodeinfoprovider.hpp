@@ -8,16 +8,39 @@
 #ifndef NODEINFOPROVIDER_HPP_
 #define NODEINFOPROVIDER_HPP_
 
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
 #include <aos/iam/nodeinfoprovider.hpp>
 
 #include "config/config.hpp"
+#include "resourcesampler.hpp"
 
 namespace aos::iam::nodeinfoprovider {
 
+/**
+ * Node info observer interface.
+ */
+class NodeInfoObserverItf {
+public:
+    /**
+     * Destructor.
+     */
+    virtual ~NodeInfoObserverItf() = default;
+
+    /**
+     * Called when sampled node resource usage is updated.
+     *
+     * @param info node info.
+     */
+    virtual void OnNodeInfoUpdated(const NodeInfo& info) = 0;
+};
+
 /**
  * Node info provider.
  */
@@ -31,6 +54,20 @@ public:
      */
     Error Init(const iam::config::NodeInfoConfig& config);
 
+    /**
+     * Starts node info provider.
+     *
+     * @return Error
+     */
+    Error Start();
+
+    /**
+     * Stops node info provider.
+     *
+     * @return Error
+     */
+    Error Stop();
+
     /**
      * Gets the node info object.
      *
@@ -63,17 +100,59 @@ public:
      */
     Error UnsubscribeNodeStatusChanged(iam::nodeinfoprovider::NodeStatusObserverItf& observer) override;
 
+    /**
+     * Subscribes on node info updated event.
+     *
+     * @param observer node info observer
+     * @return Error
+     */
+    Error SubscribeNodeInfoUpdated(NodeInfoObserverItf& observer);
+
+    /**
+     * Unsubscribes from node info updated event.
+     *
+     * @param observer node info observer
+     * @return Error
+     */
+    Error UnsubscribeNodeInfoUpdated(NodeInfoObserverItf& observer);
+
+    /**
+     * Gets last sampled node resource usage.
+     *
+     * @param[out] usage resource usage
+     * @return Error
+     */
+    Error GetResourceUsage(ResourceUsage& usage) const;
+
 private:
     Error InitOSType(const iam::config::NodeInfoConfig& config);
     Error InitAtrributesInfo(const iam::config::NodeInfoConfig& config);
+    Error InitEffectiveCapacity(const iam::config::NodeInfoConfig& config);
     Error InitPartitionInfo(const iam::config::NodeInfoConfig& config);
     Error NotifyNodeStatusChanged();
+    void  NotifyNodeInfoUpdated();
+    void  RunPartitionProbes();
+    bool  ApplyPendingPartitionProbes();
+    void  AddResourceUsageAttributes(NodeInfo& nodeInfo) const;
+
+    struct PartitionProbe {
+        size_t               mIndex   = 0;
+        utils::FSUsageFuture mProbe   = {};
+        size_t               mRetries = 0;
+    };
 
     mutable std::mutex                                                mMutex;
     std::unordered_set<iam::nodeinfoprovider::NodeStatusObserverItf*> mObservers;
+    std::unordered_set<NodeInfoObserverItf*>                          mNodeInfoObservers;
     std::string                                                       mMemInfoPath;
     std::string                                                       mProvisioningStatusPath;
     NodeInfo                                                          mNodeInfo;
+    std::vector<PartitionProbe>                                       mPendingPartitionProbes;
+    std::chrono::nanoseconds                                          mPartitionProbeTimeout {};
+    std::thread                                                       mProbeThread;
+    std::condition_variable                                           mProbeCondVar;
+    bool                                                              mStopProbes = false;
+    ResourceSampler                                                   mResourceSampler;
 };
 
 } // namespace aos::iam::nodeinfoprovider
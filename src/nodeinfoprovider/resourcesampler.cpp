@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+
+#include <utils/exception.hpp>
+
+#include "logger/logmodule.hpp"
+#include "resourcesampler.hpp"
+
+namespace aos::iam::nodeinfoprovider {
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+ResourceSampler::~ResourceSampler()
+{
+    Stop();
+}
+
+Error ResourceSampler::Init(const iam::config::NodeInfoConfig& config)
+{
+    LOG_DBG() << "Init resource sampler: interval=" << config.mResourceSampler.mInterval.Nanoseconds() << "ns";
+
+    try {
+        mConfig                = config.mResourceSampler;
+        mPartitionProbeTimeout = config.mPartitionProbeTimeout.Nanoseconds() > 0
+            ? std::chrono::nanoseconds(config.mPartitionProbeTimeout.Nanoseconds())
+            : utils::cDefaultProbeTimeout;
+        mMemInfoPath           = config.mMemInfoPath;
+        mStatPath              = config.mStatPath;
+        mPartitions            = config.mPartitions;
+
+        mSample.mPartitions.reserve(mPartitions.size());
+        mPartitionProbes.resize(mPartitions.size());
+    } catch (const std::exception& e) {
+        return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+    }
+
+    if (!IsEnabled()) {
+        return ErrorEnum::eNone;
+    }
+
+    if (auto err = Sample(); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error ResourceSampler::Start(const SampleHandler& onSample)
+{
+    std::lock_guard lock {mMutex};
+
+    if (!IsEnabled() || !mStop) {
+        return ErrorEnum::eNone;
+    }
+
+    LOG_DBG() << "Start resource sampler";
+
+    mStop = false;
+
+    try {
+        mOnSample = onSample;
+        mThread = std::thread(&ResourceSampler::Run, this);
+    } catch (const std::exception& e) {
+        mStop = true;
+
+        return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error ResourceSampler::Stop()
+{
+    {
+        std::lock_guard lock {mMutex};
+
+        if (mStop) {
+            return ErrorEnum::eNone;
+        }
+
+        LOG_DBG() << "Stop resource sampler";
+
+        mStop = true;
+        mCondVar.notify_all();
+    }
+
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error ResourceSampler::Sample()
+{
+    std::lock_guard sampleLock {mSampleMutex};
+
+    Error err;
+
+    if (mConfig.mSampleRAM) {
+        if (auto errSample = SampleRAM(mSample); !errSample.IsNone() && err.IsNone()) {
+            err = errSample;
+        }
+    }
+
+    if (mConfig.mSampleCPU) {
+        if (auto errSample = SampleCPU(mSample); !errSample.IsNone() && err.IsNone()) {
+            err = errSample;
+        }
+    }
+
+    if (mConfig.mSamplePartitions) {
+        SamplePartitions(mSample);
+    }
+
+    try {
+        std::lock_guard lock {mMutex};
+
+        mUsage = mSample;
+    } catch (const std::exception& e) {
+        return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+    }
+
+    return err;
+}
+
+Error ResourceSampler::GetResourceUsage(ResourceUsage& usage) const
+{
+    std::lock_guard lock {mMutex};
+
+    try {
+        usage = mUsage;
+    } catch (const std::exception& e) {
+        return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+    }
+
+    return ErrorEnum::eNone;
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+void ResourceSampler::Run()
+{
+    LOG_DBG() << "Resource sampler thread started";
+
+    while (true) {
+        {
+            std::unique_lock lock {mMutex};
+
+            mCondVar.wait_for(
+                lock, std::chrono::nanoseconds(mConfig.mInterval.Nanoseconds()), [this]() { return mStop; });
+            if (mStop) {
+                break;
+            }
+        }
+
+        if (auto err = Sample(); !err.IsNone()) {
+            LOG_WRN() << "Failed to sample resources: err=" << err;
+        }
+
+        if (mOnSample) {
+            mOnSample();
+        }
+    }
+
+    LOG_DBG() << "Resource sampler thread stopped";
+}
+
+Error ResourceSampler::SampleRAM(ResourceUsage& usage)
+{
+    if (auto err = utils::ReadFileToBuffer(mMemInfoPath, mBuffer); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    utils::MemUsage memUsage;
+
+    if (auto err = utils::ParseMemUsage(mBuffer, memUsage); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    usage.mTotalRAM = memUsage.mTotal;
+    usage.mUsedRAM  = memUsage.mTotal > memUsage.mAvailable ? memUsage.mTotal - memUsage.mAvailable : 0;
+
+    return ErrorEnum::eNone;
+}
+
+Error ResourceSampler::SampleCPU(ResourceUsage& usage)
+{
+    if (auto err = utils::ReadFileToBuffer(mStatPath, mBuffer); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    utils::CPUTimes cpuTimes;
+
+    if (auto err = utils::ParseCPUTimes(mBuffer, cpuTimes); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    // load is calculated between two consecutive samples, the first sample reports zero load
+    if (mPrevCPUTimes.mTotal != 0 && cpuTimes.mTotal > mPrevCPUTimes.mTotal) {
+        const auto total = cpuTimes.mTotal - mPrevCPUTimes.mTotal;
+        const auto idle  = cpuTimes.mIdle > mPrevCPUTimes.mIdle ? cpuTimes.mIdle - mPrevCPUTimes.mIdle : 0;
+
+        usage.mCPULoad = idle < total ? static_cast<double>(total - idle) * 100.0 / total : 0.0;
+    }
+
+    mPrevCPUTimes = cpuTimes;
+
+    return ErrorEnum::eNone;
+}
+
+void ResourceSampler::SamplePartitions(ResourceUsage& usage)
+{
+    usage.mPartitions.resize(mPartitions.size());
+
+    // probe hung on a previous sample is not restarted, the partition keeps its last known usage
+    for (size_t i = 0; i < mPartitions.size(); i++) {
+        if (!mPartitionProbes[i].valid()
+            || mPartitionProbes[i].wait_for(std::chrono::seconds::zero()) == std::future_status::ready) {
+            mPartitionProbes[i] = utils::ProbeMountFSUsage(mPartitions[i].mPath);
+        }
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + mPartitionProbeTimeout;
+
+    for (size_t i = 0; i < mPartitions.size(); i++) {
+        auto& partitionUsage = usage.mPartitions[i];
+
+        if (partitionUsage.mName.empty()) {
+            partitionUsage.mName = mPartitions[i].mName;
+            partitionUsage.mPath = mPartitions[i].mPath;
+        }
+
+        if (mPartitionProbes[i].wait_until(deadline) != std::future_status::ready) {
+            LOG_WRN() << "Partition probe timed out: path=" << mPartitions[i].mPath.c_str();
+
+            continue;
+        }
+
+        const auto& [fsUsage, err] = mPartitionProbes[i].get();
+        if (!err.IsNone()) {
+            LOG_WRN() << "Failed to get partition usage: path=" << mPartitions[i].mPath.c_str() << ", err=" << err;
+
+            continue;
+        }
+
+        partitionUsage.mTotalSize = fsUsage.mTotalSize;
+        partitionUsage.mUsedSize  = fsUsage.mUsedSize;
+    }
+}
+
+} // namespace aos::iam::nodeinfoprovider
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef RESOURCESAMPLER_HPP_
+#define RESOURCESAMPLER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <aos/common/tools/error.hpp>
+
+#include "config/config.hpp"
+#include "systeminfo.hpp"
+
+namespace aos::iam::nodeinfoprovider {
+
+/**
+ * Partition usage.
+ */
+struct PartitionUsage {
+    std::string mName;
+    std::string mPath;
+    uint64_t    mTotalSize = 0;
+    uint64_t    mUsedSize  = 0;
+};
+
+/**
+ * Node resource usage sample.
+ */
+struct ResourceUsage {
+    uint64_t                    mTotalRAM = 0;
+    uint64_t                    mUsedRAM  = 0;
+    double                      mCPULoad  = 0.0;
+    std::vector<PartitionUsage> mPartitions;
+};
+
+/**
+ * Periodically samples node RAM, CPU and partition usage.
+ */
+class ResourceSampler {
+public:
+    using SampleHandler = std::function<void()>;
+
+    /**
+     * Destructor.
+     */
+    ~ResourceSampler();
+
+    /**
+     * Initializes resource sampler.
+     *
+     * @param config node info configuration.
+     * @return Error.
+     */
+    Error Init(const iam::config::NodeInfoConfig& config);
+
+    /**
+     * Starts periodic sampling. Does nothing if sampling interval is not set.
+     *
+     * @param onSample handler called after each periodic sample.
+     * @return Error.
+     */
+    Error Start(const SampleHandler& onSample = {});
+
+    /**
+     * Stops periodic sampling.
+     *
+     * @return Error.
+     */
+    Error Stop();
+
+    /**
+     * Takes resource sample immediately.
+     *
+     * @return Error.
+     */
+    Error Sample();
+
+    /**
+     * Returns last resource sample.
+     *
+     * @param[out] usage resource usage.
+     * @return Error.
+     */
+    Error GetResourceUsage(ResourceUsage& usage) const;
+
+    /**
+     * Checks whether periodic sampling is enabled.
+     *
+     * @return bool.
+     */
+    bool IsEnabled() const { return mConfig.mInterval.Nanoseconds() > 0; }
+
+private:
+    void  Run();
+    Error SampleRAM(ResourceUsage& usage);
+    Error SampleCPU(ResourceUsage& usage);
+    void  SamplePartitions(ResourceUsage& usage);
+
+    iam::config::ResourceSamplerConfig            mConfig {};
+    std::chrono::nanoseconds                      mPartitionProbeTimeout {};
+    std::string                                   mMemInfoPath;
+    std::string                                   mStatPath;
+    std::vector<iam::config::PartitionInfoConfig> mPartitions;
+
+    // guarded by mSampleMutex, reused between samples to avoid allocations
+    std::mutex                        mSampleMutex;
+    std::string                       mBuffer;
+    utils::CPUTimes                   mPrevCPUTimes;
+    ResourceUsage                     mSample;
+    std::vector<utils::FSUsageFuture> mPartitionProbes;
+
+    mutable std::mutex      mMutex;
+    ResourceUsage           mUsage;
+    std::thread             mThread;
+    std::condition_variable mCondVar;
+    SampleHandler           mOnSample;
+    bool                    mStop = true;
+};
+
+} // namespace aos::iam::nodeinfoprovider
+
+#endif
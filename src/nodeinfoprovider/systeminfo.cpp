@@ -5,15 +5,19 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
-#include <fstream>
-#include <memory>
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <fcntl.h>
+#include <filesystem>
 #include <sys/statfs.h>
+#include <sys/statvfs.h>
 #include <sys/utsname.h>
-#include <unordered_map>
+#include <thread>
+#include <unistd.h>
 #include <vector>
 
 #include <utils/exception.hpp>
-#include <utils/parser.hpp>
 
 #include "logger/logmodule.hpp"
 #include "systeminfo.hpp"
@@ -26,131 +30,287 @@ namespace {
  * Constants
  **********************************************************************************************************************/
 
-constexpr auto cBytesPerKB = 1024;
+constexpr auto cBytesPerKB     = 1024;
+constexpr auto cReadChunkSize  = 4096;
+constexpr auto cWhitespace     = " \t";
+constexpr auto cMemTotalKey    = std::string_view("MemTotal");
+constexpr auto cMemFreeKey     = std::string_view("MemFree");
+constexpr auto cMemAvailKey    = std::string_view("MemAvailable");
+constexpr auto cCPUStatLineKey = std::string_view("cpu");
+constexpr auto cMaxValueLen    = 255;
+constexpr auto cUnlimited      = std::string_view("max");
+constexpr auto cCGroupV2Prefix = std::string_view("0::");
+constexpr auto cCPUMaxFile     = "cpu.max";
+constexpr auto cCPUSetFile     = "cpuset.cpus.effective";
+constexpr auto cMemoryMaxFile  = "memory.max";
 
 /***********************************************************************************************************************
  * Static
  **********************************************************************************************************************/
 
+std::string_view NextLine(std::string_view& content)
+{
+    const auto pos  = content.find('\n');
+    const auto line = content.substr(0, pos);
+
+    content.remove_prefix(pos == std::string_view::npos ? content.size() : pos + 1);
+
+    return line;
+}
+
+std::string_view NextToken(std::string_view& content)
+{
+    const auto begin = content.find_first_not_of(cWhitespace);
+    if (begin == std::string_view::npos) {
+        content = {};
+
+        return {};
+    }
+
+    content.remove_prefix(begin);
+
+    const auto end   = content.find_first_of(cWhitespace);
+    const auto token = content.substr(0, end);
+
+    content.remove_prefix(end == std::string_view::npos ? content.size() : end);
+
+    return token;
+}
+
+bool ParseUInt(std::string_view str, uint64_t& value)
+{
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+
+    return ec == std::errc() && ptr != str.data();
+}
+
+std::string_view Trim(std::string_view str)
+{
+    const auto begin = str.find_first_not_of(cWhitespace);
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+
+    const auto end = str.find_last_not_of(cWhitespace);
+
+    return str.substr(begin, end - begin + 1);
+}
+
+bool ParseKeyValue(std::string_view line, std::string_view& key, std::string_view& value)
+{
+    const auto colon = line.find(':');
+    if (colon == std::string_view::npos) {
+        return false;
+    }
+
+    key   = Trim(line.substr(0, colon));
+    value = Trim(line.substr(colon + 1));
+
+    return true;
+}
+
+RetWithError<std::string> GetCGroupPath(const std::string& procCGroupPath, std::string& buffer)
+{
+    if (auto err = ReadFileToBuffer(procCGroupPath, buffer); !err.IsNone()) {
+        return {{}, err};
+    }
+
+    std::string_view content = buffer;
+
+    // cgroup v2 unified hierarchy entry: 0::/path
+    while (!content.empty()) {
+        auto line = Trim(NextLine(content));
+
+        if (line.substr(0, cCGroupV2Prefix.size()) == cCGroupV2Prefix) {
+            line.remove_prefix(cCGroupV2Prefix.size());
+
+            return {std::string(line), ErrorEnum::eNone};
+        }
+    }
+
+    return {{}, ErrorEnum::eNotFound};
+}
+
+template <typename T>
+Error ReadCGroupValue(const std::filesystem::path& dir, const char* fileName, std::string& buffer,
+    Error (*parse)(std::string_view, T&) noexcept, T& value)
+{
+    if (auto err = ReadFileToBuffer(dir / fileName, buffer); !err.IsNone()) {
+        return err;
+    }
+
+    return parse(buffer, value);
+}
+
+template <typename T>
+void ApplyLimit(T& limit, T value)
+{
+    if (value != 0 && (limit == 0 || value < limit)) {
+        limit = value;
+    }
+}
+
+template <typename T>
+void AssignString(T& dst, std::string_view value)
+{
+    char str[cMaxValueLen + 1];
+
+    const auto len = value.copy(str, cMaxValueLen);
+
+    str[len] = '\0';
+    dst      = str;
+}
+
 class CPUInfoParser {
 public:
+    CPUInfoParser()
+    {
+        struct utsname buffer;
+
+        if (auto ret = uname(&buffer); ret != 0) {
+            AOS_ERROR_THROW(ErrorEnum::eFailed, "failed to get CPU architecture");
+        }
+
+        auto err = mDefaultCPUInfo.mArch.Assign(buffer.machine);
+        AOS_ERROR_CHECK_AND_THROW(err);
+
+        mDefaultCPUInfo.mNumCores   = 1;
+        mDefaultCPUInfo.mNumThreads = 1;
+
+        mCurrentCPUInfo = mDefaultCPUInfo;
+    }
+
     Error GetCPUInfo(const std::string& path, Array<CPUInfo>& cpuInfoArray)
     {
-        try {
-            if (const auto err = ParseCPUInfoFile(path); !err.IsNone()) {
-                LOG_WRN() << "Failed to parse CPU info file" << Log::Field(err);
+        if (auto err = ParseCPUInfoFile(path, cpuInfoArray); !err.IsNone()) {
+            if (err.Is(ErrorEnum::eNoMemory)) {
+                return err;
             }
 
-            if (mCPUInfos.empty()) {
-                mCPUInfos.insert({0, CreateDefaultCPUInfo()});
-            }
+            LOG_WRN() << "Failed to parse CPU info file" << Log::Field(err);
+        }
 
-            for (const auto& item : mCPUInfos) {
-                if (const auto err = cpuInfoArray.PushBack(item.second); !err.IsNone()) {
-                    return err;
-                }
+        if (cpuInfoArray.Size() == 0) {
+            if (auto err = cpuInfoArray.PushBack(mDefaultCPUInfo); !err.IsNone()) {
+                return err;
             }
-        } catch (const std::exception& e) {
-            return common::utils::ToAosError(e);
         }
 
         return ErrorEnum::eNone;
     }
 
 private:
-    void PopulateCPUInfoObject()
+    static constexpr auto cMaxPhysicalIDs = 64;
+
+    Error ParseCPUInfoFile(const std::string& path, Array<CPUInfo>& cpuInfoArray)
     {
-        if (mCurrentEntryKeyValues.empty()) {
-            return;
-        }
-
-        size_t  physicalId = 0;
-        CPUInfo cpuInfo    = CreateDefaultCPUInfo();
-
-        for (const auto& keyValue : mCurrentEntryKeyValues) {
-            try {
-                if (keyValue.mKey == "physical id") {
-                    physicalId = std::stoul(keyValue.mValue);
-                } else if (keyValue.mKey == "model name") {
-                    cpuInfo.mModelName = keyValue.mValue.c_str();
-                } else if (keyValue.mKey == "cpu cores") {
-                    cpuInfo.mNumCores = std::stoul(keyValue.mValue);
-                } else if (keyValue.mKey == "siblings") {
-                    cpuInfo.mNumThreads = std::stoul(keyValue.mValue);
-                } else if (keyValue.mKey == "cpu family") {
-                    cpuInfo.mArch = keyValue.mValue.c_str();
+        std::string buffer;
+
+        if (auto err = ReadFileToBuffer(path, buffer); !err.IsNone()) {
+            return AOS_ERROR_WRAP(err);
+        }
+
+        std::string_view content = buffer;
+
+        while (!content.empty()) {
+            std::string_view key, value;
+
+            const bool hasKeyValue = ParseKeyValue(NextLine(content), key, value);
+
+            if (!hasKeyValue || key == "processor") {
+                if (auto err = PopulateCPUInfoObject(cpuInfoArray); !err.IsNone()) {
+                    return err;
                 }
-            } catch (...) {
-                LOG_DBG() << "CPU info parsing failed: key=" << keyValue.mKey.c_str()
-                          << ", value=" << keyValue.mValue.c_str();
+            }
 
-                AOS_ERROR_THROW(ErrorEnum::eFailed, "failed to parse CPU info");
+            if (hasKeyValue) {
+                if (auto err = HandleKeyValue(key, value); !err.IsNone()) {
+                    return err;
+                }
             }
         }
 
-        // only the first entry for the CPU is stored in the map.
-        mCPUInfos.insert({physicalId, cpuInfo});
-
-        mCurrentEntryKeyValues.clear();
+        // populate last CPU info object
+        return PopulateCPUInfoObject(cpuInfoArray);
     }
 
-    void SetArchitecture(CPUInfo& cpuInfo) const
+    Error HandleKeyValue(std::string_view key, std::string_view value)
     {
-        struct utsname buffer;
+        uint64_t number = 0;
 
-        if (auto ret = uname(&buffer); ret != 0) {
-            AOS_ERROR_THROW(ErrorEnum::eFailed, "failed to get CPU architecture");
+        if (key == "physical id") {
+            if (!ParseUInt(value, number)) {
+                return LogParseError(key, value);
+            }
+
+            mCurrentPhysicalID = number;
+        } else if (key == "model name") {
+            AssignString(mCurrentCPUInfo.mModelName, value);
+        } else if (key == "cpu cores") {
+            if (!ParseUInt(value, number)) {
+                return LogParseError(key, value);
+            }
+
+            mCurrentCPUInfo.mNumCores = number;
+        } else if (key == "siblings") {
+            if (!ParseUInt(value, number)) {
+                return LogParseError(key, value);
+            }
+
+            mCurrentCPUInfo.mNumThreads = number;
+        } else if (key == "cpu family") {
+            AssignString(mCurrentCPUInfo.mArch, value);
+        } else {
+            return ErrorEnum::eNone;
         }
 
-        auto err = cpuInfo.mArch.Assign(buffer.machine);
-        AOS_ERROR_CHECK_AND_THROW(err);
+        mHasCurrentEntry = true;
+
+        return ErrorEnum::eNone;
     }
 
-    Error ParseCPUInfoFile(const std::string& path) noexcept
+    Error PopulateCPUInfoObject(Array<CPUInfo>& cpuInfoArray)
     {
-        auto file = std::ifstream(path);
-        if (!file.is_open()) {
-            return AOS_ERROR_WRAP(ErrorEnum::eNotFound);
+        if (!mHasCurrentEntry) {
+            return ErrorEnum::eNone;
         }
 
-        try {
-            std::string line;
+        const auto physicalIDsEnd = mPhysicalIDs + mNumPhysicalIDs;
 
-            while (std::getline(file, line)) {
-                auto keyValue = common::utils::ParseKeyValue(line);
-
-                if (!keyValue.has_value() || keyValue->mKey == "processor") {
-                    PopulateCPUInfoObject();
-                }
+        // only the first entry for the CPU is stored.
+        if (std::find(mPhysicalIDs, physicalIDsEnd, mCurrentPhysicalID) == physicalIDsEnd) {
+            if (mNumPhysicalIDs == cMaxPhysicalIDs) {
+                return AOS_ERROR_WRAP(Error(ErrorEnum::eNoMemory, "too many physical CPUs"));
+            }
 
-                if (keyValue.has_value()) {
-                    mCurrentEntryKeyValues.push_back(std::move(keyValue.value()));
-                }
+            if (auto err = cpuInfoArray.PushBack(mCurrentCPUInfo); !err.IsNone()) {
+                return AOS_ERROR_WRAP(err);
             }
 
-            // populate last CPU info object
-            PopulateCPUInfoObject();
-        } catch (const std::exception& e) {
-            return AOS_ERROR_WRAP(common::utils::ToAosError(e));
+            mPhysicalIDs[mNumPhysicalIDs++] = mCurrentPhysicalID;
         }
 
+        mCurrentCPUInfo    = mDefaultCPUInfo;
+        mCurrentPhysicalID = 0;
+        mHasCurrentEntry   = false;
+
         return ErrorEnum::eNone;
     }
 
-    CPUInfo CreateDefaultCPUInfo() const
+    Error LogParseError(std::string_view key, std::string_view value)
     {
-        CPUInfo cpuInfo = {};
-
-        cpuInfo.mNumCores   = 1;
-        cpuInfo.mNumThreads = 1;
+        LOG_DBG() << "CPU info parsing failed: key=" << std::string(key).c_str()
+                  << ", value=" << std::string(value).c_str();
 
-        SetArchitecture(cpuInfo);
-
-        return cpuInfo;
+        return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "failed to parse CPU info"));
     }
 
-    std::unordered_map<size_t, CPUInfo>  mCPUInfos;
-    std::vector<common::utils::KeyValue> mCurrentEntryKeyValues;
+    CPUInfo  mDefaultCPUInfo {};
+    CPUInfo  mCurrentCPUInfo {};
+    uint64_t mCurrentPhysicalID = 0;
+    bool     mHasCurrentEntry   = false;
+    uint64_t mPhysicalIDs[cMaxPhysicalIDs] {};
+    size_t   mNumPhysicalIDs = 0;
 };
 
 } // namespace
@@ -171,45 +331,325 @@ Error GetCPUInfo(const std::string& path, Array<CPUInfo>& cpuInfoArray) noexcept
 }
 
 RetWithError<uint64_t> GetMemTotal(const std::string& path) noexcept
+{
+    std::string buffer;
+
+    if (auto err = ReadFileToBuffer(path, buffer); !err.IsNone()) {
+        return {0, err};
+    }
+
+    MemUsage memUsage;
+
+    if (auto err = ParseMemUsage(buffer, memUsage); !err.IsNone()) {
+        return {0, err};
+    }
+
+    return {memUsage.mTotal, ErrorEnum::eNone};
+}
+
+RetWithError<uint64_t> GetMountFSTotalSize(const std::string& path) noexcept
+{
+    struct statfs stat { };
+
+    if (statfs(path.c_str(), &stat) == -1) {
+        return {0, ErrorEnum::eFailed};
+    }
+
+    return {stat.f_blocks * stat.f_bsize, ErrorEnum::eNone};
+}
+
+RetWithError<FSUsage> GetMountFSUsage(const std::string& path) noexcept
+{
+    struct statvfs stat { };
+
+    if (statvfs(path.c_str(), &stat) == -1) {
+        return {{}, AOS_ERROR_WRAP(errno)};
+    }
+
+    FSUsage usage;
+
+    usage.mTotalSize = stat.f_blocks * stat.f_frsize;
+    usage.mUsedSize  = (stat.f_blocks - stat.f_bfree) * stat.f_frsize;
+
+    return {usage, ErrorEnum::eNone};
+}
+
+FSUsageFuture ProbeMountFSUsage(const std::string& path) noexcept
 {
     try {
-        std::ifstream file;
+        auto promise = std::make_shared<std::promise<RetWithError<FSUsage>>>();
+        auto future  = promise->get_future().share();
+
+        std::thread([promise, path]() { promise->set_value(GetMountFSUsage(path)); }).detach();
+
+        return future;
+    } catch (const std::exception& e) {
+        std::promise<RetWithError<FSUsage>> promise;
+
+        promise.set_value({{}, AOS_ERROR_WRAP(common::utils::ToAosError(e))});
+
+        return promise.get_future().share();
+    }
+}
 
-        if (file.open(path); !file.is_open()) {
-            return {0, ErrorEnum::eNotFound};
+Error ReadFileToBuffer(const std::string& path, std::string& buffer) noexcept
+{
+    // procfs files report zero size, so read by chunks until EOF
+    auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        if (errno == ENOENT) {
+            return ErrorEnum::eNotFound;
         }
 
-        std::string line;
+        return AOS_ERROR_WRAP(errno);
+    }
 
-        while (std::getline(file, line)) {
-            const auto keyValue = common::utils::ParseKeyValue(line);
+    Error  err;
+    size_t size = 0;
 
-            if (!keyValue.has_value() || keyValue->mKey != "MemTotal") {
-                continue;
+    try {
+        while (true) {
+            if (buffer.size() < size + cReadChunkSize) {
+                buffer.resize(size + cReadChunkSize);
+            }
+
+            auto ret = read(fd, buffer.data() + size, buffer.size() - size);
+            if (ret == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                err = AOS_ERROR_WRAP(errno);
+
+                break;
             }
 
-            const auto memTotalKB = std::stoull(keyValue->mValue.substr(0, keyValue->mValue.find(" ")));
+            if (ret == 0) {
+                break;
+            }
 
-            // convert KB to bytes
-            return {memTotalKB * cBytesPerKB, ErrorEnum::eNone};
+            size += ret;
         }
 
+        buffer.resize(size);
     } catch (const std::exception& e) {
-        return {0, AOS_ERROR_WRAP(common::utils::ToAosError(e))};
+        err = AOS_ERROR_WRAP(common::utils::ToAosError(e));
     }
 
-    return {0, ErrorEnum::eFailed};
+    close(fd);
+
+    return err;
 }
 
-RetWithError<uint64_t> GetMountFSTotalSize(const std::string& path) noexcept
+Error ParseMemUsage(std::string_view content, MemUsage& memUsage) noexcept
 {
-    struct statfs stat { };
+    bool     totalFound = false, availFound = false;
+    uint64_t memFree = 0;
 
-    if (statfs(path.c_str(), &stat) == -1) {
-        return {0, ErrorEnum::eFailed};
+    memUsage = {};
+
+    while (!content.empty() && !(totalFound && availFound)) {
+        auto line = NextLine(content);
+
+        const auto colon = line.find(':');
+        if (colon == std::string_view::npos) {
+            continue;
+        }
+
+        const auto key = line.substr(0, colon);
+
+        line.remove_prefix(colon + 1);
+
+        uint64_t valueKB = 0;
+
+        if (!ParseUInt(NextToken(line), valueKB)) {
+            continue;
+        }
+
+        if (key == cMemTotalKey) {
+            memUsage.mTotal = valueKB * cBytesPerKB;
+            totalFound      = true;
+        } else if (key == cMemAvailKey) {
+            memUsage.mAvailable = valueKB * cBytesPerKB;
+            availFound          = true;
+        } else if (key == cMemFreeKey) {
+            memFree = valueKB * cBytesPerKB;
+        }
     }
 
-    return {stat.f_blocks * stat.f_bsize, ErrorEnum::eNone};
+    if (!totalFound) {
+        return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "MemTotal not found"));
+    }
+
+    // kernels older than 3.14 don't provide MemAvailable
+    if (!availFound) {
+        memUsage.mAvailable = memFree;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error ParseCPUTimes(std::string_view content, CPUTimes& cpuTimes) noexcept
+{
+    cpuTimes = {};
+
+    while (!content.empty()) {
+        auto line = NextLine(content);
+
+        if (NextToken(line) != cCPUStatLineKey) {
+            continue;
+        }
+
+        // user nice system idle iowait irq softirq steal guest guest_nice
+        uint64_t value = 0;
+
+        for (size_t i = 0; ParseUInt(NextToken(line), value); i++) {
+            // guest time is already accounted in user time
+            if (i >= 8) {
+                break;
+            }
+
+            cpuTimes.mTotal += value;
+
+            if (i == 3 || i == 4) {
+                cpuTimes.mIdle += value;
+            }
+        }
+
+        if (cpuTimes.mTotal == 0) {
+            return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "invalid CPU stat line"));
+        }
+
+        return ErrorEnum::eNone;
+    }
+
+    return AOS_ERROR_WRAP(Error(ErrorEnum::eNotFound, "CPU stat line not found"));
+}
+
+RetWithError<CGroupLimits> GetCGroupLimits(const std::string& procCGroupPath, const std::string& cgroupRoot) noexcept
+{
+    try {
+        std::string buffer;
+
+        auto [cgroupPath, err] = GetCGroupPath(procCGroupPath, buffer);
+        if (!err.IsNone()) {
+            return {{}, err};
+        }
+
+        // effective limit is the tightest limit from the process cgroup up to the hierarchy root
+        std::vector<std::filesystem::path> dirs {cgroupRoot};
+
+        for (const auto& name : std::filesystem::path(cgroupPath).relative_path()) {
+            if (!name.empty()) {
+                dirs.push_back(dirs.back() / name);
+            }
+        }
+
+        CGroupLimits limits;
+
+        for (auto it = dirs.rbegin(); it != dirs.rend(); it++) {
+            double   cpuQuota = 0.0;
+            uint64_t value    = 0;
+
+            // the root cgroup has no cpu.max and memory.max files
+            if (err = ReadCGroupValue(*it, cCPUMaxFile, buffer, ParseCPUMax, cpuQuota); err.IsNone()) {
+                ApplyLimit(limits.mCPUQuota, cpuQuota);
+            } else if (!err.Is(ErrorEnum::eNotFound)) {
+                LOG_WRN() << "Can't read cgroup CPU quota: path=" << it->c_str() << ", err=" << err;
+            }
+
+            if (err = ReadCGroupValue(*it, cMemoryMaxFile, buffer, ParseMemoryMax, value); err.IsNone()) {
+                ApplyLimit(limits.mMemLimit, value);
+            } else if (!err.Is(ErrorEnum::eNotFound)) {
+                LOG_WRN() << "Can't read cgroup memory limit: path=" << it->c_str() << ", err=" << err;
+            }
+
+            // cpuset.cpus.effective already accounts ancestor restrictions, take the nearest one
+            if (limits.mNumCPUs != 0) {
+                continue;
+            }
+
+            if (err = ReadCGroupValue(*it, cCPUSetFile, buffer, ParseCPUList, value); err.IsNone()) {
+                limits.mNumCPUs = value;
+            } else if (!err.Is(ErrorEnum::eNotFound)) {
+                LOG_WRN() << "Can't read cgroup cpuset: path=" << it->c_str() << ", err=" << err;
+            }
+        }
+
+        return {limits, ErrorEnum::eNone};
+    } catch (const std::exception& e) {
+        return {{}, AOS_ERROR_WRAP(common::utils::ToAosError(e))};
+    }
+}
+
+Error ParseCPUMax(std::string_view content, double& cpuQuota) noexcept
+{
+    // $MAX $PERIOD
+    const auto quota = NextToken(content);
+
+    cpuQuota = 0.0;
+
+    if (quota == cUnlimited) {
+        return ErrorEnum::eNone;
+    }
+
+    uint64_t quotaUS = 0, periodUS = 0;
+
+    if (!ParseUInt(quota, quotaUS) || !ParseUInt(NextToken(content), periodUS) || periodUS == 0) {
+        return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "invalid cpu.max format"));
+    }
+
+    cpuQuota = static_cast<double>(quotaUS) / periodUS;
+
+    return ErrorEnum::eNone;
+}
+
+Error ParseCPUList(std::string_view content, uint64_t& numCPUs) noexcept
+{
+    numCPUs = 0;
+
+    content = Trim(NextLine(content));
+
+    while (!content.empty()) {
+        const auto comma = content.find(',');
+        const auto item  = Trim(content.substr(0, comma));
+
+        content.remove_prefix(comma == std::string_view::npos ? content.size() : comma + 1);
+
+        const auto dash  = item.find('-');
+        uint64_t   first = 0, last = 0;
+
+        if (!ParseUInt(item.substr(0, dash), first)) {
+            return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "invalid CPU list format"));
+        }
+
+        last = first;
+
+        if (dash != std::string_view::npos && (!ParseUInt(item.substr(dash + 1), last) || last < first)) {
+            return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "invalid CPU list format"));
+        }
+
+        numCPUs += last - first + 1;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error ParseMemoryMax(std::string_view content, uint64_t& memLimit) noexcept
+{
+    const auto limit = Trim(NextLine(content));
+
+    memLimit = 0;
+
+    if (limit == cUnlimited) {
+        return ErrorEnum::eNone;
+    }
+
+    if (!ParseUInt(limit, memLimit)) {
+        return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "invalid memory.max format"));
+    }
+
+    return ErrorEnum::eNone;
 }
 
 } // namespace aos::iam::nodeinfoprovider::utils
@@ -8,12 +8,53 @@
 #ifndef SYSTEMINFO_HPP_
 #define SYSTEMINFO_HPP_
 
+#include <chrono>
+#include <future>
 #include <string>
+#include <string_view>
 
 #include <aos/common/types.hpp>
 
 namespace aos::iam::nodeinfoprovider::utils {
 
+/**
+ * Default mount point probe timeout.
+ */
+constexpr auto cDefaultProbeTimeout = std::chrono::seconds(5);
+
+/**
+ * Memory usage.
+ */
+struct MemUsage {
+    uint64_t mTotal     = 0;
+    uint64_t mAvailable = 0;
+};
+
+/**
+ * Aggregated CPU times from /proc/stat in clock ticks.
+ */
+struct CPUTimes {
+    uint64_t mTotal = 0;
+    uint64_t mIdle  = 0;
+};
+
+/**
+ * File system usage.
+ */
+struct FSUsage {
+    uint64_t mTotalSize = 0;
+    uint64_t mUsedSize  = 0;
+};
+
+/**
+ * Resource limits of the process cgroup. Zero value means the resource is not limited.
+ */
+struct CGroupLimits {
+    double   mCPUQuota = 0.0;
+    uint64_t mNumCPUs  = 0;
+    uint64_t mMemLimit = 0;
+};
+
 /**
  * Gets CPU information from the specified file.
  *
@@ -39,6 +80,91 @@ RetWithError<uint64_t> GetMemTotal(const std::string& path) noexcept;
  */
 RetWithError<uint64_t> GetMountFSTotalSize(const std::string& path) noexcept;
 
+/**
+ * Gets the total and used size of the specified mount point.
+ *
+ * @param path Path to the mount point.
+ * @return RetWithError<FSUsage>.
+ */
+RetWithError<FSUsage> GetMountFSUsage(const std::string& path) noexcept;
+
+/**
+ * File system usage probe result.
+ */
+using FSUsageFuture = std::shared_future<RetWithError<FSUsage>>;
+
+/**
+ * Starts probing of the specified mount point usage in a detached thread. A hung mount blocks only the probe thread,
+ * the caller waits for the result with its own timeout.
+ *
+ * @param path Path to the mount point.
+ * @return FSUsageFuture.
+ */
+FSUsageFuture ProbeMountFSUsage(const std::string& path) noexcept;
+
+/**
+ * Reads whole file into the buffer. The buffer capacity is reused between calls.
+ *
+ * @param path Path to the file.
+ * @param[out] buffer Buffer to store file content.
+ * @return Error.
+ */
+Error ReadFileToBuffer(const std::string& path, std::string& buffer) noexcept;
+
+/**
+ * Parses memory usage from /proc/meminfo content.
+ *
+ * @param content /proc/meminfo content.
+ * @param[out] memUsage memory usage.
+ * @return Error.
+ */
+Error ParseMemUsage(std::string_view content, MemUsage& memUsage) noexcept;
+
+/**
+ * Parses aggregated CPU times from /proc/stat content.
+ *
+ * @param content /proc/stat content.
+ * @param[out] cpuTimes CPU times.
+ * @return Error.
+ */
+Error ParseCPUTimes(std::string_view content, CPUTimes& cpuTimes) noexcept;
+
+/**
+ * Gets cgroup v2 resource limits of the current process. Limits set on ancestor cgroups are taken into account.
+ *
+ * @param procCGroupPath Path to the process cgroup membership file.
+ * @param cgroupRoot cgroup v2 mount point.
+ * @return RetWithError<CGroupLimits>.
+ */
+RetWithError<CGroupLimits> GetCGroupLimits(const std::string& procCGroupPath, const std::string& cgroupRoot) noexcept;
+
+/**
+ * Parses CPU quota in CPUs from cgroup cpu.max content.
+ *
+ * @param content cpu.max content.
+ * @param[out] cpuQuota CPU quota, zero if not limited.
+ * @return Error.
+ */
+Error ParseCPUMax(std::string_view content, double& cpuQuota) noexcept;
+
+/**
+ * Parses number of CPUs from cgroup CPU list content, e.g. "0-3,6".
+ *
+ * @param content cpuset.cpus.effective content.
+ * @param[out] numCPUs number of CPUs.
+ * @return Error.
+ */
+Error ParseCPUList(std::string_view content, uint64_t& numCPUs) noexcept;
+
+/**
+ * Parses memory limit from cgroup memory.max content.
+ *
+ * @param content memory.max content.
+ * @param[out] memLimit memory limit, zero if not limited.
+ * @return Error.
+ */
+Error ParseMemoryMax(std::string_view content, uint64_t& memLimit) noexcept;
+
 } // namespace aos::iam::nodeinfoprovider::utils
 
 #endif
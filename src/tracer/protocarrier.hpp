@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PROTOCARRIER_HPP_
+#define PROTOCARRIER_HPP_
+
+#include <algorithm>
+#include <chrono>
+
+#include <google/protobuf/message.h>
+#include <google/protobuf/unknown_field_set.h>
+
+#include "span.hpp"
+
+namespace aos::iam::tracer {
+
+/**
+ * Field number carrying traceparent in protobuf messages. The field is not declared in the proto schema: it is kept as
+ * unknown field, so peers not aware of it pass it through or drop it without errors.
+ */
+constexpr int cTraceParentFieldNumber = 536870000;
+
+/**
+ * Field number carrying time left until the deadline of the forwarded call, milliseconds. Kept as unknown field as well.
+ */
+constexpr int cDeadlineFieldNumber = 536870001;
+
+/**
+ * Attaches span context to protobuf message.
+ *
+ * @param message message.
+ * @param context span context.
+ */
+inline void InjectSpanContext(google::protobuf::Message& message, const SpanContext& context)
+{
+    auto fields = message.GetReflection()->MutableUnknownFields(&message);
+
+    fields->DeleteByNumber(cTraceParentFieldNumber);
+    fields->AddLengthDelimited(cTraceParentFieldNumber, ToTraceParent(context));
+}
+
+/**
+ * Extracts span context from protobuf message.
+ *
+ * @param message message.
+ * @return std::optional<SpanContext>.
+ */
+inline std::optional<SpanContext> ExtractSpanContext(const google::protobuf::Message& message)
+{
+    const auto& fields = message.GetReflection()->GetUnknownFields(message);
+
+    for (int i = 0; i < fields.field_count(); i++) {
+        const auto& field = fields.field(i);
+
+        if (field.number() == cTraceParentFieldNumber
+            && field.type() == google::protobuf::UnknownField::TYPE_LENGTH_DELIMITED) {
+            return ParseTraceParent(field.length_delimited());
+        }
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * Attaches time left until the call deadline to protobuf message.
+ *
+ * @param message message.
+ * @param timeout time left until the deadline.
+ */
+inline void InjectDeadline(google::protobuf::Message& message, std::chrono::milliseconds timeout)
+{
+    auto fields = message.GetReflection()->MutableUnknownFields(&message);
+
+    fields->DeleteByNumber(cDeadlineFieldNumber);
+    fields->AddVarint(cDeadlineFieldNumber, static_cast<uint64_t>(std::max<int64_t>(timeout.count(), 0)));
+}
+
+/**
+ * Extracts time left until the call deadline from protobuf message.
+ *
+ * @param message message.
+ * @return std::optional<std::chrono::milliseconds> empty if the call has no deadline.
+ */
+inline std::optional<std::chrono::milliseconds> ExtractDeadline(const google::protobuf::Message& message)
+{
+    const auto& fields = message.GetReflection()->GetUnknownFields(message);
+
+    for (int i = 0; i < fields.field_count(); i++) {
+        const auto& field = fields.field(i);
+
+        if (field.number() == cDeadlineFieldNumber && field.type() == google::protobuf::UnknownField::TYPE_VARINT) {
+            return std::chrono::milliseconds(field.varint());
+        }
+    }
+
+    return std::nullopt;
+}
+
+} // namespace aos::iam::tracer
+
+#endif
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+#include "logger/logmodule.hpp"
+#include "span.hpp"
+#include "tracer.hpp"
+
+namespace aos::iam::tracer {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+// version-traceid-spanid-flags
+constexpr size_t cTraceParentLen = 55;
+constexpr auto   cVersion        = "00";
+constexpr auto   cSampledFlags   = "01";
+
+/***********************************************************************************************************************
+ * Vars
+ **********************************************************************************************************************/
+
+thread_local const Span* tCurrentSpan = nullptr;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+template <size_t cSize>
+void GenerateID(std::array<uint8_t, cSize>& id)
+{
+    thread_local std::mt19937_64 sGenerator {std::random_device {}()};
+
+    do {
+        for (size_t i = 0; i < cSize; i += sizeof(uint64_t)) {
+            const auto value = sGenerator();
+
+            memcpy(&id[i], &value, std::min(sizeof(value), cSize - i));
+        }
+        // all zero ID is invalid
+    } while (std::all_of(id.begin(), id.end(), [](uint8_t b) { return b == 0; }));
+}
+
+template <size_t cSize>
+std::string ToHex(const std::array<uint8_t, cSize>& id)
+{
+    static constexpr char cDigits[] = "0123456789abcdef";
+
+    std::string result;
+
+    result.reserve(cSize * 2);
+
+    for (auto b : id) {
+        result += cDigits[b >> 4];
+        result += cDigits[b & 0x0f];
+    }
+
+    return result;
+}
+
+int FromHexDigit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+
+    return -1;
+}
+
+template <size_t cSize>
+bool FromHex(const char* str, std::array<uint8_t, cSize>& id)
+{
+    for (size_t i = 0; i < cSize; i++) {
+        const auto high = FromHexDigit(str[i * 2]);
+        const auto low  = FromHexDigit(str[i * 2 + 1]);
+
+        if (high < 0 || low < 0) {
+            return false;
+        }
+
+        id[i] = static_cast<uint8_t>(high << 4 | low);
+    }
+
+    return std::any_of(id.begin(), id.end(), [](uint8_t b) { return b != 0; });
+}
+
+uint64_t ToEventID(const std::array<uint8_t, 8>& spanID)
+{
+    uint64_t id;
+
+    memcpy(&id, spanID.data(), sizeof(id));
+
+    return id;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+std::string ToTraceParent(const SpanContext& context)
+{
+    return std::string(cVersion) + "-" + ToHex(context.mTraceID) + "-" + ToHex(context.mSpanID) + "-" + cSampledFlags;
+}
+
+std::optional<SpanContext> ParseTraceParent(const std::string& value)
+{
+    SpanContext context;
+
+    // version 00 has fixed length, higher versions may append fields
+    if (value.size() < cTraceParentLen || value[2] != '-' || value[35] != '-' || value[52] != '-'
+        || value.compare(0, 2, "ff") == 0 || (value.compare(0, 2, cVersion) == 0 && value.size() != cTraceParentLen)) {
+        return std::nullopt;
+    }
+
+    if (!FromHex(&value[3], context.mTraceID) || !FromHex(&value[36], context.mSpanID)) {
+        return std::nullopt;
+    }
+
+    return context;
+}
+
+/***********************************************************************************************************************
+ * Span
+ **********************************************************************************************************************/
+
+Span::Span(const char* name, const std::optional<SpanContext>& parent)
+    : mName(name)
+    , mParentContext(parent)
+    , mPrevSpan(tCurrentSpan)
+    , mStart(Now())
+{
+    if (!mParentContext && mPrevSpan) {
+        mParentContext = mPrevSpan->GetContext();
+    }
+
+    if (mParentContext) {
+        mContext.mTraceID = mParentContext->mTraceID;
+    } else {
+        GenerateID(mContext.mTraceID);
+    }
+
+    GenerateID(mContext.mSpanID);
+
+    tCurrentSpan = this;
+}
+
+Span::~Span()
+{
+    tCurrentSpan = mPrevSpan;
+
+    const auto duration = Now() - mStart;
+
+    Record(EventType::eSpanEnd, mName, ToEventID(mContext.mSpanID), static_cast<int32_t>(duration / 1000));
+
+    LOG_DBG() << "Span finished: name=" << mName << ", trace=" << ToHex(mContext.mTraceID).c_str()
+              << ", span=" << ToHex(mContext.mSpanID).c_str()
+              << ", parent=" << (mParentContext ? ToHex(mParentContext->mSpanID).c_str() : "none")
+              << ", duration=" << static_cast<uint64_t>(duration / 1000) << "us";
+}
+
+const Span* Span::Current()
+{
+    return tCurrentSpan;
+}
+
+} // namespace aos::iam::tracer
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SPAN_HPP_
+#define SPAN_HPP_
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace aos::iam::tracer {
+
+/**
+ * W3C trace context header name.
+ */
+constexpr auto cTraceParentHeader = "traceparent";
+
+/**
+ * Span context identifying a span within a distributed trace.
+ */
+struct SpanContext {
+    std::array<uint8_t, 16> mTraceID {};
+    std::array<uint8_t, 8>  mSpanID {};
+};
+
+/**
+ * Formats span context as W3C traceparent value.
+ *
+ * @param context span context.
+ * @return std::string.
+ */
+std::string ToTraceParent(const SpanContext& context);
+
+/**
+ * Parses W3C traceparent value.
+ *
+ * @param value traceparent value.
+ * @return std::optional<SpanContext> empty if value is malformed.
+ */
+std::optional<SpanContext> ParseTraceParent(const std::string& value);
+
+/**
+ * Span measuring scope duration. The span becomes current for the calling thread until it is destroyed, spans created
+ * without explicit parent are children of the current span. Span timings are written to the debug log and to the trace
+ * ring.
+ */
+class Span {
+public:
+    /**
+     * Constructor.
+     *
+     * @param name span name, should outlive the span.
+     * @param parent remote parent context, new trace is started if neither it nor the current span is set.
+     */
+    explicit Span(const char* name, const std::optional<SpanContext>& parent = std::nullopt);
+
+    /**
+     * Destructor.
+     */
+    ~Span();
+
+    Span(const Span&)            = delete;
+    Span& operator=(const Span&) = delete;
+
+    /**
+     * Returns span context.
+     *
+     * @return const SpanContext&.
+     */
+    const SpanContext& GetContext() const { return mContext; }
+
+    /**
+     * Returns span of the calling thread.
+     *
+     * @return const Span* nullptr if there is no active span.
+     */
+    static const Span* Current();
+
+private:
+    const char*                mName;
+    SpanContext                mContext;
+    std::optional<SpanContext> mParentContext;
+    const Span*                mPrevSpan;
+    uint64_t                   mStart;
+};
+
+} // namespace aos::iam::tracer
+
+#endif
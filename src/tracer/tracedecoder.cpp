@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "tracer.hpp"
+
+using namespace aos::iam::tracer;
+
+namespace {
+
+/***********************************************************************************************************************
+ * Types
+ **********************************************************************************************************************/
+
+struct DecodedEvent {
+    Event                 mEvent;
+    const DumpRingHeader* mRing;
+};
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+std::string FormatTime(uint64_t realTime)
+{
+    auto    seconds = static_cast<time_t>(realTime / 1000000000);
+    std::tm tm {};
+    char    buffer[64];
+
+    localtime_r(&seconds, &tm);
+    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+
+    return std::string(buffer) + "." + std::to_string(1000000 + (realTime % 1000000000) / 1000).substr(1);
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Main
+ **********************************************************************************************************************/
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <trace dump file>" << std::endl;
+
+        return 1;
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+        std::cerr << "Can't open file: " << argv[1] << std::endl;
+
+        return 1;
+    }
+
+    DumpHeader header {};
+
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || memcmp(header.mMagic, cDumpMagic, sizeof(cDumpMagic)) != 0) {
+        std::cerr << "Not a trace dump file" << std::endl;
+
+        return 1;
+    }
+
+    if (header.mVersion != cDumpVersion || header.mEventSize != sizeof(Event) || header.mRingSize == 0) {
+        std::cerr << "Unsupported trace dump: version=" << header.mVersion << ", eventSize=" << header.mEventSize
+                  << std::endl;
+
+        return 1;
+    }
+
+    std::vector<DumpRingHeader> rings(header.mRingCount);
+    std::vector<DecodedEvent>   events;
+    std::vector<Event>          ringEvents(header.mRingSize);
+
+    for (auto& ring : rings) {
+        if (!file.read(reinterpret_cast<char*>(&ring), sizeof(ring))
+            || !file.read(reinterpret_cast<char*>(ringEvents.data()), ringEvents.size() * sizeof(Event))) {
+            std::cerr << "Trace dump is truncated" << std::endl;
+
+            return 1;
+        }
+
+        const auto count = std::min<uint64_t>(ring.mHead, header.mRingSize);
+
+        for (auto i = ring.mHead - count; i < ring.mHead; i++) {
+            events.push_back({ringEvents[i % header.mRingSize], &ring});
+        }
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](const DecodedEvent& lhs, const DecodedEvent& rhs) {
+        return lhs.mEvent.mTimestamp < rhs.mEvent.mTimestamp;
+    });
+
+    for (const auto& item : events) {
+        const auto& event = item.mEvent;
+
+        // events are recorded with monotonic clock, convert them to the wall clock at dump time
+        const auto elapsed  = header.mMonotonicTime - std::min(event.mTimestamp, header.mMonotonicTime);
+        const auto realTime = header.mRealTime - elapsed;
+
+        char tag[cTagLen + 1] {};
+
+        memcpy(tag, event.mTag, cTagLen);
+
+        printf("%s tid=%" PRIu32 " (%.16s) %-15s %-23s id=%" PRIu64 " value=%" PRId32 "\n",
+            FormatTime(realTime).c_str(), item.mRing->mThreadID, item.mRing->mThreadName,
+            EventTypeToString(event.mType), tag, event.mID, event.mValue);
+    }
+
+    return 0;
+}
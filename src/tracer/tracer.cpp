@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "tracer.hpp"
+
+namespace aos::iam::tracer {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+constexpr size_t cMaxPathLen      = 256;
+constexpr auto   cDefaultDumpPath = "/tmp/aos_iam_trace.bin";
+
+static_assert((cRingSize & (cRingSize - 1)) == 0, "ring size should be power of two");
+
+constexpr const char* cEventTypeNames[] = {
+    "RPC_START",
+    "RPC_END",
+    "PENDING_SET",
+    "PENDING_FULFIL",
+    "PENDING_TIMEOUT",
+    "DB_OP",
+    "VIS_REQUEST",
+    "VIS_RESPONSE",
+    "SPAN_END",
+};
+
+static_assert(sizeof(cEventTypeNames) / sizeof(cEventTypeNames[0])
+        == static_cast<size_t>(EventType::eNumEventTypes),
+    "event type names mismatch");
+
+/***********************************************************************************************************************
+ * Types
+ **********************************************************************************************************************/
+
+// ring is written by the owning thread only, head is published after the event is written
+struct Ring {
+    std::atomic<uint64_t> mHead {0};
+    std::atomic_bool      mInUse {false};
+    uint32_t              mThreadID {};
+    char                  mThreadName[16] {};
+    Event                 mEvents[cRingSize] {};
+};
+
+// releases the ring on thread exit, the ring keeps its events until it is reused by another thread
+struct RingHolder {
+    ~RingHolder()
+    {
+        if (mRing) {
+            mRing->mInUse.store(false, std::memory_order_release);
+        }
+    }
+
+    Ring* mRing     = nullptr;
+    bool  mAcquired = false;
+};
+
+/***********************************************************************************************************************
+ * Vars
+ **********************************************************************************************************************/
+
+std::atomic<Ring*>      sRings[cMaxRings] {};
+char                    sDumpPath[cMaxPathLen] = {};
+thread_local RingHolder tRingHolder;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+void AssignRing(Ring* ring)
+{
+    ring->mThreadID = static_cast<uint32_t>(syscall(SYS_gettid));
+
+    if (pthread_getname_np(pthread_self(), ring->mThreadName, sizeof(ring->mThreadName)) != 0) {
+        ring->mThreadName[0] = '\0';
+    }
+}
+
+Ring* AcquireRing()
+{
+    // new rings are preferred to keep events of exited threads as long as possible
+    for (auto& slot : sRings) {
+        if (slot.load(std::memory_order_acquire)) {
+            continue;
+        }
+
+        auto newRing = new (std::nothrow) Ring();
+        if (!newRing) {
+            break;
+        }
+
+        newRing->mInUse.store(true, std::memory_order_relaxed);
+
+        if (Ring* expected = nullptr; slot.compare_exchange_strong(expected, newRing, std::memory_order_acq_rel)) {
+            AssignRing(newRing);
+
+            return newRing;
+        }
+
+        delete newRing;
+    }
+
+    for (auto& slot : sRings) {
+        auto ring = slot.load(std::memory_order_acquire);
+
+        if (bool inUse = false; ring && ring->mInUse.compare_exchange_strong(inUse, true, std::memory_order_acquire)) {
+            AssignRing(ring);
+
+            return ring;
+        }
+    }
+
+    return nullptr;
+}
+
+Ring* GetRing()
+{
+    if (!tRingHolder.mAcquired) {
+        tRingHolder.mAcquired = true;
+        tRingHolder.mRing     = AcquireRing();
+    }
+
+    return tRingHolder.mRing;
+}
+
+uint64_t GetTime(clockid_t clock)
+{
+    timespec ts {};
+
+    clock_gettime(clock, &ts);
+
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+bool WriteAll(int fd, const void* data, size_t size)
+{
+    auto ptr = static_cast<const char*>(data);
+
+    while (size > 0) {
+        auto written = write(fd, ptr, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        ptr += written;
+        size -= written;
+    }
+
+    return true;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+const char* EventTypeToString(uint8_t type)
+{
+    if (type >= static_cast<uint8_t>(EventType::eNumEventTypes)) {
+        return "UNKNOWN";
+    }
+
+    return cEventTypeNames[type];
+}
+
+uint64_t GetCorrelationID(const char* id) noexcept
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (; id && *id; id++) {
+        hash = (hash ^ static_cast<uint8_t>(*id)) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+void Record(EventType type, const char* tag, uint64_t id, int32_t value) noexcept
+{
+    auto ring = GetRing();
+    if (!ring) {
+        return;
+    }
+
+    auto  head  = ring->mHead.load(std::memory_order_relaxed);
+    auto& event = ring->mEvents[head & (cRingSize - 1)];
+
+    event.mTimestamp = Now();
+    event.mID        = id;
+    event.mValue     = value;
+    event.mType      = static_cast<uint8_t>(type);
+
+    strncpy(event.mTag, tag ? tag : "", cTagLen - 1);
+    event.mTag[cTagLen - 1] = '\0';
+
+    ring->mHead.store(head + 1, std::memory_order_release);
+}
+
+void SetDumpPath(const char* path) noexcept
+{
+    strncpy(sDumpPath, path, cMaxPathLen - 1);
+    sDumpPath[cMaxPathLen - 1] = '\0';
+}
+
+bool Dump() noexcept
+{
+    // only async-signal-safe functions are allowed here
+    const auto savedErrno = errno;
+    const auto path       = sDumpPath[0] != '\0' ? sDumpPath : cDefaultDumpPath;
+
+    auto fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        errno = savedErrno;
+
+        return false;
+    }
+
+    DumpHeader header {};
+
+    memcpy(header.mMagic, cDumpMagic, sizeof(header.mMagic));
+    header.mVersion       = cDumpVersion;
+    header.mEventSize     = sizeof(Event);
+    header.mRingSize      = cRingSize;
+    header.mMonotonicTime = GetTime(CLOCK_MONOTONIC);
+    header.mRealTime      = GetTime(CLOCK_REALTIME);
+
+    for (const auto& slot : sRings) {
+        if (slot.load(std::memory_order_acquire)) {
+            header.mRingCount++;
+        }
+    }
+
+    auto result    = WriteAll(fd, &header, sizeof(header));
+    auto remaining = header.mRingCount;
+
+    // rings acquired after counting are skipped to keep the dump consistent with the header
+    for (size_t i = 0; i < cMaxRings && result && remaining > 0; i++) {
+        auto ring = sRings[i].load(std::memory_order_acquire);
+        if (!ring) {
+            continue;
+        }
+
+        DumpRingHeader ringHeader {};
+
+        ringHeader.mHead     = ring->mHead.load(std::memory_order_acquire);
+        ringHeader.mThreadID = ring->mThreadID;
+        memcpy(ringHeader.mThreadName, ring->mThreadName, sizeof(ringHeader.mThreadName));
+
+        result = WriteAll(fd, &ringHeader, sizeof(ringHeader)) && WriteAll(fd, ring->mEvents, sizeof(ring->mEvents));
+        remaining--;
+    }
+
+    close(fd);
+
+    errno = savedErrno;
+
+    return result;
+}
+
+} // namespace aos::iam::tracer
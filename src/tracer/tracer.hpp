@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TRACER_HPP_
+#define TRACER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+namespace aos::iam::tracer {
+
+/**
+ * Trace event type.
+ */
+enum class EventType : uint8_t {
+    eRPCStart,
+    eRPCEnd,
+    ePendingSet,
+    ePendingFulfil,
+    ePendingTimeout,
+    eDBOp,
+    eVISRequest,
+    eVISResponse,
+    eSpanEnd,
+    eNumEventTypes,
+};
+
+/**
+ * Max event tag length including terminating zero.
+ */
+constexpr size_t cTagLen = 24;
+
+/**
+ * Number of events kept per thread, should be power of two.
+ */
+constexpr size_t cRingSize = 256;
+
+/**
+ * Max number of threads having own ring at the same time.
+ */
+constexpr size_t cMaxRings = 64;
+
+/**
+ * Trace event.
+ */
+struct Event {
+    uint64_t mTimestamp; // CLOCK_MONOTONIC, ns
+    uint64_t mID;
+    int32_t  mValue;
+    uint8_t  mType;
+    uint8_t  mReserved[3];
+    char     mTag[cTagLen];
+};
+
+static_assert(sizeof(Event) == 48, "unexpected trace event size");
+
+/**
+ * Trace dump file header.
+ */
+struct DumpHeader {
+    char     mMagic[8];
+    uint32_t mVersion;
+    uint32_t mEventSize;
+    uint32_t mRingSize;
+    uint32_t mRingCount;
+    uint64_t mMonotonicTime;
+    uint64_t mRealTime;
+};
+
+/**
+ * Trace dump ring header, followed by cRingSize events. Event with index i is at position i % cRingSize.
+ */
+struct DumpRingHeader {
+    uint64_t mHead;
+    uint32_t mThreadID;
+    uint32_t mReserved;
+    char     mThreadName[16];
+};
+
+/**
+ * Trace dump magic.
+ */
+constexpr char cDumpMagic[8] = {'A', 'O', 'S', 'T', 'R', 'A', 'C', 'E'};
+
+/**
+ * Trace dump version.
+ */
+constexpr uint32_t cDumpVersion = 1;
+
+/**
+ * Returns event type name.
+ *
+ * @param type event type.
+ * @return const char*.
+ */
+const char* EventTypeToString(uint8_t type);
+
+/**
+ * Returns event ID correlating events by a textual ID which doesn't fit the event tag, e.g. VIS request UUID.
+ *
+ * @param id textual ID.
+ * @return uint64_t 64-bit FNV-1a hash of the whole ID.
+ */
+uint64_t GetCorrelationID(const char* id) noexcept;
+
+/**
+ * Records event to the calling thread ring. Lock-free, events are silently skipped if all rings are taken.
+ *
+ * @param type event type.
+ * @param tag short event tag, truncated to cTagLen - 1.
+ * @param id event ID to match related events.
+ * @param value event value.
+ */
+void Record(EventType type, const char* tag, uint64_t id = 0, int32_t value = 0) noexcept;
+
+/**
+ * Sets trace dump file path.
+ *
+ * @param path path.
+ */
+void SetDumpPath(const char* path) noexcept;
+
+/**
+ * Dumps all rings to the dump file. Async-signal-safe, can be called from signal handler.
+ *
+ * @return bool true on success.
+ */
+bool Dump() noexcept;
+
+/**
+ * Returns monotonic timestamp used by trace events.
+ *
+ * @return uint64_t.
+ */
+inline uint64_t Now() noexcept
+{
+    timespec ts {};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Records single event with scope duration in microseconds as a value.
+ */
+class ScopedEvent {
+public:
+    /**
+     * Constructor.
+     *
+     * @param type event type.
+     * @param tag event tag, should outlive the scope.
+     * @param id event ID.
+     */
+    ScopedEvent(EventType type, const char* tag, uint64_t id = 0) noexcept
+        : mType(type)
+        , mTag(tag)
+        , mID(id)
+        , mStart(Now())
+    {
+    }
+
+    /**
+     * Destructor.
+     */
+    ~ScopedEvent() { Record(mType, mTag, mID, static_cast<int32_t>((Now() - mStart) / 1000)); }
+
+    ScopedEvent(const ScopedEvent&)            = delete;
+    ScopedEvent& operator=(const ScopedEvent&) = delete;
+
+private:
+    EventType   mType;
+    const char* mTag;
+    uint64_t    mID;
+    uint64_t    mStart;
+};
+
+} // namespace aos::iam::tracer
+
+#endif
@@ -14,7 +14,9 @@
 #include <utils/json.hpp>
 
 #include "logger/logmodule.hpp"
+#include "metrics/metrics.hpp"
 #include "pocowsclient.hpp"
+#include "tracer/tracer.hpp"
 #include "vismessage.hpp"
 #include "wsexception.hpp"
 
@@ -139,17 +141,37 @@ PocoWSClient::ByteArray PocoWSClient::SendRequest(const std::string& requestId,
 
     const auto onScopeExit = OnScopeExit([&](void*) { mPendingRequests.Remove(requestParams); });
 
+    static auto& requestDuration = metrics::GetRegistry().GetHistogram(
+        "aos_iam_vis_request_duration_seconds", "VIS request round-trip time");
+    static auto& requestTimeouts
+        = metrics::GetRegistry().GetCounter("aos_iam_vis_request_timeouts_total", "Number of timed out VIS requests");
+
+    metrics::ScopedTimer timer {requestDuration};
+
+    // request UUID doesn't fit the trace tag, correlate trace events and log by hash of the whole ID
+    const auto traceID = tracer::GetCorrelationID(requestId.c_str());
+
+    tracer::Record(tracer::EventType::eVISRequest, "vis", traceID);
+
+    const auto sendTime = tracer::Now();
+
     AsyncSendMessage(message);
 
-    LOG_DBG() << "Sent message: requestId = " << requestId.c_str();
+    LOG_DBG() << "Sent message: requestId = " << requestId.c_str() << ", traceID = " << traceID;
 
     std::string response;
     if (!requestParams->TryWaitForResponse(response, GetWebSocketTimeout())) {
+        tracer::Record(tracer::EventType::eVISResponse, "vis", traceID, -1);
+        requestTimeouts.Inc();
+
         LOG_ERR() << "Timeout waiting for server response: requestId = " << requestId.c_str();
 
         throw WSException("", AOS_ERROR_WRAP(aos::ErrorEnum::eTimeout));
     }
 
+    tracer::Record(
+        tracer::EventType::eVISResponse, "vis", traceID, static_cast<int32_t>((tracer::Now() - sendTime) / 1000));
+
     LOG_DBG() << "Got server response: requestId = " << requestId.c_str() << ", response = " << response.c_str();
 
     return {response.cbegin(), response.cend()};
@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <aos/iam/nodemanager.hpp>
+#include <aos/test/log.hpp>
+#include <utils/exception.hpp>
+
+#include "app/initgraph.hpp"
+#include "database/database.hpp"
+
+using namespace testing;
+
+namespace aos::iam::app {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+constexpr auto cWaitTimeout   = std::chrono::seconds(5);
+constexpr auto cDatabaseDir   = "initgraph_test_db";
+constexpr auto cMigrationPath = "initgraph_test_db/migration";
+
+/***********************************************************************************************************************
+ * Types
+ **********************************************************************************************************************/
+
+class InitRecorder {
+public:
+    InitGraph::Action Record(const std::string& name)
+    {
+        return [this, name]() {
+            auto current = ++mRunning;
+
+            for (auto max = mMaxRunning.load(); current > max && !mMaxRunning.compare_exchange_weak(max, current);) { }
+
+            {
+                std::lock_guard lock {mMutex};
+
+                mOrder.push_back(name);
+            }
+
+            mRunning--;
+        };
+    }
+
+    std::vector<std::string> GetOrder()
+    {
+        std::lock_guard lock {mMutex};
+
+        return mOrder;
+    }
+
+    size_t GetPosition(const std::string& name)
+    {
+        auto order = GetOrder();
+
+        return std::find(order.begin(), order.end(), name) - order.begin();
+    }
+
+    size_t GetMaxRunning() const { return mMaxRunning; }
+
+private:
+    std::mutex               mMutex;
+    std::vector<std::string> mOrder;
+    std::atomic<size_t>      mRunning    = 0;
+    std::atomic<size_t>      mMaxRunning = 0;
+};
+
+class Latch {
+public:
+    explicit Latch(size_t count)
+        : mCount(count)
+    {
+    }
+
+    bool ArriveAndWait()
+    {
+        std::unique_lock lock {mMutex};
+
+        if (--mCount == 0) {
+            mCondVar.notify_all();
+        }
+
+        return mCondVar.wait_for(lock, cWaitTimeout, [this]() { return mCount == 0; });
+    }
+
+private:
+    std::mutex              mMutex;
+    std::condition_variable mCondVar;
+    size_t                  mCount;
+};
+
+/***********************************************************************************************************************
+ * Utils
+ **********************************************************************************************************************/
+
+config::DatabaseConfig CreateDatabaseConfig()
+{
+    const auto migrationSrc = std::filesystem::path(__FILE__).parent_path() / "../.." / "src/database/migration";
+
+    std::filesystem::create_directories(cMigrationPath);
+    std::filesystem::copy(migrationSrc, cMigrationPath,
+        std::filesystem::copy_options::recursive | std::filesystem::copy_options::overwrite_existing);
+
+    config::DatabaseConfig config;
+
+    config.mWorkingDir          = (std::filesystem::current_path() / cDatabaseDir).string();
+    config.mMigrationPath       = cMigrationPath;
+    config.mMergedMigrationPath = std::string(cDatabaseDir) + "/merged-migration";
+
+    return config;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class InitGraphTest : public Test {
+protected:
+    void SetUp() override { test::InitLog(); }
+
+    void TearDown() override { std::filesystem::remove_all(cDatabaseDir); }
+
+    StartupTrace mTrace;
+    InitGraph    mGraph {mTrace};
+    InitRecorder mRecorder;
+};
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST_F(InitGraphTest, DependenciesAreInitializedFirst)
+{
+    mGraph.Add("database", {}, mRecorder.Record("database"));
+    mGraph.Add("certhandler", {"database"}, mRecorder.Record("certhandler"));
+    mGraph.Add("nodeinfoprovider", {}, mRecorder.Record("nodeinfoprovider"));
+    mGraph.Add("nodemanager", {"database", "nodeinfoprovider"}, mRecorder.Record("nodemanager"));
+    mGraph.Add("iamserver", {"certhandler", "nodemanager"}, mRecorder.Record("iamserver"));
+
+    ASSERT_NO_THROW(mGraph.Run());
+
+    ASSERT_EQ(mRecorder.GetOrder().size(), 5);
+
+    EXPECT_LT(mRecorder.GetPosition("database"), mRecorder.GetPosition("certhandler"));
+    EXPECT_LT(mRecorder.GetPosition("database"), mRecorder.GetPosition("nodemanager"));
+    EXPECT_LT(mRecorder.GetPosition("nodeinfoprovider"), mRecorder.GetPosition("nodemanager"));
+    EXPECT_LT(mRecorder.GetPosition("certhandler"), mRecorder.GetPosition("iamserver"));
+    EXPECT_LT(mRecorder.GetPosition("nodemanager"), mRecorder.GetPosition("iamserver"));
+
+    std::vector<std::string> traced;
+
+    for (const auto& event : mTrace.GetEvents()) {
+        traced.push_back(event.mName);
+    }
+
+    EXPECT_THAT(traced, UnorderedElementsAre("database", "certhandler", "nodeinfoprovider", "nodemanager", "iamserver"));
+}
+
+TEST_F(InitGraphTest, IndependentComponentsRunConcurrently)
+{
+    Latch latch {2};
+    bool  firstMet = false, secondMet = false;
+
+    mGraph.Add("first", {}, [&]() { firstMet = latch.ArriveAndWait(); });
+    mGraph.Add("second", {}, [&]() { secondMet = latch.ArriveAndWait(); });
+
+    ASSERT_NO_THROW(mGraph.Run());
+
+    EXPECT_TRUE(firstMet);
+    EXPECT_TRUE(secondMet);
+}
+
+TEST_F(InitGraphTest, SerialModeRunsComponentsOneByOneInAddingOrder)
+{
+    mGraph.Add("database", {}, mRecorder.Record("database"));
+    mGraph.Add("nodeinfoprovider", {}, mRecorder.Record("nodeinfoprovider"));
+    mGraph.Add("identifier", {}, mRecorder.Record("identifier"));
+    mGraph.Add("certhandler", {"database"}, mRecorder.Record("certhandler"));
+
+    ASSERT_NO_THROW(mGraph.Run(true));
+
+    EXPECT_THAT(mRecorder.GetOrder(), ElementsAre("database", "nodeinfoprovider", "identifier", "certhandler"));
+    EXPECT_EQ(mRecorder.GetMaxRunning(), 1);
+}
+
+TEST_F(InitGraphTest, NoComponentsAreStartedAfterFailure)
+{
+    mGraph.Add("database", {}, mRecorder.Record("database"));
+    mGraph.Add("identifier", {}, []() { throw std::runtime_error("identifier failed"); });
+    mGraph.Add("nodeinfoprovider", {}, mRecorder.Record("nodeinfoprovider"));
+    mGraph.Add("certhandler", {"database"}, mRecorder.Record("certhandler"));
+
+    EXPECT_THROW(mGraph.Run(true), std::runtime_error);
+
+    EXPECT_THAT(mRecorder.GetOrder(), ElementsAre("database"));
+}
+
+TEST_F(InitGraphTest, RunningComponentsAreWaitedForOnFailure)
+{
+    Latch             latch {2};
+    std::atomic<bool> slowDone = false;
+
+    mGraph.Add("slow", {}, [&]() {
+        latch.ArriveAndWait();
+
+        slowDone = true;
+    });
+    mGraph.Add("failed", {}, [&]() {
+        latch.ArriveAndWait();
+
+        throw std::runtime_error("component failed");
+    });
+    mGraph.Add("dependent", {"failed"}, mRecorder.Record("dependent"));
+
+    EXPECT_THROW(mGraph.Run(), std::runtime_error);
+
+    EXPECT_TRUE(slowDone);
+    EXPECT_TRUE(mRecorder.GetOrder().empty());
+}
+
+TEST_F(InitGraphTest, UnknownDependencyIsRejected)
+{
+    mGraph.Add("database", {}, mRecorder.Record("database"));
+
+    EXPECT_THROW(mGraph.Add("certhandler", {"database", "cryptoprovider"}, mRecorder.Record("certhandler")),
+        std::exception);
+
+    ASSERT_NO_THROW(mGraph.Run());
+
+    EXPECT_THAT(mRecorder.GetOrder(), ElementsAre("database"));
+}
+
+TEST_F(InitGraphTest, ComponentsSharingDatabaseInitConcurrently)
+{
+    constexpr auto cCertCount   = 50;
+    constexpr auto cNodeCount   = 4;
+    constexpr auto cUpdateCount = 25;
+
+    const auto               config = CreateDatabaseConfig();
+    database::Database       database;
+    nodemanager::NodeManager nodeManager;
+
+    mGraph.Add("database", {}, [&]() {
+        auto err = database.Init(config);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't initialize database");
+    });
+
+    // cert modules store certificates in the database while node manager stores node infos
+    mGraph.Add("certmodules", {"database"}, [&]() {
+        auto certsInfo = std::make_unique<StaticArray<certhandler::CertInfo, cCertCount>>();
+
+        for (auto i = 0; i < cCertCount; i++) {
+            const auto            serial = "serial" + std::to_string(i);
+            certhandler::CertInfo certInfo;
+
+            certInfo.mIssuer  = Array<uint8_t>(reinterpret_cast<const uint8_t*>("issuer"), sizeof("issuer"));
+            certInfo.mSerial  = Array<uint8_t>(reinterpret_cast<const uint8_t*>(serial.c_str()), serial.size() + 1);
+            certInfo.mCertURL = ("certURL" + std::to_string(i)).c_str();
+            certInfo.mKeyURL  = ("keyURL" + std::to_string(i)).c_str();
+
+            auto err = database.AddCertInfo("iam", certInfo);
+            AOS_ERROR_CHECK_AND_THROW(err, "can't add cert info");
+
+            certsInfo->Clear();
+
+            err = database.GetCertsInfo("iam", *certsInfo);
+            AOS_ERROR_CHECK_AND_THROW(err, "can't get certs info");
+        }
+    });
+
+    mGraph.Add("nodemanager", {"database"}, [&]() {
+        auto err = nodeManager.Init(database);
+        AOS_ERROR_CHECK_AND_THROW(err, "can't initialize node manager");
+
+        for (auto i = 0; i < cUpdateCount; i++) {
+            NodeInfo nodeInfo;
+
+            nodeInfo.mNodeID = ("node" + std::to_string(i % cNodeCount)).c_str();
+            nodeInfo.mName   = ("update" + std::to_string(i)).c_str();
+
+            err = nodeManager.SetNodeInfo(nodeInfo);
+            AOS_ERROR_CHECK_AND_THROW(err, "can't set node info");
+        }
+    });
+
+    ASSERT_NO_THROW(mGraph.Run());
+
+    auto certsInfo = std::make_unique<StaticArray<certhandler::CertInfo, cCertCount>>();
+
+    ASSERT_TRUE(database.GetCertsInfo("iam", *certsInfo).IsNone());
+    EXPECT_EQ(certsInfo->Size(), cCertCount);
+
+    StaticArray<StaticString<cNodeIDLen>, cMaxNumNodes> nodeIDs;
+
+    ASSERT_TRUE(database.GetAllNodeIds(nodeIDs).IsNone());
+    EXPECT_EQ(nodeIDs.Size(), cNodeCount);
+}
+
+} // namespace aos::iam::app
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include <gmock/gmock.h>
+
+#include <Poco/JSON/Array.h>
+#include <Poco/JSON/Object.h>
+#include <Poco/JSON/Parser.h>
+
+#include "app/startuptrace.hpp"
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace aos::iam::app {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+constexpr auto cTraceFile = "startuptrace_test.json";
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class StartupTraceTest : public Test {
+protected:
+    void TearDown() override { std::filesystem::remove(cTraceFile); }
+
+    StartupTrace mTrace;
+};
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST_F(StartupTraceTest, EventsAreOrderedByStartTime)
+{
+    const auto start = StartupTrace::Clock::now();
+
+    mTrace.AddEvent("certhandler", start + 20ms, start + 30ms);
+    mTrace.AddEvent("database", start, start + 20ms);
+    mTrace.AddEvent("nodeinfoprovider", start + 5ms, start + 10ms);
+
+    auto events = mTrace.GetEvents();
+
+    ASSERT_EQ(events.size(), 3);
+
+    EXPECT_EQ(events[0].mName, "database");
+    EXPECT_EQ(events[0].mDuration, 20ms);
+    EXPECT_EQ(events[1].mName, "nodeinfoprovider");
+    EXPECT_EQ(events[1].mDuration, 5ms);
+    EXPECT_EQ(events[2].mName, "certhandler");
+    EXPECT_EQ(events[2].mDuration, 10ms);
+}
+
+TEST_F(StartupTraceTest, RunRecordsPhaseAndReturnsResult)
+{
+    auto result = mTrace.Run("config", []() { return 42; });
+
+    EXPECT_EQ(result, 42);
+
+    auto events = mTrace.GetEvents();
+
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0].mName, "config");
+}
+
+TEST_F(StartupTraceTest, EventsOfDifferentThreadsHaveDifferentThreadIndexes)
+{
+    const auto start = StartupTrace::Clock::now();
+
+    mTrace.AddEvent("main.first", start, start + 1ms);
+
+    std::thread thread([&]() { mTrace.AddEvent("worker", start + 1ms, start + 2ms); });
+
+    thread.join();
+
+    mTrace.AddEvent("main.second", start + 2ms, start + 3ms);
+
+    auto events = mTrace.GetEvents();
+
+    ASSERT_EQ(events.size(), 3);
+
+    EXPECT_EQ(events[0].mThreadIndex, events[2].mThreadIndex);
+    EXPECT_NE(events[0].mThreadIndex, events[1].mThreadIndex);
+}
+
+TEST_F(StartupTraceTest, SummaryContainsSlowestAndAllPhases)
+{
+    const auto start = StartupTrace::Clock::now();
+
+    mTrace.AddEvent("database", start, start + 10ms);
+    mTrace.AddEvent("certhandler", start + 10ms, start + 40ms);
+    mTrace.AddEvent("iamserver", start + 40ms, start + 45ms);
+
+    auto summary = mTrace.Summary();
+
+    EXPECT_THAT(summary, StartsWith("total="));
+    EXPECT_THAT(summary, HasSubstr("slowest=certhandler"));
+    EXPECT_THAT(summary, HasSubstr("phases=[database:10ms, certhandler:30ms, iamserver:5ms]"));
+}
+
+TEST_F(StartupTraceTest, SummaryOfEmptyTrace)
+{
+    auto summary = mTrace.Summary();
+
+    EXPECT_THAT(summary, StartsWith("total="));
+    EXPECT_THAT(summary, Not(HasSubstr("slowest=")));
+    EXPECT_THAT(summary, EndsWith("phases=[]"));
+}
+
+TEST_F(StartupTraceTest, DumpChromeTrace)
+{
+    const auto start = StartupTrace::Clock::now();
+
+    mTrace.AddEvent("database", start, start + 10ms);
+    mTrace.AddEvent("certhandler", start + 10ms, start + 40ms);
+
+    ASSERT_TRUE(mTrace.DumpChromeTrace(cTraceFile).IsNone());
+
+    std::ifstream file(cTraceFile);
+
+    ASSERT_TRUE(file);
+
+    auto trace       = Poco::JSON::Parser().parse(file).extract<Poco::JSON::Object::Ptr>();
+    auto traceEvents = trace->getArray("traceEvents");
+
+    ASSERT_FALSE(traceEvents.isNull());
+    ASSERT_EQ(traceEvents->size(), 2);
+
+    EXPECT_EQ(trace->getValue<std::string>("displayTimeUnit"), "ms");
+
+    auto database    = traceEvents->getObject(0);
+    auto certhandler = traceEvents->getObject(1);
+
+    EXPECT_EQ(database->getValue<std::string>("name"), "database");
+    EXPECT_EQ(database->getValue<std::string>("ph"), "X");
+    EXPECT_EQ(database->getValue<std::string>("cat"), "startup");
+    EXPECT_EQ(database->getValue<int64_t>("dur"), 10000);
+
+    EXPECT_EQ(certhandler->getValue<std::string>("name"), "certhandler");
+    EXPECT_EQ(certhandler->getValue<int64_t>("dur"), 30000);
+    EXPECT_EQ(certhandler->getValue<int64_t>("ts") - database->getValue<int64_t>("ts"), 10000);
+}
+
+TEST_F(StartupTraceTest, DumpChromeTraceFailsOnInvalidPath)
+{
+    EXPECT_FALSE(mTrace.DumpChromeTrace("/nonexistent/startuptrace_test.json").IsNone());
+}
+
+} // namespace aos::iam::app
@@ -54,10 +54,23 @@ public:
                         "Name": "name3",
                         "Path": "path3"
                     }
-                ]
+                ],
+                "PartitionProbeTimeout": "2s",
+                "CGroupRootPath": "/sys/fs/cgroup/aos",
+                "ResourceSampler": {
+                    "Interval": "5s",
+                    "SamplePartitions": false
+                }
             },
             "IAMPublicServerURL": "localhost:8090",
             "IAMProtectedServerURL": "localhost:8089",
+            "IAMPublicServerSocket": "/run/aos/iam.sock",
+            "SlowRPCThreshold": "2s",
+            "GRPCServer": {
+                "MaxThreads": 16,
+                "NumCQs": 2,
+                "MaxMessageSize": 1048576
+            },
             "CACert": "/etc/ssl/certs/rootCA.crt",
             "CertStorage": "/var/aos/crypt/iam/",
             "WorkingDir": "/var/aos/iamanager",
@@ -72,7 +85,9 @@ public:
                 "/bin/sh",
                 "/var/aos/encrypt.sh"
             ],
+            "ProvisioningCmdTimeout": "2m",
             "EnablePermissionsHandler": true,
+            "MetricsServerURL": "localhost:9102",
             "CertModules":[{
                 "ID": "id1",
                 "Plugin": "test1",
@@ -161,12 +176,29 @@ TEST_F(ConfigTest, ParseConfig)
     EXPECT_EQ(config.mNodeInfo.mPartitions[2].mPath, "path3");
     ASSERT_TRUE(config.mNodeInfo.mPartitions[2].mTypes.empty());
 
+    EXPECT_EQ(config.mNodeInfo.mPartitionProbeTimeout, 2 * Time::cSeconds);
+    EXPECT_EQ(config.mNodeInfo.mStatPath, "/proc/stat");
+    EXPECT_EQ(config.mNodeInfo.mProcCGroupPath, "/proc/self/cgroup");
+    EXPECT_EQ(config.mNodeInfo.mCGroupRootPath, "/sys/fs/cgroup/aos");
+    EXPECT_EQ(config.mNodeInfo.mResourceSampler.mInterval, 5 * Time::cSeconds);
+    EXPECT_TRUE(config.mNodeInfo.mResourceSampler.mSampleCPU);
+    EXPECT_TRUE(config.mNodeInfo.mResourceSampler.mSampleRAM);
+    EXPECT_FALSE(config.mNodeInfo.mResourceSampler.mSamplePartitions);
+
     EXPECT_EQ(config.mIAMServer.mIAMPublicServerURL, "localhost:8090");
     EXPECT_EQ(config.mIAMServer.mIAMProtectedServerURL, "localhost:8089");
+    EXPECT_EQ(config.mIAMServer.mIAMPublicServerSocket, "/run/aos/iam.sock");
+    EXPECT_EQ(config.mIAMServer.mIAMPublicServerSocketMode, 0660);
+    EXPECT_EQ(config.mIAMServer.mSlowRPCThreshold, 2 * Time::cSeconds);
+    EXPECT_EQ(config.mIAMServer.mGRPCServer.mMaxThreads, 16);
+    EXPECT_EQ(config.mIAMServer.mGRPCServer.mNumCQs, 2);
+    EXPECT_EQ(config.mIAMServer.mGRPCServer.mMaxMessageSize, 1048576);
+    EXPECT_EQ(config.mIAMServer.mGRPCServer.mMaxConcurrentStreams, 0);
     EXPECT_EQ(config.mIAMServer.mCACert, "/etc/ssl/certs/rootCA.crt");
     EXPECT_EQ(config.mIAMServer.mCertStorage, "/var/aos/crypt/iam/");
     EXPECT_EQ(config.mIAMServer.mFinishProvisioningCmdArgs, std::vector<std::string> {"/var/aos/finish.sh"});
     EXPECT_EQ(config.mIAMServer.mDiskEncryptionCmdArgs, std::vector<std::string>({"/bin/sh", "/var/aos/encrypt.sh"}));
+    EXPECT_EQ(config.mIAMServer.mProvisioningCmdTimeout, 120 * Time::cSeconds);
 
     EXPECT_EQ(config.mIAMClient.mCACert, "/etc/ssl/certs/rootCA.crt");
     EXPECT_EQ(config.mIAMClient.mCertStorage, "/var/aos/crypt/iam/");
@@ -177,6 +209,7 @@ TEST_F(ConfigTest, ParseConfig)
     EXPECT_EQ(config.mDatabase.mMigrationPath, "/usr/share/aos/iam/migration");
     EXPECT_EQ(config.mDatabase.mMergedMigrationPath, "/var/aos/workdirs/iam/migration");
     EXPECT_EQ(config.mEnablePermissionsHandler, true);
+    EXPECT_EQ(config.mMetricsServerURL, "localhost:9102");
 
     EXPECT_EQ(config.mCertModules.size(), 3);
 
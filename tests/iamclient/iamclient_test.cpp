@@ -5,6 +5,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <condition_variable>
+#include <mutex>
+
 #include <gmock/gmock.h>
 
 #include <google/protobuf/util/message_differencer.h>
@@ -24,6 +27,7 @@
 #include "mocks/provisionmanagermock.hpp"
 
 #include "iamclient/iamclient.hpp"
+#include "iamserver/allcerttypes.hpp"
 
 using namespace testing;
 
@@ -258,6 +262,11 @@ public:
                 } else if (incomingMsg.has_create_key_response()) {
                     const auto& response = incomingMsg.create_key_response();
 
+                    for (const auto& certTypeResponse : iamserver::GetCertTypeResponses(response)) {
+                        OnCertTypeKeyResponse(
+                            certTypeResponse.type(), certTypeResponse.csr(), certTypeResponse.error());
+                    }
+
                     OnCreateKeyResponse(response.type(), response.csr(), response.error());
                     mResponseCV.notify_all();
                 } else if (incomingMsg.has_apply_cert_response()) {
@@ -344,6 +353,19 @@ public:
         mStream->Write(request);
     }
 
+    void CreateKeyForAllCertTypesRequest(const std::string& id, const std::string& subject, const std::string& password)
+    {
+        iamanager::v5::IAMIncomingMessages request;
+
+        request.mutable_create_key_request()->set_node_id(id);
+        request.mutable_create_key_request()->set_subject(subject);
+        request.mutable_create_key_request()->set_password(password);
+
+        iamserver::SetAllCertTypes(*request.mutable_create_key_request());
+
+        mStream->Write(request);
+    }
+
     void ApplyCertRequest(const std::string& id, const std::string& type, const std::string& cert)
     {
         iamanager::v5::IAMIncomingMessages request;
@@ -372,6 +394,8 @@ public:
     MOCK_METHOD(void, OnResumeNodeResponse, (const ::common::v1::ErrorInfo& errorInfo));
     MOCK_METHOD(void, OnCreateKeyResponse,
         (const std::string& type, const std::string& csr, const ::common::v1::ErrorInfo& errorInfo));
+    MOCK_METHOD(void, OnCertTypeKeyResponse,
+        (const std::string& type, const std::string& csr, const ::common::v1::ErrorInfo& errorInfo));
     MOCK_METHOD(void, OnApplyCertResponse,
         (const std::string& type, const std::string& certURL, const std::string& serial,
             const ::common::v1::ErrorInfo& errorInfo));
@@ -774,6 +798,49 @@ TEST_F(IAMClientTest, CreateKey)
     EXPECT_TRUE(client->Stop().IsNone());
 }
 
+TEST_F(IAMClientTest, CreateKeyForAllCertTypes)
+{
+    // Init
+    auto [server, client] = InitTest(NodeStatusEnum::eUnprovisioned);
+    NodeInfo nodeInfo     = DefaultNodeInfo(NodeStatusEnum::eUnprovisioned);
+
+    // CreateKey for all cert types
+    provisionmanager::CertTypes types;
+    FillArray({"iam", "online", "offline"}, types);
+
+    std::mutex              mutex;
+    std::condition_variable condVar;
+    size_t                  generating = 0;
+
+    EXPECT_CALL(mProvisionManager, GetCertTypes()).WillOnce(Return(RetWithError<provisionmanager::CertTypes>(types)));
+
+    // each key is completed only when keys of all types are being generated
+    EXPECT_CALL(mProvisionManager, CreateKey(_, cSubject, cPassword, _))
+        .Times(types.Size())
+        .WillRepeatedly(Invoke([&](const String& certType, const String&, const String&, String& csr) -> Error {
+            std::unique_lock lock {mutex};
+
+            generating++;
+            condVar.notify_all();
+
+            if (!condVar.wait_for(lock, std::chrono::seconds(2), [&]() { return generating == types.Size(); })) {
+                return ErrorEnum::eTimeout;
+            }
+
+            return csr.Assign(certType.CStr());
+        }));
+
+    EXPECT_CALL(*server, OnCertTypeKeyResponse("iam", "iam", ::common::v1::ErrorInfo()));
+    EXPECT_CALL(*server, OnCertTypeKeyResponse("online", "online", ::common::v1::ErrorInfo()));
+    EXPECT_CALL(*server, OnCertTypeKeyResponse("offline", "offline", ::common::v1::ErrorInfo()));
+    EXPECT_CALL(*server, OnCreateKeyResponse("", "", ::common::v1::ErrorInfo()));
+
+    server->CreateKeyForAllCertTypesRequest(nodeInfo.mNodeID.CStr(), cSubject.CStr(), cPassword.CStr());
+    server->WaitResponse();
+
+    EXPECT_TRUE(client->Stop().IsNone());
+}
+
 TEST_F(IAMClientTest, ApplyCert)
 {
     // Init
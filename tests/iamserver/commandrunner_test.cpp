@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+
+#include <gmock/gmock.h>
+
+#include <aos/test/log.hpp>
+
+#include "iamserver/commandrunner.hpp"
+
+using namespace testing;
+
+namespace aos::iam::iamserver {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+constexpr auto cCommandTimeout = std::chrono::seconds(10);
+constexpr auto cShortTimeout   = std::chrono::milliseconds(200);
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class CommandRunnerTest : public Test {
+protected:
+    void SetUp() override { test::InitLog(); }
+};
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST_F(CommandRunnerTest, ExecCommandSucceeds)
+{
+    EXPECT_TRUE(ExecCommand("Empty", {}, cCommandTimeout).IsNone());
+    EXPECT_TRUE(ExecCommand("Echo", {"/bin/sh", "-c", "echo line1; echo line2 >&2"}, cCommandTimeout).IsNone());
+}
+
+TEST_F(CommandRunnerTest, ExecCommandFails)
+{
+    EXPECT_TRUE(ExecCommand("Exit", {"/bin/sh", "-c", "echo failed; exit 3"}, cCommandTimeout).Is(ErrorEnum::eFailed));
+    EXPECT_FALSE(ExecCommand("Not exist", {"/not/existing/command"}, cCommandTimeout).IsNone());
+}
+
+TEST_F(CommandRunnerTest, ZeroTimeoutMeansNoTimeout)
+{
+    EXPECT_TRUE(ExecCommand("Sleep", {"/bin/sh", "-c", "sleep 0.5"}, std::chrono::nanoseconds::zero()).IsNone());
+}
+
+TEST_F(CommandRunnerTest, ExecCommandTimeoutKillsProcessGroup)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    // background child keeps the output pipe open, it should be killed together with the command
+    auto err = ExecCommand("Sleep", {"/bin/sh", "-c", "sleep 10 & sleep 10"}, cShortTimeout);
+
+    EXPECT_TRUE(err.Is(ErrorEnum::eTimeout));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+}
+
+TEST_F(CommandRunnerTest, CallDeadlineLimitsTimeout)
+{
+    EXPECT_FALSE(CallDeadlineScope::Get().has_value());
+
+    {
+        CallDeadlineScope deadlineScope {std::chrono::system_clock::now() + cShortTimeout};
+
+        ASSERT_TRUE(CallDeadlineScope::Get().has_value());
+
+        const auto start = std::chrono::steady_clock::now();
+
+        EXPECT_TRUE(ExecCommand("Sleep", {"sleep", "10"}, cCommandTimeout).Is(ErrorEnum::eTimeout));
+        EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    }
+
+    EXPECT_FALSE(CallDeadlineScope::Get().has_value());
+
+    CallDeadlineScope infiniteScope {std::chrono::system_clock::time_point::max()};
+
+    EXPECT_FALSE(CallDeadlineScope::Get().has_value());
+}
+
+} // namespace aos::iam::iamserver
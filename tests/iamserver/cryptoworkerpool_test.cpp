@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <thread>
+
+#include <gmock/gmock.h>
+
+#include <aos/test/log.hpp>
+
+#include "iamserver/cryptoworkerpool.hpp"
+
+using namespace testing;
+
+namespace aos::iam::iamserver {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+constexpr auto cWaitTimeout        = std::chrono::seconds(5);
+constexpr auto cKeyGenerationTime  = std::chrono::milliseconds(20);
+constexpr auto cBenchmarkCertTypes = {"online", "offline", "iam", "sm", "um"};
+constexpr auto cBenchmarkKeys      = 8;
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class CryptoWorkerPoolTest : public Test {
+protected:
+    void SetUp() override { test::InitLog(); }
+};
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST_F(CryptoWorkerPoolTest, TasksWithSameKeyAreOrdered)
+{
+    CryptoWorkerPool pool {4, 64};
+
+    pool.Start();
+
+    std::mutex         mutex;
+    std::vector<int>   order;
+    std::atomic_int    running {0};
+    std::atomic_bool   overlapped {false};
+    std::promise<void> done;
+
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TRUE(pool.Post("iam",
+                            [&, i](bool canceled) {
+                                EXPECT_FALSE(canceled);
+
+                                if (running.fetch_add(1) != 0) {
+                                    overlapped = true;
+                                }
+
+                                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+                                running--;
+
+                                std::lock_guard lock {mutex};
+
+                                order.push_back(i);
+
+                                if (order.size() == 10) {
+                                    done.set_value();
+                                }
+                            })
+                        .IsNone());
+    }
+
+    ASSERT_EQ(done.get_future().wait_for(cWaitTimeout), std::future_status::ready);
+
+    EXPECT_FALSE(overlapped);
+    EXPECT_THAT(order, ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+
+    pool.Stop();
+}
+
+TEST_F(CryptoWorkerPoolTest, TasksWithDifferentKeysRunInParallel)
+{
+    CryptoWorkerPool pool {2, 64};
+
+    pool.Start();
+
+    std::promise<void> firstStarted, secondStarted;
+
+    ASSERT_TRUE(pool.Post("iam",
+                        [&](bool) {
+                            firstStarted.set_value();
+                            secondStarted.get_future().wait_for(cWaitTimeout);
+                        })
+                    .IsNone());
+
+    ASSERT_EQ(firstStarted.get_future().wait_for(cWaitTimeout), std::future_status::ready);
+
+    ASSERT_TRUE(pool.Post("sm", [&](bool) { secondStarted.set_value(); }).IsNone());
+
+    pool.Stop();
+}
+
+TEST_F(CryptoWorkerPoolTest, QueueIsBoundedAndCanceledOnStop)
+{
+    CryptoWorkerPool pool {1, 3};
+
+    EXPECT_TRUE(pool.Post("iam", [](bool) {}).Is(ErrorEnum::eWrongState));
+
+    pool.Start();
+
+    std::promise<void> blocked, release;
+    std::atomic_int    canceledCount {0};
+
+    ASSERT_TRUE(pool.Post("iam",
+                        [&](bool) {
+                            blocked.set_value();
+                            release.get_future().wait();
+                        })
+                    .IsNone());
+
+    ASSERT_EQ(blocked.get_future().wait_for(cWaitTimeout), std::future_status::ready);
+
+    auto cancelable = [&](bool canceled) {
+        if (canceled) {
+            canceledCount++;
+        }
+    };
+
+    EXPECT_TRUE(pool.Post("iam", cancelable).IsNone());
+    EXPECT_TRUE(pool.Post("sm", cancelable).IsNone());
+    EXPECT_TRUE(pool.Post("um", cancelable).Is(ErrorEnum::eNoMemory));
+
+    auto stopResult = std::async(std::launch::async, [&]() { pool.Stop(); });
+
+    // queued tasks are canceled without waiting for the running one
+    while (canceledCount != 2) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    release.set_value();
+
+    ASSERT_EQ(stopResult.wait_for(cWaitTimeout), std::future_status::ready);
+
+    pool.Start();
+
+    std::promise<void> restarted;
+
+    ASSERT_TRUE(pool.Post("iam", [&](bool) { restarted.set_value(); }).IsNone());
+    EXPECT_EQ(restarted.get_future().wait_for(cWaitTimeout), std::future_status::ready);
+}
+
+TEST_F(CryptoWorkerPoolTest, DISABLED_Benchmark)
+{
+    auto measure = [](size_t numWorkers) {
+        CryptoWorkerPool pool {numWorkers, 64};
+
+        pool.Start();
+
+        std::atomic_int    remaining {static_cast<int>(cBenchmarkCertTypes.size()) * cBenchmarkKeys};
+        std::promise<void> done;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < cBenchmarkKeys; i++) {
+            for (const auto& certType : cBenchmarkCertTypes) {
+                EXPECT_TRUE(pool.Post(certType,
+                                    [&](bool) {
+                                        // simulates key generation on HSM
+                                        std::this_thread::sleep_for(cKeyGenerationTime);
+
+                                        if (--remaining == 0) {
+                                            done.set_value();
+                                        }
+                                    })
+                                .IsNone());
+            }
+        }
+
+        done.get_future().wait();
+
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        pool.Stop();
+
+        return cBenchmarkCertTypes.size() * cBenchmarkKeys / elapsed;
+    };
+
+    for (auto numWorkers : {1, 2, 4, 8}) {
+        std::cout << "CreateKey throughput: workers=" << numWorkers << ", keys/s=" << measure(numWorkers) << std::endl;
+    }
+}
+
+} // namespace aos::iam::iamserver
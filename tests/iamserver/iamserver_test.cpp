@@ -10,7 +10,18 @@
 #define OPENSSL_SUPPRESS_DEPRECATED
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
 #include <gmock/gmock.h>
+#include <grpc/grpc_security.h>
 #include <openssl/engine.h>
 
 #include <aos/test/log.hpp>
@@ -71,11 +82,54 @@ protected:
         return T::NewStub(channel);
     }
 
+    std::string GetServerCert()
+    {
+        grpc::ChannelArguments args;
+
+        // unique arg prevents channel reuse, so every call makes a new handshake
+        args.SetInt("iamserver.test.handshake", mHandshakeCount++);
+
+        auto stub = iamanager::IAMVersionService::NewStub(grpc::CreateCustomChannel(mServerConfig.mIAMPublicServerURL,
+            common::utils::GetTLSClientCredentials(GetClientConfig().mCACert.c_str()), args));
+
+        grpc::ClientContext   context;
+        iamanager::APIVersion response;
+
+        if (!stub->GetAPIVersion(&context, {}, &response).ok()) {
+            return {};
+        }
+
+        auto certs = context.auth_context()->FindPropertyValues(GRPC_X509_PEM_CERT_PROPERTY_NAME);
+        if (certs.empty()) {
+            return {};
+        }
+
+        return std::string(certs.front().data(), certs.front().size());
+    }
+
+    bool WaitServerCertChanged(const std::string& oldCert)
+    {
+        constexpr auto cWaitTimeout = std::chrono::seconds(5);
+
+        auto deadline = std::chrono::steady_clock::now() + cWaitTimeout;
+
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (auto cert = GetServerCert(); !cert.empty() && cert != oldCert) {
+                return true;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+
+        return false;
+    }
+
     IAMServer               mServer;
     certhandler::CertInfo   mClientInfo;
     certhandler::CertInfo   mServerInfo;
     config::IAMServerConfig mServerConfig;
     config::IAMClientConfig mClientConfig;
+    int                     mHandshakeCount = 0;
 
     certhandler::CertHandler      mCertHandler;
     crypto::DefaultCryptoProvider mCryptoProvider;
@@ -479,4 +533,421 @@ TEST_F(IAMServerTest, NodesServiceIsNotImplementedOnSecondaryNode)
     ASSERT_TRUE(mServer.Stop().IsNone());
 }
 
+TEST_F(IAMServerTest, ServerThreadLimitHoldsUnderLoad)
+{
+    constexpr auto cMaxThreads = 8;
+    constexpr auto cNumClients = 64;
+
+    std::atomic_int activeCalls = 0, maxActiveCalls = 0;
+
+    mServerConfig.mGRPCServer.mMaxThreads = cMaxThreads;
+    mServerConfig.mGRPCServer.mNumCQs     = 1;
+
+    EXPECT_CALL(mPermHandler, GetPermissions).WillRepeatedly(Invoke([&](auto&&...) {
+        auto active = ++activeCalls;
+        auto max    = maxActiveCalls.load();
+
+        while (active > max && !maxActiveCalls.compare_exchange_weak(max, active)) { }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        activeCalls--;
+
+        return ErrorEnum::eNone;
+    }));
+
+    auto err = mServer.Init(mServerConfig, mCertHandler, mIdentHandler, mPermHandler, mCertLoader, mCryptoProvider,
+        mNodeInfoProvider, mNodeManager, mCertProvider, mProvisionManager, cProvisioningModeOn);
+
+    ASSERT_TRUE(err.IsNone()) << err.Message();
+    ASSERT_TRUE(mServer.Start().IsNone());
+
+    std::vector<std::thread>      clients;
+    std::vector<grpc::StatusCode> codes(cNumClients, grpc::StatusCode::UNKNOWN);
+
+    for (auto i = 0; i < cNumClients; i++) {
+        clients.emplace_back([&, i]() {
+            auto stub = CreateCustomStub<iamproto::IAMPublicPermissionsService>(
+                mServerConfig.mIAMPublicServerURL, cProvisioningModeOn);
+
+            grpc::ClientContext           context;
+            iamproto::PermissionsRequest  request;
+            iamproto::PermissionsResponse response;
+
+            codes[i] = stub->GetPermissions(&context, request, &response).error_code();
+        });
+    }
+
+    for (auto& client : clients) {
+        client.join();
+    }
+
+    ASSERT_TRUE(mServer.Stop().IsNone());
+
+    // calls over the thread quota are rejected instead of spawning more threads
+    EXPECT_LE(maxActiveCalls, cMaxThreads);
+    EXPECT_TRUE(std::all_of(codes.begin(), codes.end(), [](grpc::StatusCode code) {
+        return code == grpc::StatusCode::OK || code == grpc::StatusCode::RESOURCE_EXHAUSTED;
+    }));
+    EXPECT_TRUE(std::any_of(codes.begin(), codes.end(), [](grpc::StatusCode code) {
+        return code == grpc::StatusCode::OK;
+    }));
+}
+
+TEST_F(IAMServerTest, ServerMaxMessageSizeIsEnforced)
+{
+    constexpr auto cMaxMessageSize = 1024;
+
+    mServerConfig.mGRPCServer.mMaxMessageSize = cMaxMessageSize;
+
+    EXPECT_CALL(mPermHandler, GetPermissions).Times(0);
+
+    auto err = mServer.Init(mServerConfig, mCertHandler, mIdentHandler, mPermHandler, mCertLoader, mCryptoProvider,
+        mNodeInfoProvider, mNodeManager, mCertProvider, mProvisionManager, cProvisioningModeOn);
+
+    ASSERT_TRUE(err.IsNone()) << err.Message();
+    ASSERT_TRUE(mServer.Start().IsNone());
+
+    auto stub = CreateCustomStub<iamproto::IAMPublicPermissionsService>(
+        mServerConfig.mIAMPublicServerURL, cProvisioningModeOn);
+
+    EXPECT_NE(stub, nullptr) << "Failed to create a stub";
+
+    grpc::ClientContext           context;
+    iamproto::PermissionsRequest  request;
+    iamproto::PermissionsResponse response;
+
+    request.set_secret(std::string(cMaxMessageSize * 2, 'x'));
+
+    auto status = stub->GetPermissions(&context, request, &response);
+
+    EXPECT_EQ(status.error_code(), grpc::StatusCode::RESOURCE_EXHAUSTED)
+        << "Oversized message must be rejected: code = " << status.error_code()
+        << ", message = " << status.error_message();
+
+    ASSERT_TRUE(mServer.Stop().IsNone());
+}
+
+TEST_F(IAMServerTest, PublicServerListensOnUnixSocket)
+{
+    constexpr auto cSocketPath = "/tmp/aos-iamserver-test.sock";
+    constexpr auto cSocketMode = 0600;
+
+    mServerConfig.mIAMPublicServerSocket     = cSocketPath;
+    mServerConfig.mIAMPublicServerSocketMode = cSocketMode;
+
+    auto err = mServer.Init(mServerConfig, mCertHandler, mIdentHandler, mPermHandler, mCertLoader, mCryptoProvider,
+        mNodeInfoProvider, mNodeManager, mCertProvider, mProvisionManager, cProvisioningModeOff);
+
+    ASSERT_TRUE(err.IsNone()) << err.Message();
+    ASSERT_TRUE(mServer.Start().IsNone());
+
+    struct stat socketStat { };
+
+    ASSERT_EQ(stat(cSocketPath, &socketStat), 0);
+    EXPECT_TRUE(S_ISSOCK(socketStat.st_mode));
+    EXPECT_EQ(socketStat.st_mode & 0777, cSocketMode);
+
+    auto stub = CreateCustomStub<iamanager::IAMVersionService>(std::string("unix:") + cSocketPath, true);
+
+    EXPECT_NE(stub, nullptr) << "Failed to create a stub";
+
+    grpc::ClientContext   context;
+    iamanager::APIVersion response;
+
+    auto status = stub->GetAPIVersion(&context, {}, &response);
+
+    EXPECT_TRUE(status.ok()) << "GetAPIVersion over unix socket failed: code = " << status.error_code()
+                             << ", message = " << status.error_message();
+
+    ASSERT_TRUE(mServer.Stop().IsNone());
+}
+
+TEST_F(IAMServerTest, StartFailsIfLocalSocketCantBeCreated)
+{
+    mServerConfig.mIAMPublicServerSocket = "/nonexistent/aos-iamserver-test.sock";
+
+    auto err = mServer.Init(mServerConfig, mCertHandler, mIdentHandler, mPermHandler, mCertLoader, mCryptoProvider,
+        mNodeInfoProvider, mNodeManager, mCertProvider, mProvisionManager, cProvisioningModeOff);
+
+    ASSERT_TRUE(err.IsNone()) << err.Message();
+    EXPECT_FALSE(mServer.Start().IsNone());
+
+    // secure servers are not started without the local socket
+    EXPECT_TRUE(GetServerCert().empty());
+}
+
+TEST_F(IAMServerTest, LocalSocketIsServedBeforeCertificatesReady)
+{
+    constexpr auto cSocketPath = "/tmp/aos-iamserver-staged.sock";
+
+    mServerConfig.mIAMPublicServerSocket = cSocketPath;
+
+    mServer.SetComponentPending(ServerComponent::eCertificates);
+
+    auto err = mServer.Init(mServerConfig, mCertHandler, mIdentHandler, mPermHandler, mCertLoader, mCryptoProvider,
+        mNodeInfoProvider, mNodeManager, mCertProvider, mProvisionManager, cProvisioningModeOff);
+
+    ASSERT_TRUE(err.IsNone()) << err.Message();
+    ASSERT_TRUE(mServer.Start().IsNone());
+
+    auto localStub = CreateCustomStub<iamanager::IAMVersionService>(std::string("unix:") + cSocketPath, true);
+
+    ASSERT_NE(localStub, nullptr) << "Failed to create a stub";
+
+    {
+        grpc::ClientContext   context;
+        iamanager::APIVersion response;
+
+        auto status = localStub->GetAPIVersion(&context, {}, &response);
+
+        EXPECT_TRUE(status.ok()) << "GetAPIVersion before certificates failed: code = " << status.error_code()
+                                 << ", message = " << status.error_message();
+    }
+
+    auto certStub = CreateCustomStub<iamproto::IAMPublicService>(std::string("unix:") + cSocketPath, true);
+
+    ASSERT_NE(certStub, nullptr) << "Failed to create a stub";
+
+    {
+        grpc::ClientContext context;
+        iamproto::CertInfo  response;
+
+        EXPECT_EQ(certStub->GetCert(&context, {}, &response).error_code(), grpc::StatusCode::UNAVAILABLE);
+    }
+
+    ASSERT_TRUE(mServer.SetComponentReady(ServerComponent::eCertificates).IsNone());
+
+    auto tlsStub = CreateCustomStub<iamanager::IAMVersionService>(mServerConfig.mIAMPublicServerURL);
+
+    ASSERT_NE(tlsStub, nullptr) << "Failed to create a stub";
+
+    grpc::ClientContext   context;
+    iamanager::APIVersion response;
+
+    auto status = tlsStub->GetAPIVersion(&context, {}, &response);
+
+    EXPECT_TRUE(status.ok()) << "GetAPIVersion after certificates failed: code = " << status.error_code()
+                             << ", message = " << status.error_message();
+
+    // local socket is kept when secure servers are started
+    struct stat socketStat { };
+
+    ASSERT_EQ(stat(cSocketPath, &socketStat), 0) << "Local socket must be kept after certificates ready";
+
+    grpc::ClientContext   localContext;
+    iamanager::APIVersion localResponse;
+
+    status = localStub->GetAPIVersion(&localContext, {}, &localResponse);
+
+    EXPECT_TRUE(status.ok()) << "GetAPIVersion over unix socket after certificates failed: code = "
+                             << status.error_code() << ", message = " << status.error_message();
+
+    ASSERT_TRUE(mServer.Stop().IsNone());
+}
+
+// Run with --gtest_also_run_disabled_tests to compare local socket and TLS TCP latency.
+TEST_F(IAMServerTest, DISABLED_UnixSocketBenchmark)
+{
+    constexpr auto cSocketPath = "/tmp/aos-iamserver-bench.sock";
+    constexpr auto cIterations = 1000;
+
+    mServerConfig.mIAMPublicServerSocket     = cSocketPath;
+    mServerConfig.mIAMPublicServerSocketMode = 0600;
+
+    auto err = mServer.Init(mServerConfig, mCertHandler, mIdentHandler, mPermHandler, mCertLoader, mCryptoProvider,
+        mNodeInfoProvider, mNodeManager, mCertProvider, mProvisionManager, cProvisioningModeOff);
+
+    ASSERT_TRUE(err.IsNone()) << err.Message();
+    ASSERT_TRUE(mServer.Start().IsNone());
+
+    auto measure = [](iamanager::IAMVersionService::Stub& stub) {
+        auto start = std::chrono::steady_clock::now();
+
+        for (auto i = 0; i < cIterations; i++) {
+            grpc::ClientContext   context;
+            iamanager::APIVersion response;
+
+            EXPECT_TRUE(stub.GetAPIVersion(&context, {}, &response).ok());
+        }
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    };
+
+    auto unixStub = CreateCustomStub<iamanager::IAMVersionService>(std::string("unix:") + cSocketPath, true);
+    auto tlsStub  = CreateCustomStub<iamanager::IAMVersionService>(mServerConfig.mIAMPublicServerURL);
+
+    ASSERT_NE(unixStub, nullptr);
+    ASSERT_NE(tlsStub, nullptr);
+
+    std::cout << "Unix socket: " << measure(*unixStub).count() << " us per " << cIterations << " calls" << std::endl;
+    std::cout << "TLS TCP: " << measure(*tlsStub).count() << " us per " << cIterations << " calls" << std::endl;
+
+    ASSERT_TRUE(mServer.Stop().IsNone());
+}
+
+TEST_F(IAMServerTest, CertRotationsKeepEstablishedStreams)
+{
+    auto err = mServer.Init(mServerConfig, mCertHandler, mIdentHandler, mPermHandler, mCertLoader, mCryptoProvider,
+        mNodeInfoProvider, mNodeManager, mCertProvider, mProvisionManager, cProvisioningModeOff);
+
+    ASSERT_TRUE(err.IsNone()) << err.Message();
+    ASSERT_TRUE(mServer.Start().IsNone());
+
+    auto oldCert = GetServerCert();
+
+    ASSERT_FALSE(oldCert.empty()) << "Can't get server certificate";
+
+    auto nodesStub = CreateCustomStub<iamproto::IAMPublicNodesService>(mServerConfig.mIAMPublicServerURL);
+
+    ASSERT_NE(nodesStub, nullptr) << "Failed to create a stub";
+
+    grpc::ClientContext nodesContext;
+
+    auto stream = nodesStub->SubscribeNodeChanged(&nodesContext, {});
+
+    ASSERT_NE(stream, nullptr) << "Failed to create client stream";
+
+    NodeInfo           nodeInfo;
+    iamproto::NodeInfo response;
+
+    // first notification makes sure the stream is established before rotation
+    nodeInfo.mNodeID = "node0";
+
+    mServer.OnNodeInfoChange(nodeInfo);
+
+    ASSERT_TRUE(stream->Read(&response));
+    EXPECT_EQ(response.node_id(), "node0");
+
+    // each new server certificate triggers credentials reload, the stream is kept on the same server
+    for (const auto serial : {0x3333555, 0x3333666}) {
+        certhandler::CertInfo newServerInfo;
+
+        ApplyCertificate("server", "localhost", CERTIFICATES_IAM_DIR "/server_int.key",
+            CERTIFICATES_IAM_DIR "/server_int.cer", serial, newServerInfo);
+
+        EXPECT_TRUE(WaitServerCertChanged(oldCert)) << "New handshake must get the new certificate";
+
+        oldCert = GetServerCert();
+
+        nodeInfo.mNodeID = ("node-" + std::to_string(serial)).c_str();
+
+        mServer.OnNodeInfoChange(nodeInfo);
+
+        ASSERT_TRUE(stream->Read(&response)) << "Established stream must survive credentials rotation";
+        EXPECT_EQ(response.node_id(), nodeInfo.mNodeID.CStr());
+    }
+
+    nodesContext.TryCancel();
+    stream->Finish();
+
+    ASSERT_TRUE(mServer.Stop().IsNone());
+}
+
+TEST_F(IAMServerTest, LocalSocketSurvivesCertRotation)
+{
+    constexpr auto cSocketPath = "/tmp/aos-iamserver-rotation.sock";
+
+    mServerConfig.mIAMPublicServerSocket = cSocketPath;
+
+    auto err = mServer.Init(mServerConfig, mCertHandler, mIdentHandler, mPermHandler, mCertLoader, mCryptoProvider,
+        mNodeInfoProvider, mNodeManager, mCertProvider, mProvisionManager, cProvisioningModeOff);
+
+    ASSERT_TRUE(err.IsNone()) << err.Message();
+    ASSERT_TRUE(mServer.Start().IsNone());
+
+    auto oldCert = GetServerCert();
+
+    ASSERT_FALSE(oldCert.empty()) << "Can't get server certificate";
+
+    certhandler::CertInfo newServerInfo;
+
+    ApplyCertificate("server", "localhost", CERTIFICATES_IAM_DIR "/server_int.key",
+        CERTIFICATES_IAM_DIR "/server_int.cer", 0x3333555, newServerInfo);
+
+    ASSERT_TRUE(WaitServerCertChanged(oldCert)) << "Credentials are not rotated";
+
+    struct stat socketStat { };
+
+    ASSERT_EQ(stat(cSocketPath, &socketStat), 0) << "Local socket must survive credentials rotation";
+    EXPECT_TRUE(S_ISSOCK(socketStat.st_mode));
+
+    // new channel makes sure the socket is connected after rotation
+    auto stub = CreateCustomStub<iamanager::IAMVersionService>(std::string("unix:") + cSocketPath, true);
+
+    ASSERT_NE(stub, nullptr) << "Failed to create a stub";
+
+    grpc::ClientContext   context;
+    iamanager::APIVersion response;
+
+    auto status = stub->GetAPIVersion(&context, {}, &response);
+
+    EXPECT_TRUE(status.ok()) << "GetAPIVersion over unix socket after rotation failed: code = " << status.error_code()
+                             << ", message = " << status.error_message();
+
+    ASSERT_TRUE(mServer.Stop().IsNone());
+}
+
+// Run with --gtest_also_run_disabled_tests to compare mTLS reconnect CPU time with and without session resumption.
+TEST_F(IAMServerTest, DISABLED_TLSSessionResumptionBenchmark)
+{
+    constexpr auto cReconnects = 200;
+
+    auto err = mServer.Init(mServerConfig, mCertHandler, mIdentHandler, mPermHandler, mCertLoader, mCryptoProvider,
+        mNodeInfoProvider, mNodeManager, mCertProvider, mProvisionManager, cProvisioningModeOff);
+
+    ASSERT_TRUE(err.IsNone()) << err.Message();
+    ASSERT_TRUE(mServer.Start().IsNone());
+
+    auto credentials = common::utils::GetMTLSClientCredentials(
+        mClientInfo, GetClientConfig().mCACert.c_str(), mCertLoader, mCryptoProvider);
+
+    auto getCPUTime = []() {
+        struct rusage usage { };
+
+        getrusage(RUSAGE_SELF, &usage);
+
+        return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+            + std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+    };
+
+    auto measure = [&](grpc_ssl_session_cache* cache) {
+        auto start = getCPUTime();
+
+        for (auto i = 0; i < cReconnects; i++) {
+            grpc::ChannelArguments args;
+
+            // unique arg prevents channel reuse between iterations, so every call makes a new handshake
+            args.SetInt("iamserver.test.iteration", i);
+
+            if (cache != nullptr) {
+                auto arg = grpc_ssl_session_cache_create_channel_arg(cache);
+
+                args.SetPointerWithVtable(arg.key, arg.value.pointer.p, arg.value.pointer.vtable);
+            }
+
+            auto stub = iamanager::IAMVersionService::NewStub(
+                grpc::CreateCustomChannel(mServerConfig.mIAMProtectedServerURL, credentials, args));
+
+            grpc::ClientContext   context;
+            iamanager::APIVersion response;
+
+            EXPECT_TRUE(stub->GetAPIVersion(&context, {}, &response).ok());
+        }
+
+        return std::chrono::duration_cast<std::chrono::milliseconds>(getCPUTime() - start);
+    };
+
+    auto cache = grpc_ssl_session_cache_create_lru(1);
+
+    std::cout << "Full handshake: " << measure(nullptr).count() << " ms CPU per " << cReconnects << " reconnects"
+              << std::endl;
+    std::cout << "Resumed handshake: " << measure(cache).count() << " ms CPU per " << cReconnects << " reconnects"
+              << std::endl;
+
+    grpc_ssl_session_cache_destroy(cache);
+
+    ASSERT_TRUE(mServer.Stop().IsNone());
+}
+
 } // namespace aos::iam::iamserver
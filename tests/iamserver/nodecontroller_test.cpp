@@ -5,6 +5,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <cstdlib>
+#include <new>
 #include <thread>
 
 #include <gmock/gmock.h>
@@ -17,10 +19,49 @@
 #include <iamanager/v5/iamanager.grpc.pb.h>
 
 #include "iamserver/nodecontroller.hpp"
+#include "metrics/metrics.hpp"
 #include "mocks/nodemanagermock.hpp"
+#include "tracer/protocarrier.hpp"
 
 using namespace testing;
 
+/***********************************************************************************************************************
+ * Allocation counter
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr size_t cLargePayloadSize = 16 * 1024;
+
+thread_local bool   tCountAllocations = false;
+thread_local size_t tLargeAllocations = 0;
+
+} // namespace
+
+// payload copies are detected by large allocations made by the calling thread
+void* operator new(size_t size)
+{
+    if (tCountAllocations && size >= cLargePayloadSize) {
+        tLargeAllocations++;
+    }
+
+    if (auto ptr = malloc(size ? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
 namespace aos::iam::iamserver {
 
 namespace {
@@ -542,6 +583,254 @@ TEST_F(NodeControllerTest, CreateKeySucceeds)
     ASSERT_TRUE(status.ok()) << status.error_message();
 }
 
+TEST_F(NodeControllerTest, CreateKeyForDifferentCertTypesConcurrently)
+{
+    auto stream = CreateRegisterNodeClientStream();
+    ASSERT_NE(stream, nullptr) << "Failed to create client stream";
+
+    mOutgoingMessage.mutable_node_info()->set_node_id("node1");
+    mOutgoingMessage.mutable_node_info()->set_status(cProvisionedStatus.ToString().CStr());
+
+    stream->Write(mOutgoingMessage);
+
+    NodeStreamHandler::Ptr steamHandler;
+
+    for (size_t i = 1; i < 4 && !steamHandler; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100 * i));
+
+        steamHandler = GetNodeController()->GetNodeStreamHandler("node1");
+    }
+
+    ASSERT_NE(steamHandler, nullptr);
+
+    auto createKey = [&](const std::string& certType) {
+        iamproto::CreateKeyRequest  request;
+        iamproto::CreateKeyResponse response;
+
+        request.set_node_id("node1");
+        request.set_type(certType);
+
+        auto status = steamHandler->CreateKey(&request, &response, std::chrono::seconds(5));
+
+        EXPECT_TRUE(status.ok()) << status.error_message();
+        EXPECT_EQ(response.type(), certType);
+        EXPECT_EQ(response.csr(), "csr-" + certType);
+    };
+
+    auto iamResult = std::async(std::launch::async, createKey, "iam");
+    auto smResult  = std::async(std::launch::async, createKey, "sm");
+
+    std::vector<std::string> certTypes;
+
+    for (size_t i = 0; i < 2; ++i) {
+        ASSERT_TRUE(stream->Read(&mIncomingMessage));
+        ASSERT_TRUE(mIncomingMessage.has_create_key_request());
+
+        certTypes.push_back(mIncomingMessage.create_key_request().type());
+    }
+
+    // respond in reverse order, responses should be matched by cert type
+    for (auto it = certTypes.rbegin(); it != certTypes.rend(); ++it) {
+        iamproto::IAMOutgoingMessages outgoing;
+
+        outgoing.mutable_create_key_response()->set_type(*it);
+        outgoing.mutable_create_key_response()->set_csr("csr-" + *it);
+
+        ASSERT_TRUE(stream->Write(outgoing));
+    }
+
+    iamResult.wait();
+    smResult.wait();
+
+    stream->WritesDone();
+}
+
+TEST_F(NodeControllerTest, CreateKeyForSameCertTypeConcurrently)
+{
+    auto stream = CreateRegisterNodeClientStream();
+    ASSERT_NE(stream, nullptr) << "Failed to create client stream";
+
+    mOutgoingMessage.mutable_node_info()->set_node_id("node1");
+    mOutgoingMessage.mutable_node_info()->set_status(cProvisionedStatus.ToString().CStr());
+
+    stream->Write(mOutgoingMessage);
+
+    NodeStreamHandler::Ptr steamHandler;
+
+    for (size_t i = 1; i < 4 && !steamHandler; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100 * i));
+
+        steamHandler = GetNodeController()->GetNodeStreamHandler("node1");
+    }
+
+    ASSERT_NE(steamHandler, nullptr);
+
+    auto createKey = [&](const std::string& subject) {
+        iamproto::CreateKeyRequest  request;
+        iamproto::CreateKeyResponse response;
+
+        request.set_node_id("node1");
+        request.set_type("iam");
+        request.set_subject(subject);
+
+        auto status = steamHandler->CreateKey(&request, &response, std::chrono::seconds(5));
+
+        EXPECT_TRUE(status.ok()) << status.error_message();
+        EXPECT_EQ(response.csr(), "csr-" + subject);
+    };
+
+    auto firstResult  = std::async(std::launch::async, createKey, "subject1");
+    auto secondResult = std::async(std::launch::async, createKey, "subject2");
+
+    std::vector<std::string> subjects;
+
+    // second request of the same type is sent only after the first one is answered
+    for (size_t i = 0; i < 2; ++i) {
+        ASSERT_TRUE(stream->Read(&mIncomingMessage));
+        ASSERT_TRUE(mIncomingMessage.has_create_key_request());
+
+        const auto& request = mIncomingMessage.create_key_request();
+
+        subjects.push_back(request.subject());
+
+        iamproto::IAMOutgoingMessages outgoing;
+
+        outgoing.mutable_create_key_response()->set_type(request.type());
+        outgoing.mutable_create_key_response()->set_csr("csr-" + request.subject());
+
+        ASSERT_TRUE(stream->Write(outgoing));
+    }
+
+    EXPECT_THAT(subjects, UnorderedElementsAre("subject1", "subject2"));
+
+    firstResult.wait();
+    secondResult.wait();
+
+    stream->WritesDone();
+}
+
+TEST_F(NodeControllerTest, ForwardingDoesNotCopyPayload)
+{
+    auto stream = CreateRegisterNodeClientStream();
+    ASSERT_NE(stream, nullptr) << "Failed to create client stream";
+
+    mOutgoingMessage.mutable_node_info()->set_node_id("node1");
+    mOutgoingMessage.mutable_node_info()->set_status(cProvisionedStatus.ToString().CStr());
+
+    stream->Write(mOutgoingMessage);
+
+    NodeStreamHandler::Ptr steamHandler;
+
+    for (size_t i = 1; i < 4 && !steamHandler; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100 * i));
+
+        steamHandler = GetNodeController()->GetNodeStreamHandler("node1");
+    }
+
+    ASSERT_NE(steamHandler, nullptr);
+
+    const std::string payload(cLargePayloadSize, 'x');
+
+    auto async = std::async(std::launch::async, [&]() {
+        iamproto::IAMIncomingMessages incoming;
+        iamproto::IAMOutgoingMessages outgoing;
+
+        ASSERT_TRUE(stream->Read(&incoming));
+        ASSERT_TRUE(incoming.has_apply_cert_request());
+        EXPECT_EQ(incoming.apply_cert_request().cert(), payload);
+
+        outgoing.mutable_apply_cert_response();
+        ASSERT_TRUE(stream->Write(outgoing));
+
+        ASSERT_TRUE(stream->Read(&incoming));
+        ASSERT_TRUE(incoming.has_create_key_request());
+
+        outgoing.mutable_create_key_response()->set_csr(payload);
+        ASSERT_TRUE(stream->Write(outgoing));
+    });
+
+    iamproto::ApplyCertRequest  applyCertRequest;
+    iamproto::ApplyCertResponse applyCertResponse;
+    iamproto::CreateKeyRequest  createKeyRequest;
+    iamproto::CreateKeyResponse createKeyResponse;
+
+    applyCertRequest.set_node_id("node1");
+    applyCertRequest.set_cert(payload);
+    createKeyRequest.set_node_id("node1");
+
+    tCountAllocations = true;
+
+    auto applyCertStatus = steamHandler->ApplyCert(&applyCertRequest, &applyCertResponse, std::chrono::seconds(5));
+    auto createKeyStatus = steamHandler->CreateKey(&createKeyRequest, &createKeyResponse, std::chrono::seconds(5));
+
+    tCountAllocations = false;
+
+    EXPECT_TRUE(applyCertStatus.ok()) << applyCertStatus.error_message();
+    EXPECT_TRUE(createKeyStatus.ok()) << createKeyStatus.error_message();
+    EXPECT_EQ(createKeyResponse.csr(), payload);
+    EXPECT_EQ(applyCertRequest.cert(), payload);
+    EXPECT_EQ(tLargeAllocations, 0U);
+
+    async.wait();
+
+    stream->WritesDone();
+}
+
+TEST_F(NodeControllerTest, ForwardedRequestCarriesDeadline)
+{
+    auto stream = CreateRegisterNodeClientStream();
+    ASSERT_NE(stream, nullptr) << "Failed to create client stream";
+
+    mOutgoingMessage.mutable_node_info()->set_node_id("node1");
+    mOutgoingMessage.mutable_node_info()->set_status(cProvisionedStatus.ToString().CStr());
+
+    stream->Write(mOutgoingMessage);
+
+    iamproto::PauseNodeRequest  request;
+    iamproto::PauseNodeResponse response;
+
+    request.set_node_id("node1");
+
+    auto async = std::async(std::launch::async, [&]() {
+        ASSERT_TRUE(stream->Read(&mIncomingMessage));
+        ASSERT_TRUE(mIncomingMessage.has_pause_node_request());
+
+        auto timeout = tracer::ExtractDeadline(mIncomingMessage);
+
+        ASSERT_TRUE(timeout.has_value());
+        EXPECT_GT(timeout->count(), 0);
+        EXPECT_LE(timeout->count(), 1000);
+
+        iamproto::IAMOutgoingMessages mOutgoingMessage;
+        mOutgoingMessage.mutable_pause_node_response();
+
+        ASSERT_TRUE(stream->Write(mOutgoingMessage));
+    });
+
+    grpc::Status status;
+
+    for (size_t i = 1; i < 4; ++i) {
+        auto steamHandler = GetNodeController()->GetNodeStreamHandler("node1");
+        if (!steamHandler) {
+            LOG_ERR() << "Node stream handler not found: nodeID = node1";
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(100 * i));
+
+            continue;
+        }
+
+        status = steamHandler->PauseNode(&request, &response, std::chrono::seconds(1));
+
+        if (status.ok()) {
+            break;
+        }
+    }
+
+    stream->WritesDone();
+
+    ASSERT_TRUE(status.ok()) << status.error_message();
+}
+
 TEST_F(NodeControllerTest, ApplyCertSucceeds)
 {
     auto stream = CreateRegisterNodeClientStream();
@@ -594,4 +883,41 @@ TEST_F(NodeControllerTest, ApplyCertSucceeds)
     ASSERT_TRUE(status.ok()) << status.error_message();
 }
 
+TEST_F(NodeControllerTest, ActiveStreamsGaugeFollowsStreamLifetime)
+{
+    auto& gauge = metrics::GetRegistry().GetGauge("aos_iam_node_streams", "Number of active node streams");
+
+    metrics::SetEnabled(true);
+
+    const auto initial = gauge.Get();
+    auto       stream  = CreateRegisterNodeClientStream();
+    ASSERT_NE(stream, nullptr) << "Failed to create client stream";
+
+    mOutgoingMessage.mutable_node_info()->set_node_id("node1");
+    mOutgoingMessage.mutable_node_info()->set_status(cProvisionedStatus.ToString().CStr());
+
+    ASSERT_TRUE(stream->Write(mOutgoingMessage));
+
+    NodeStreamHandler::Ptr streamHandler;
+
+    for (size_t i = 1; i < 4 && !streamHandler; ++i) {
+        if (streamHandler = GetNodeController()->GetNodeStreamHandler("node1"); !streamHandler) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100 * i));
+        }
+    }
+
+    ASSERT_NE(streamHandler, nullptr);
+    EXPECT_EQ(gauge.Get(), initial + 1);
+
+    stream->WritesDone();
+
+    auto status = stream->Finish();
+
+    // the handler object is still referenced here, but its stream is over
+    EXPECT_TRUE(status.ok()) << status.error_message();
+    EXPECT_EQ(gauge.Get(), initial);
+
+    metrics::SetEnabled(false);
+}
+
 } // namespace aos::iam::iamserver
@@ -5,6 +5,13 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include <gmock/gmock.h>
 
 #include <aos/test/log.hpp>
@@ -14,6 +21,7 @@
 #include <aos/iam/certmodules/pkcs11/pkcs11.hpp>
 #include <utils/grpchelper.hpp>
 
+#include "iamserver/allcerttypes.hpp"
 #include "iamserver/protectedmessagehandler.hpp"
 
 #include "mocks/certprovidermock.hpp"
@@ -63,7 +71,13 @@ std::unique_ptr<typename T::Stub> CreateClientStub()
 
 class ProtectedMessageHandlerTest : public Test {
 protected:
-    void InitServer();
+    using NodeStream = grpc::ClientReaderWriter<iamproto::IAMOutgoingMessages, iamproto::IAMIncomingMessages>;
+
+    void                        InitServer();
+    std::unique_ptr<NodeStream> RegisterNode(grpc::ClientContext& context, const std::string& nodeID);
+
+    grpc::Status CreateKey(grpc::ClientContext& context, const std::string& nodeID, const std::string& certType,
+        iamproto::CreateKeyResponse& response);
 
     NodeController                mNodeController;
     ProtectedMessageHandler       mServerHandler;
@@ -77,6 +91,8 @@ protected:
     iam::provisionmanager::ProvisionManagerMock mProvisionManager;
     iam::certprovider::CertProviderMock         mCertProvider;
 
+    std::unique_ptr<iamproto::IAMPublicNodesService::Stub> mNodesStub;
+
 private:
     void SetUp() override;
     void TearDown() override;
@@ -92,6 +108,48 @@ void ProtectedMessageHandlerTest::InitServer()
     mServer = builder.BuildAndStart();
 }
 
+// registers node stream and waits until it is linked to the node ID
+std::unique_ptr<ProtectedMessageHandlerTest::NodeStream> ProtectedMessageHandlerTest::RegisterNode(
+    grpc::ClientContext& context, const std::string& nodeID)
+{
+    if (!mNodesStub) {
+        mNodesStub = CreateClientStub<iamproto::IAMPublicNodesService>();
+    }
+
+    auto stream = mNodesStub->RegisterNode(&context);
+    if (!stream) {
+        return nullptr;
+    }
+
+    iamproto::IAMOutgoingMessages nodeInfo;
+
+    nodeInfo.mutable_node_info()->set_node_id(nodeID);
+    nodeInfo.mutable_node_info()->set_status("provisioned");
+
+    if (!stream->Write(nodeInfo)) {
+        return nullptr;
+    }
+
+    for (auto i = 0; i < 50 && !mNodeController.GetNodeStreamHandler(nodeID); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    return mNodeController.GetNodeStreamHandler(nodeID) ? std::move(stream) : nullptr;
+}
+
+grpc::Status ProtectedMessageHandlerTest::CreateKey(grpc::ClientContext& context, const std::string& nodeID,
+    const std::string& certType, iamproto::CreateKeyResponse& response)
+{
+    auto                       clientStub = CreateClientStub<iamproto::IAMCertificateService>();
+    iamproto::CreateKeyRequest request;
+
+    request.set_node_id(nodeID);
+    request.set_type(certType);
+    request.set_subject(cSystemID);
+
+    return clientStub->CreateKey(&context, request, &response);
+}
+
 void ProtectedMessageHandlerTest::SetUp()
 {
     test::InitLog();
@@ -111,6 +169,8 @@ void ProtectedMessageHandlerTest::SetUp()
 
     ASSERT_TRUE(err.IsNone()) << "Failed to initialize public message handler: " << err.Message();
 
+    mServerHandler.Start();
+
     InitServer();
 }
 
@@ -447,6 +507,409 @@ TEST_F(ProtectedMessageHandlerTest, CreateKeySucceeds)
     EXPECT_TRUE(response.error().message().empty());
 }
 
+TEST_F(ProtectedMessageHandlerTest, CreateKeyWithEmptySubjectUnavailableUntilIdentifierReady)
+{
+    ComponentReadiness readiness;
+
+    readiness.SetPending(ServerComponent::eIdentifier);
+    mServerHandler.SetReadiness(readiness);
+
+    auto clientStub = CreateClientStub<iamproto::IAMCertificateService>();
+    ASSERT_NE(clientStub, nullptr) << "Failed to create client stub";
+
+    EXPECT_CALL(mIdentHandler, GetSystemID).Times(0);
+    EXPECT_CALL(mProvisionManager, CreateKey).Times(0);
+
+    {
+        grpc::ClientContext         context;
+        iamproto::CreateKeyRequest  request;
+        iamproto::CreateKeyResponse response;
+
+        request.set_node_id("node0");
+
+        const auto status = clientStub->CreateKey(&context, request, &response);
+
+        ASSERT_EQ(status.error_code(), grpc::StatusCode::UNAVAILABLE);
+        EXPECT_EQ(context.GetServerTrailingMetadata().count(ComponentReadiness::cRetryPushbackKey), 1);
+    }
+
+    readiness.SetReady(ServerComponent::eIdentifier);
+
+    EXPECT_CALL(mProvisionManager, CreateKey).WillOnce(Return(ErrorEnum::eNone));
+    EXPECT_CALL(mIdentHandler, GetSystemID).WillOnce(Return(RetWithError<StaticString<cSystemIDLen>>(cSystemID)));
+
+    grpc::ClientContext         context;
+    iamproto::CreateKeyRequest  request;
+    iamproto::CreateKeyResponse response;
+
+    request.set_node_id("node0");
+
+    const auto status = clientStub->CreateKey(&context, request, &response);
+
+    ASSERT_TRUE(status.ok()) << "CreateKey failed: code = " << status.error_code()
+                             << ", message = " << status.error_message();
+
+    EXPECT_EQ(response.error().aos_code(), static_cast<int>(ErrorEnum::eNone));
+}
+
+TEST_F(ProtectedMessageHandlerTest, ForwardedCreateKeyIsNotBlockedByLocalKeyGeneration)
+{
+    constexpr auto cCryptoWorkers = 4;
+    constexpr auto cLocalKeys     = cCryptoWorkers * 2;
+
+    std::mutex              mutex;
+    std::condition_variable condVar;
+    size_t                  generating = 0;
+    bool                    released   = false;
+
+    // local key generation blocks until released
+    EXPECT_CALL(mProvisionManager, CreateKey).WillRepeatedly(InvokeWithoutArgs([&]() {
+        std::unique_lock lock {mutex};
+
+        generating++;
+        condVar.notify_all();
+        condVar.wait(lock, [&]() { return released; });
+
+        return ErrorEnum::eNone;
+    }));
+
+    auto releaseKeys = [&]() {
+        std::lock_guard lock {mutex};
+
+        released = true;
+        condVar.notify_all();
+    };
+
+    std::vector<std::future<grpc::Status>> localKeys;
+
+    for (auto i = 0; i < cLocalKeys; i++) {
+        localKeys.push_back(std::async(std::launch::async, [this, i]() {
+            grpc::ClientContext         context;
+            iamproto::CreateKeyResponse response;
+
+            return CreateKey(context, "node0", "local" + std::to_string(i), response);
+        }));
+    }
+
+    // local requests can't complete until keys are released, release them on any test exit
+    const auto releaseOnExit = std::shared_ptr<void>(nullptr, [&](void*) { releaseKeys(); });
+
+    {
+        std::unique_lock lock {mutex};
+
+        ASSERT_TRUE(
+            condVar.wait_for(lock, std::chrono::seconds(5), [&]() { return generating == cCryptoWorkers; }));
+    }
+
+    // node1 answers forwarded create key requests
+    grpc::ClientContext nodeContext;
+    auto                nodeStream = RegisterNode(nodeContext, "node1");
+    ASSERT_NE(nodeStream, nullptr);
+
+    auto node = std::async(std::launch::async, [&]() {
+        iamproto::IAMIncomingMessages incoming;
+
+        if (!nodeStream->Read(&incoming) || !incoming.has_create_key_request()) {
+            return;
+        }
+
+        iamproto::IAMOutgoingMessages outgoing;
+
+        outgoing.mutable_create_key_response()->set_node_id("node1");
+        outgoing.mutable_create_key_response()->set_type(incoming.create_key_request().type());
+        outgoing.mutable_create_key_response()->set_csr("csr");
+
+        nodeStream->Write(outgoing);
+    });
+
+    const auto cancelOnExit = std::shared_ptr<void>(nullptr, [&](void*) { nodeContext.TryCancel(); });
+
+    grpc::ClientContext         context;
+    iamproto::CreateKeyResponse response;
+
+    context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(5));
+
+    // forwarded request would wait behind queued local keys till the deadline if it took a crypto worker
+    const auto status = CreateKey(context, "node1", "forwarded", response);
+
+    releaseKeys();
+
+    ASSERT_TRUE(status.ok()) << "CreateKey failed: code = " << status.error_code()
+                             << ", message = " << status.error_message();
+    EXPECT_EQ(response.csr(), "csr");
+
+    for (auto& localKey : localKeys) {
+        EXPECT_TRUE(localKey.get().ok());
+    }
+
+    nodeStream->WritesDone();
+    node.wait();
+}
+
+TEST_F(ProtectedMessageHandlerTest, ForwardedCreateKeyIsReleasedOnCallerDeadline)
+{
+    grpc::ClientContext nodeContext;
+    auto                nodeStream = RegisterNode(nodeContext, "node1");
+    ASSERT_NE(nodeStream, nullptr);
+
+    // node doesn't answer the first request and answers the second one
+    auto node = std::async(std::launch::async, [&]() {
+        iamproto::IAMIncomingMessages incoming;
+
+        if (!nodeStream->Read(&incoming) || !nodeStream->Read(&incoming) || !incoming.has_create_key_request()) {
+            return false;
+        }
+
+        iamproto::IAMOutgoingMessages outgoing;
+
+        outgoing.mutable_create_key_response()->set_type(incoming.create_key_request().type());
+        outgoing.mutable_create_key_response()->set_csr("csr");
+
+        return nodeStream->Write(outgoing);
+    });
+
+    const auto cancelOnExit = std::shared_ptr<void>(nullptr, [&](void*) { nodeContext.TryCancel(); });
+
+    {
+        grpc::ClientContext         context;
+        iamproto::CreateKeyResponse response;
+
+        context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(300));
+
+        EXPECT_EQ(CreateKey(context, "node1", "iam", response).error_code(), grpc::StatusCode::DEADLINE_EXCEEDED);
+    }
+
+    // request of the same type waits for the pending one, so it is sent only if the expired request is released
+    // before its one minute response timeout
+    grpc::ClientContext         context;
+    iamproto::CreateKeyResponse response;
+
+    context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(5));
+
+    const auto status = CreateKey(context, "node1", "iam", response);
+
+    ASSERT_TRUE(status.ok()) << "CreateKey failed: code = " << status.error_code()
+                             << ", message = " << status.error_message();
+    EXPECT_EQ(response.csr(), "csr");
+    EXPECT_TRUE(node.get());
+}
+
+TEST_F(ProtectedMessageHandlerTest, ForwardedCreateKeyIsReleasedOnCallerCancel)
+{
+    grpc::ClientContext nodeContext;
+    auto                nodeStream = RegisterNode(nodeContext, "node1");
+    ASSERT_NE(nodeStream, nullptr);
+
+    grpc::ClientContext canceledContext;
+
+    // node cancels the caller of the first request and answers the second one
+    auto node = std::async(std::launch::async, [&]() {
+        iamproto::IAMIncomingMessages incoming;
+
+        if (!nodeStream->Read(&incoming)) {
+            return false;
+        }
+
+        canceledContext.TryCancel();
+
+        if (!nodeStream->Read(&incoming) || !incoming.has_create_key_request()) {
+            return false;
+        }
+
+        iamproto::IAMOutgoingMessages outgoing;
+
+        outgoing.mutable_create_key_response()->set_type(incoming.create_key_request().type());
+        outgoing.mutable_create_key_response()->set_csr("csr");
+
+        return nodeStream->Write(outgoing);
+    });
+
+    const auto cancelOnExit = std::shared_ptr<void>(nullptr, [&](void*) { nodeContext.TryCancel(); });
+
+    {
+        iamproto::CreateKeyResponse response;
+
+        EXPECT_EQ(CreateKey(canceledContext, "node1", "iam", response).error_code(), grpc::StatusCode::CANCELLED);
+    }
+
+    // request of the same type waits for the pending one, so it is sent only if the canceled request is released
+    grpc::ClientContext         context;
+    iamproto::CreateKeyResponse response;
+
+    context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(5));
+
+    const auto status = CreateKey(context, "node1", "iam", response);
+
+    ASSERT_TRUE(status.ok()) << "CreateKey failed: code = " << status.error_code()
+                             << ", message = " << status.error_message();
+    EXPECT_EQ(response.csr(), "csr");
+    EXPECT_TRUE(node.get());
+}
+
+TEST_F(ProtectedMessageHandlerTest, CreateKeyForAllCertTypesGeneratesKeysConcurrently)
+{
+    iam::provisionmanager::CertTypes certTypes;
+
+    certTypes.PushBack("iam");
+    certTypes.PushBack("online");
+    certTypes.PushBack("offline");
+
+    std::mutex              mutex;
+    std::condition_variable condVar;
+    size_t                  generating = 0;
+
+    EXPECT_CALL(mProvisionManager, GetCertTypes)
+        .WillOnce(Return(RetWithError<iam::provisionmanager::CertTypes>(certTypes, ErrorEnum::eNone)));
+
+    // each key is completed only when keys of all types are being generated
+    EXPECT_CALL(mProvisionManager, CreateKey)
+        .Times(certTypes.Size())
+        .WillRepeatedly(Invoke([&](const String& certType, const String&, const String&, String& csr) -> Error {
+            std::unique_lock lock {mutex};
+
+            generating++;
+            condVar.notify_all();
+
+            if (!condVar.wait_for(lock, std::chrono::seconds(5), [&]() { return generating == certTypes.Size(); })) {
+                return ErrorEnum::eTimeout;
+            }
+
+            return csr.Assign(certType.CStr());
+        }));
+
+    grpc::ClientContext         context;
+    iamproto::CreateKeyResponse response;
+
+    context.AddMetadata(cAllCertTypesMetadataKey, "true");
+
+    const auto status = CreateKey(context, "node0", "", response);
+
+    ASSERT_TRUE(status.ok()) << "CreateKey failed: code = " << status.error_code()
+                             << ", message = " << status.error_message();
+    EXPECT_EQ(response.node_id(), "node0");
+    EXPECT_EQ(response.error().aos_code(), static_cast<int>(ErrorEnum::eNone));
+
+    const auto certTypeResponses = GetCertTypeResponses(response);
+
+    ASSERT_EQ(certTypeResponses.size(), certTypes.Size());
+
+    for (size_t i = 0; i < certTypes.Size(); i++) {
+        EXPECT_EQ(certTypeResponses[i].node_id(), "node0");
+        EXPECT_EQ(certTypeResponses[i].type(), certTypes[i].CStr());
+        EXPECT_EQ(certTypeResponses[i].csr(), certTypes[i].CStr());
+        EXPECT_EQ(certTypeResponses[i].error().aos_code(), static_cast<int>(ErrorEnum::eNone));
+    }
+}
+
+TEST_F(ProtectedMessageHandlerTest, CreateKeyForAllCertTypesReportsFailedCertType)
+{
+    iam::provisionmanager::CertTypes certTypes;
+
+    certTypes.PushBack("iam");
+    certTypes.PushBack("online");
+
+    EXPECT_CALL(mProvisionManager, GetCertTypes)
+        .WillOnce(Return(RetWithError<iam::provisionmanager::CertTypes>(certTypes, ErrorEnum::eNone)));
+    EXPECT_CALL(mProvisionManager, CreateKey)
+        .Times(certTypes.Size())
+        .WillRepeatedly(Invoke([&](const String& certType, const String&, const String&, String& csr) -> Error {
+            if (std::string(certType.CStr()) == "online") {
+                return ErrorEnum::eFailed;
+            }
+
+            return csr.Assign(certType.CStr());
+        }));
+
+    grpc::ClientContext         context;
+    iamproto::CreateKeyResponse response;
+
+    context.AddMetadata(cAllCertTypesMetadataKey, "true");
+
+    const auto status = CreateKey(context, "node0", "", response);
+
+    ASSERT_TRUE(status.ok()) << "CreateKey failed: code = " << status.error_code()
+                             << ", message = " << status.error_message();
+    EXPECT_EQ(response.error().aos_code(), static_cast<int>(ErrorEnum::eFailed));
+
+    const auto certTypeResponses = GetCertTypeResponses(response);
+
+    ASSERT_EQ(certTypeResponses.size(), certTypes.Size());
+
+    EXPECT_EQ(certTypeResponses[0].csr(), "iam");
+    EXPECT_EQ(certTypeResponses[0].error().aos_code(), static_cast<int>(ErrorEnum::eNone));
+    EXPECT_EQ(certTypeResponses[1].type(), "online");
+    EXPECT_EQ(certTypeResponses[1].error().aos_code(), static_cast<int>(ErrorEnum::eFailed));
+}
+
+TEST_F(ProtectedMessageHandlerTest, CreateKeyForAllCertTypesRequiresEmptyType)
+{
+    EXPECT_CALL(mProvisionManager, CreateKey).Times(0);
+
+    grpc::ClientContext         context;
+    iamproto::CreateKeyResponse response;
+
+    context.AddMetadata(cAllCertTypesMetadataKey, "true");
+
+    EXPECT_EQ(CreateKey(context, "node0", "iam", response).error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+}
+
+TEST_F(ProtectedMessageHandlerTest, CreateKeyForAllCertTypesIsForwardedToNode)
+{
+    grpc::ClientContext nodeContext;
+    auto                nodeStream = RegisterNode(nodeContext, "node1");
+    ASSERT_NE(nodeStream, nullptr);
+
+    // node generates keys of all its cert types on single request
+    auto node = std::async(std::launch::async, [&]() {
+        iamproto::IAMIncomingMessages incoming;
+
+        if (!nodeStream->Read(&incoming) || !incoming.has_create_key_request()
+            || !IsAllCertTypes(incoming.create_key_request()) || !incoming.create_key_request().type().empty()) {
+            return false;
+        }
+
+        iamproto::IAMOutgoingMessages outgoing;
+        auto&                         response = *outgoing.mutable_create_key_response();
+
+        response.set_node_id("node1");
+
+        for (const auto& certType : {"iam", "sm"}) {
+            iamproto::CreateKeyResponse certTypeResponse;
+
+            certTypeResponse.set_node_id("node1");
+            certTypeResponse.set_type(certType);
+            certTypeResponse.set_csr(std::string("csr-") + certType);
+
+            AddCertTypeResponse(response, certTypeResponse);
+        }
+
+        return nodeStream->Write(outgoing);
+    });
+
+    const auto cancelOnExit = std::shared_ptr<void>(nullptr, [&](void*) { nodeContext.TryCancel(); });
+
+    grpc::ClientContext         context;
+    iamproto::CreateKeyResponse response;
+
+    context.AddMetadata(cAllCertTypesMetadataKey, "true");
+    context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(5));
+
+    const auto status = CreateKey(context, "node1", "", response);
+
+    ASSERT_TRUE(status.ok()) << "CreateKey failed: code = " << status.error_code()
+                             << ", message = " << status.error_message();
+    EXPECT_TRUE(node.get());
+
+    const auto certTypeResponses = GetCertTypeResponses(response);
+
+    ASSERT_EQ(certTypeResponses.size(), 2u);
+
+    EXPECT_EQ(certTypeResponses[0].type(), "iam");
+    EXPECT_EQ(certTypeResponses[0].csr(), "csr-iam");
+    EXPECT_EQ(certTypeResponses[1].type(), "sm");
+    EXPECT_EQ(certTypeResponses[1].csr(), "csr-sm");
+}
+
 TEST_F(ProtectedMessageHandlerTest, ApplyCertSucceeds)
 {
     auto clientStub = CreateClientStub<iamproto::IAMCertificateService>();
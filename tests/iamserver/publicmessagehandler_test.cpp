@@ -5,6 +5,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <map>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -262,6 +264,56 @@ TEST_F(PublicMessageHandlerTest, SubscribeCertChangedSucceeds)
         << ", message = " << status.error_message();
 }
 
+TEST_F(PublicMessageHandlerTest, SubscribeCertChangedMultipleTypes)
+{
+    auto clientStub = CreateClientStub<iamproto::IAMPublicService>();
+    ASSERT_NE(clientStub, nullptr) << "Failed to create client stub";
+
+    grpc::ClientContext                   context;
+    iamproto::SubscribeCertChangedRequest request;
+    iamanager::v5::CertInfo               response;
+
+    context.AddMetadata(cCertTypeMetadataKey, "type-a");
+    context.AddMetadata(cCertTypeMetadataKey, "type-b");
+
+    std::map<std::string, iam::certhandler::CertReceiverItf*> receivers;
+
+    EXPECT_CALL(mCertProvider, SubscribeCertChanged)
+        .Times(2)
+        .WillRepeatedly(Invoke([&receivers](const String& certType, iam::certhandler::CertReceiverItf& receiver) {
+            receivers[certType.CStr()] = &receiver;
+
+            return ErrorEnum::eNone;
+        }));
+    EXPECT_CALL(mCertProvider, UnsubscribeCertChanged).Times(2).WillRepeatedly(Return(ErrorEnum::eNone));
+
+    auto reader = clientStub->SubscribeCertChanged(&context, request);
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    ASSERT_EQ(receivers.size(), 2U);
+
+    iam::certhandler::CertInfo certInfo;
+
+    for (const auto& certType : {"type-a", "type-b"}) {
+        certInfo.mCertURL = certType;
+
+        receivers[certType]->OnCertChanged(certInfo);
+
+        ASSERT_TRUE(reader->Read(&response));
+        EXPECT_EQ(response.type(), certType);
+        EXPECT_EQ(response.cert_url(), certType);
+    }
+
+    context.TryCancel();
+
+    auto status = reader->Finish();
+
+    ASSERT_EQ(status.error_code(), grpc::StatusCode::CANCELLED)
+        << "Stream finish should return CANCELLED code: code = " << status.error_code()
+        << ", message = " << status.error_message();
+}
+
 TEST_F(PublicMessageHandlerTest, SubscribeCertChangedFailed)
 {
     auto clientStub = CreateClientStub<iamproto::IAMPublicService>();
@@ -314,6 +366,53 @@ TEST_F(PublicMessageHandlerTest, GetSystemInfoSucceeds)
     ASSERT_EQ(response.unit_model(), cUnitModel);
 }
 
+TEST_F(PublicMessageHandlerTest, GetSystemInfoUnavailableUntilIdentifierReady)
+{
+    ComponentReadiness readiness;
+
+    readiness.SetPending(ServerComponent::eIdentifier);
+    mPublicMessageHandler.SetReadiness(readiness);
+
+    auto identityStub = CreateClientStub<iamproto::IAMPublicIdentityService>();
+    ASSERT_NE(identityStub, nullptr) << "Failed to create client stub";
+
+    auto versionStub = CreateClientStub<iamanager::IAMVersionService>();
+    ASSERT_NE(versionStub, nullptr) << "Failed to create client stub";
+
+    EXPECT_CALL(mIdentHandler, GetSystemID).Times(0);
+
+    {
+        grpc::ClientContext     context;
+        google::protobuf::Empty request;
+        iamproto::SystemInfo    response;
+
+        const auto status = identityStub->GetSystemInfo(&context, request, &response);
+
+        ASSERT_EQ(status.error_code(), grpc::StatusCode::UNAVAILABLE);
+        EXPECT_EQ(context.GetServerTrailingMetadata().count(ComponentReadiness::cRetryPushbackKey), 1);
+    }
+
+    {
+        grpc::ClientContext     context;
+        google::protobuf::Empty request;
+        iamanager::APIVersion   response;
+
+        ASSERT_TRUE(versionStub->GetAPIVersion(&context, request, &response).ok());
+    }
+
+    readiness.SetReady(ServerComponent::eIdentifier);
+
+    EXPECT_CALL(mIdentHandler, GetSystemID).WillOnce(Return(RetWithError<StaticString<cSystemIDLen>>(cSystemID)));
+    EXPECT_CALL(mIdentHandler, GetUnitModel).WillOnce(Return(RetWithError<StaticString<cUnitModelLen>>(cUnitModel)));
+
+    grpc::ClientContext     context;
+    google::protobuf::Empty request;
+    iamproto::SystemInfo    response;
+
+    ASSERT_TRUE(identityStub->GetSystemInfo(&context, request, &response).ok());
+    EXPECT_EQ(response.system_id(), cSystemID);
+}
+
 TEST_F(PublicMessageHandlerTest, GetSystemInfoFailsOnSystemId)
 {
     auto clientStub = CreateClientStub<iamproto::IAMPublicIdentityService>();
@@ -607,4 +706,250 @@ TEST_F(PublicMessageHandlerTest, SubscribeNodeChanged)
     LOG_DBG() << "SubscribeNodeChanged test finished";
 }
 
+TEST_F(PublicMessageHandlerTest, SubscribeNodeChangedWithSnapshot)
+{
+    auto clientStub = CreateClientStub<iamproto::IAMPublicNodesService>();
+    ASSERT_NE(clientStub, nullptr) << "Failed to create client stub";
+
+    google::protobuf::Empty request;
+    grpc::ClientContext     context;
+
+    context.AddMetadata(cSnapshotMetadataKey, "true");
+
+    StaticArray<StaticString<cNodeIDLen>, cMaxNumNodes> nodeIDs;
+    nodeIDs.PushBack("node0");
+    nodeIDs.PushBack("node1");
+
+    EXPECT_CALL(mNodeManager, GetAllNodeIds).WillOnce(Invoke([&nodeIDs](Array<StaticString<cNodeIDLen>>& out) {
+        out = nodeIDs;
+
+        return ErrorEnum::eNone;
+    }));
+    EXPECT_CALL(mNodeManager, GetNodeInfo).WillRepeatedly(Invoke([](const String& nodeID, NodeInfo& nodeInfo) {
+        nodeInfo.mNodeID = nodeID;
+        nodeInfo.mName   = "snapshot";
+
+        return ErrorEnum::eNone;
+    }));
+
+    auto stream = clientStub->SubscribeNodeChanged(&context, request);
+    ASSERT_NE(stream, nullptr) << "Failed to create client stream";
+
+    stream->WaitForInitialMetadata();
+
+    const auto& metadata = context.GetServerInitialMetadata();
+    auto        it       = metadata.find(cSnapshotSizeMetadataKey);
+
+    ASSERT_NE(it, metadata.end());
+    EXPECT_EQ(std::string(it->second.data(), it->second.size()), "2");
+
+    iamproto::NodeInfo response;
+
+    for (const auto& nodeID : nodeIDs) {
+        ASSERT_TRUE(stream->Read(&response));
+
+        EXPECT_EQ(String(response.node_id().c_str()), nodeID);
+        EXPECT_EQ(response.name(), "snapshot");
+    }
+
+    const auto snapshotSequence = GetSequence(response);
+    ASSERT_TRUE(snapshotSequence.has_value());
+
+    NodeInfo nodeInfo;
+    nodeInfo.mNodeID = "node1";
+    nodeInfo.mName   = "changed";
+
+    mPublicMessageHandler.OnNodeInfoChange(nodeInfo);
+
+    ASSERT_TRUE(stream->Read(&response));
+
+    EXPECT_EQ(response.node_id(), "node1");
+    EXPECT_EQ(response.name(), "changed");
+    EXPECT_EQ(GetSequence(response).value_or(0), *snapshotSequence + 1);
+
+    context.TryCancel();
+
+    auto status = stream->Finish();
+
+    ASSERT_EQ(status.error_code(), grpc::StatusCode::CANCELLED)
+        << status.error_message() << " (" << status.error_code() << ")";
+}
+
+TEST_F(PublicMessageHandlerTest, SubscribeNodeChangedWithFilter)
+{
+    auto clientStub = CreateClientStub<iamproto::IAMPublicNodesService>();
+    ASSERT_NE(clientStub, nullptr) << "Failed to create client stub";
+
+    google::protobuf::Empty request;
+    grpc::ClientContext     context;
+
+    context.AddMetadata(cNodeIDMetadataKey, "node1");
+    context.AddMetadata(cNodeStatusChangesMetadataKey, "true");
+
+    auto stream = clientStub->SubscribeNodeChanged(&context, request);
+    ASSERT_NE(stream, nullptr) << "Failed to create client stream";
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    NodeInfo nodeInfo;
+
+    nodeInfo.mNodeID = "node0";
+    nodeInfo.mStatus = NodeStatusEnum::eProvisioned;
+    mPublicMessageHandler.OnNodeInfoChange(nodeInfo);
+
+    nodeInfo.mNodeID = "node1";
+    mPublicMessageHandler.OnNodeInfoChange(nodeInfo);
+
+    nodeInfo.mName = "renamed";
+    mPublicMessageHandler.OnNodeInfoChange(nodeInfo);
+
+    nodeInfo.mStatus = NodeStatusEnum::ePaused;
+    mPublicMessageHandler.OnNodeInfoChange(nodeInfo);
+
+    iamproto::NodeInfo response;
+
+    ASSERT_TRUE(stream->Read(&response));
+    EXPECT_EQ(response.node_id(), "node1");
+    EXPECT_EQ(response.status(), NodeStatus(NodeStatusEnum::eProvisioned).ToString().CStr());
+
+    ASSERT_TRUE(stream->Read(&response));
+    EXPECT_EQ(response.node_id(), "node1");
+    EXPECT_EQ(response.status(), NodeStatus(NodeStatusEnum::ePaused).ToString().CStr());
+
+    context.TryCancel();
+
+    auto status = stream->Finish();
+
+    ASSERT_EQ(status.error_code(), grpc::StatusCode::CANCELLED)
+        << status.error_message() << " (" << status.error_code() << ")";
+}
+
+TEST_F(PublicMessageHandlerTest, SubscribeNodeChangedResumes)
+{
+    auto clientStub = CreateClientStub<iamproto::IAMPublicNodesService>();
+    ASSERT_NE(clientStub, nullptr) << "Failed to create client stub";
+
+    google::protobuf::Empty request;
+    iamproto::NodeInfo      response;
+    NodeInfo                nodeInfo;
+
+    nodeInfo.mNodeID = "node0";
+    mPublicMessageHandler.OnNodeInfoChange(nodeInfo);
+
+    uint64_t lastSequence = 0, instanceID = 0;
+
+    {
+        grpc::ClientContext context;
+
+        auto stream = clientStub->SubscribeNodeChanged(&context, request);
+        ASSERT_NE(stream, nullptr) << "Failed to create client stream";
+
+        ASSERT_TRUE(stream->Read(&response));
+        EXPECT_EQ(response.node_id(), "node0");
+
+        ASSERT_TRUE(GetSequence(response).has_value());
+        lastSequence = *GetSequence(response);
+
+        ASSERT_TRUE(GetInstanceID(response).has_value());
+        instanceID = *GetInstanceID(response);
+
+        context.TryCancel();
+        stream->Finish();
+    }
+
+    for (const auto& nodeID : {"node1", "node2"}) {
+        nodeInfo.mNodeID = nodeID;
+        mPublicMessageHandler.OnNodeInfoChange(nodeInfo);
+    }
+
+    {
+        grpc::ClientContext context;
+
+        context.AddMetadata(cResumeSequenceMetadataKey, std::to_string(lastSequence));
+        context.AddMetadata(cResumeInstanceMetadataKey, std::to_string(instanceID));
+
+        auto stream = clientStub->SubscribeNodeChanged(&context, request);
+        ASSERT_NE(stream, nullptr) << "Failed to create client stream";
+
+        for (const auto& nodeID : {"node1", "node2"}) {
+            ASSERT_TRUE(stream->Read(&response));
+            EXPECT_EQ(response.node_id(), nodeID);
+            EXPECT_EQ(GetSequence(response).value_or(0), ++lastSequence);
+        }
+
+        context.TryCancel();
+        stream->Finish();
+    }
+
+    // sequence of another process instance is rejected even if the number is known
+    grpc::ClientContext context;
+
+    context.AddMetadata(cResumeSequenceMetadataKey, std::to_string(lastSequence));
+    context.AddMetadata(cResumeInstanceMetadataKey, std::to_string(instanceID + 1));
+
+    auto stream = clientStub->SubscribeNodeChanged(&context, request);
+    ASSERT_NE(stream, nullptr) << "Failed to create client stream";
+
+    EXPECT_FALSE(stream->Read(&response));
+
+    auto status = stream->Finish();
+
+    ASSERT_EQ(status.error_code(), grpc::StatusCode::ABORTED)
+        << status.error_message() << " (" << status.error_code() << ")";
+}
+
+TEST_F(PublicMessageHandlerTest, SubscribeNodeChangedResyncIsRequiredOnHistoryOverrun)
+{
+    // stream writer keeps 64 last notifications
+    constexpr auto cNotificationCount = 65;
+
+    auto clientStub = CreateClientStub<iamproto::IAMPublicNodesService>();
+    ASSERT_NE(clientStub, nullptr) << "Failed to create client stub";
+
+    google::protobuf::Empty request;
+    iamproto::NodeInfo      response;
+    NodeInfo                nodeInfo;
+
+    nodeInfo.mNodeID = "node0";
+    mPublicMessageHandler.OnNodeInfoChange(nodeInfo);
+
+    uint64_t lastSequence = 0, instanceID = 0;
+
+    {
+        grpc::ClientContext context;
+
+        auto stream = clientStub->SubscribeNodeChanged(&context, request);
+        ASSERT_NE(stream, nullptr) << "Failed to create client stream";
+
+        ASSERT_TRUE(stream->Read(&response));
+
+        lastSequence = GetSequence(response).value_or(0);
+        instanceID   = GetInstanceID(response).value_or(0);
+
+        context.TryCancel();
+        stream->Finish();
+    }
+
+    for (auto i = 0; i < cNotificationCount; i++) {
+        nodeInfo.mNodeID = ("node" + std::to_string(i + 1)).c_str();
+        mPublicMessageHandler.OnNodeInfoChange(nodeInfo);
+    }
+
+    grpc::ClientContext context;
+
+    context.AddMetadata(cResumeSequenceMetadataKey, std::to_string(lastSequence));
+    context.AddMetadata(cResumeInstanceMetadataKey, std::to_string(instanceID));
+
+    auto stream = clientStub->SubscribeNodeChanged(&context, request);
+    ASSERT_NE(stream, nullptr) << "Failed to create client stream";
+
+    EXPECT_FALSE(stream->Read(&response));
+
+    auto status = stream->Finish();
+
+    ASSERT_EQ(status.error_code(), grpc::StatusCode::ABORTED)
+        << status.error_message() << " (" << status.error_code() << ")";
+    EXPECT_EQ(status.error_message(), cResyncRequired);
+}
+
 } // namespace aos::iam::iamserver
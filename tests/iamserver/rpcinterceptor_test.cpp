@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <grpcpp/security/credentials.h>
+#include <grpcpp/server_builder.h>
+
+#include <aos/test/log.hpp>
+
+#include <iamanager/version.grpc.pb.h>
+
+#include "iamserver/rpcinterceptor.hpp"
+#include "metrics/metrics.hpp"
+
+using namespace testing;
+
+namespace aos::iam::iamserver {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+constexpr auto cSlowCallThreshold = std::chrono::milliseconds(50);
+
+/***********************************************************************************************************************
+ * Types
+ **********************************************************************************************************************/
+
+class VersionService : public iamanager::IAMVersionService::Service {
+public:
+    grpc::Status GetAPIVersion(
+        grpc::ServerContext*, const google::protobuf::Empty*, iamanager::APIVersion* response) override
+    {
+        std::this_thread::sleep_for(mDelay);
+
+        if (!mStatus.ok()) {
+            return mStatus;
+        }
+
+        response->set_version(5);
+
+        return grpc::Status::OK;
+    }
+
+    std::chrono::milliseconds mDelay {};
+    grpc::Status              mStatus;
+};
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+std::mutex               sLogMutex;
+std::vector<std::string> sLogMessages;
+
+void CollectLog(const String& module, LogLevel level, const String& message)
+{
+    (void)module;
+
+    if (level != LogLevelEnum::eWarning) {
+        return;
+    }
+
+    std::lock_guard lock {sLogMutex};
+
+    sLogMessages.emplace_back(message.CStr());
+}
+
+std::vector<std::string> GetSlowCallMessages()
+{
+    std::lock_guard          lock {sLogMutex};
+    std::vector<std::string> messages;
+
+    for (const auto& message : sLogMessages) {
+        if (message.find("Slow call:") != std::string::npos) {
+            messages.push_back(message);
+        }
+    }
+
+    return messages;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class RPCInterceptorTest : public Test {
+protected:
+    void SetUp() override
+    {
+        test::InitLog();
+
+        {
+            std::lock_guard lock {sLogMutex};
+
+            sLogMessages.clear();
+        }
+
+        Log::SetCallback(CollectLog);
+
+        grpc::ServerBuilder builder;
+        int                 port = 0;
+
+        builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(), &port);
+        builder.RegisterService(&mService);
+        builder.experimental().SetInterceptorCreators(CreateInterceptorFactories(cSlowCallThreshold));
+
+        mServer = builder.BuildAndStart();
+        ASSERT_NE(mServer, nullptr);
+
+        mStub = iamanager::IAMVersionService::NewStub(grpc::CreateChannel(
+            "localhost:" + std::to_string(port), grpc::InsecureChannelCredentials()));
+    }
+
+    void TearDown() override
+    {
+        metrics::SetEnabled(false);
+
+        if (mServer) {
+            mServer->Shutdown();
+            mServer->Wait();
+        }
+
+        test::InitLog();
+    }
+
+    grpc::Status CallGetAPIVersion()
+    {
+        grpc::ClientContext     context;
+        google::protobuf::Empty request;
+        iamanager::APIVersion   response;
+
+        return mStub->GetAPIVersion(&context, request, &response);
+    }
+
+    VersionService                                       mService;
+    std::unique_ptr<grpc::Server>                        mServer;
+    std::unique_ptr<iamanager::IAMVersionService::Stub> mStub;
+};
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST_F(RPCInterceptorTest, CallsAreAccountedInRegistry)
+{
+    metrics::SetEnabled(true);
+
+    ASSERT_TRUE(CallGetAPIVersion().ok());
+    ASSERT_TRUE(CallGetAPIVersion().ok());
+
+    mService.mStatus = grpc::Status(grpc::StatusCode::UNAVAILABLE, "not ready");
+
+    ASSERT_EQ(CallGetAPIVersion().error_code(), grpc::StatusCode::UNAVAILABLE);
+
+    const auto rendered = metrics::GetRegistry().Render();
+
+    EXPECT_THAT(rendered, HasSubstr("aos_iam_rpc_total{method=\"GetAPIVersion\"} 3\n"));
+    EXPECT_THAT(rendered, HasSubstr("aos_iam_rpc_duration_seconds_count{method=\"GetAPIVersion\"} 3\n"));
+    EXPECT_THAT(rendered, HasSubstr("aos_iam_rpc_errors_total{method=\"GetAPIVersion\",code=\"14\"} 1\n"));
+
+    // empty request is serialized to zero bytes
+    EXPECT_THAT(rendered, HasSubstr("aos_iam_rpc_request_bytes_bucket{method=\"GetAPIVersion\",le=\"64\"} 3\n"));
+    EXPECT_THAT(rendered, HasSubstr("aos_iam_rpc_request_bytes_sum{method=\"GetAPIVersion\"} 0\n"));
+
+    // response is sent by successful calls only, version 5 takes two bytes on the wire
+    EXPECT_THAT(rendered, HasSubstr("aos_iam_rpc_response_bytes_count{method=\"GetAPIVersion\"} 2\n"));
+    EXPECT_THAT(rendered, HasSubstr("aos_iam_rpc_response_bytes_sum{method=\"GetAPIVersion\"} 4\n"));
+}
+
+TEST_F(RPCInterceptorTest, SlowCallIsLogged)
+{
+    ASSERT_TRUE(CallGetAPIVersion().ok());
+
+    EXPECT_TRUE(GetSlowCallMessages().empty());
+
+    mService.mDelay = cSlowCallThreshold * 2;
+
+    ASSERT_TRUE(CallGetAPIVersion().ok());
+
+    auto messages = GetSlowCallMessages();
+
+    ASSERT_EQ(messages.size(), 1);
+    EXPECT_THAT(messages[0], HasSubstr("method=GetAPIVersion"));
+    EXPECT_THAT(messages[0], HasSubstr("peer="));
+    EXPECT_THAT(messages[0], HasSubstr("code=0"));
+}
+
+} // namespace aos::iam::iamserver
@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <aos/test/log.hpp>
+
+#include "logger/asynclogger.hpp"
+#include "logger/logmodule.hpp"
+
+using namespace testing;
+
+namespace aos::iam::logger {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+constexpr auto cBenchmarkIterations = 100000;
+constexpr auto cProducerCount       = 4;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+int GetValue(int& counter)
+{
+    return ++counter;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class AsyncLoggerTest : public Test {
+protected:
+    void SetUp() override
+    {
+        test::InitLog();
+        SetLogLevel(LogLevelEnum::eDebug);
+    }
+
+    void TearDown() override
+    {
+        SetLogLevel(LogLevelEnum::eDebug);
+        test::InitLog();
+    }
+
+    AsyncLogger::Sink CollectingSink()
+    {
+        return [this](std::chrono::system_clock::time_point, const char* module, LogLevel, const char* message) {
+            std::lock_guard lock {mMutex};
+
+            mMessages.push_back(std::string(module) + ": " + message);
+        };
+    }
+
+    std::mutex               mMutex;
+    std::vector<std::string> mMessages;
+};
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST_F(AsyncLoggerTest, MessagesAreWrittenInOrder)
+{
+    AsyncLogger logger;
+
+    ASSERT_TRUE(logger.Init(CollectingSink(), LogLevelEnum::eDebug).IsNone());
+    ASSERT_TRUE(logger.Start().IsNone());
+
+    for (int i = 0; i < 100; i++) {
+        LOG_MODULE_DBG("test") << "message " << i;
+    }
+
+    ASSERT_TRUE(logger.Stop().IsNone());
+
+    ASSERT_EQ(mMessages.size(), 100);
+
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(mMessages[i], "test: message " + std::to_string(i));
+    }
+
+    EXPECT_EQ(logger.GetDroppedCount(), 0);
+}
+
+TEST_F(AsyncLoggerTest, MessagesBelowLevelAreSkipped)
+{
+    AsyncLogger logger;
+
+    ASSERT_TRUE(logger.Init(CollectingSink(), LogLevelEnum::eWarning).IsNone());
+    ASSERT_TRUE(logger.Start().IsNone());
+
+    LOG_MODULE_INF("test") << "info";
+    LOG_MODULE_WRN("test") << "warning";
+
+    ASSERT_TRUE(logger.Stop().IsNone());
+
+    EXPECT_THAT(mMessages, ElementsAre("test: warning"));
+}
+
+TEST_F(AsyncLoggerTest, MessagesAreWrittenSynchronouslyAfterStop)
+{
+    AsyncLogger logger;
+
+    ASSERT_TRUE(logger.Init(CollectingSink(), LogLevelEnum::eDebug).IsNone());
+    ASSERT_TRUE(logger.Start().IsNone());
+    ASSERT_TRUE(logger.Stop().IsNone());
+
+    LOG_MODULE_ERR("test") << "after stop";
+
+    EXPECT_THAT(mMessages, ElementsAre("test: after stop"));
+}
+
+TEST_F(AsyncLoggerTest, QueueOverflowDropsMessages)
+{
+    std::promise<void> release;
+    auto               released = release.get_future().share();
+    AsyncLogger        logger;
+
+    auto sink = [&, collect = CollectingSink()](std::chrono::system_clock::time_point time, const char* module,
+                    LogLevel level, const char* message) {
+        released.wait();
+        collect(time, module, level, message);
+    };
+
+    ASSERT_TRUE(logger.Init(sink, LogLevelEnum::eDebug).IsNone());
+    ASSERT_TRUE(logger.Start().IsNone());
+
+    for (size_t i = 0; i < AsyncLogger::cQueueSize * 2; i++) {
+        LOG_MODULE_DBG("test") << "message " << i;
+    }
+
+    EXPECT_GE(logger.GetDroppedCount(), AsyncLogger::cQueueSize - 1);
+
+    release.set_value();
+
+    ASSERT_TRUE(logger.Stop().IsNone());
+
+    EXPECT_EQ(mMessages.size(), AsyncLogger::cQueueSize * 2 - logger.GetDroppedCount() + 1);
+    EXPECT_THAT(mMessages.back(), StartsWith("logger: Log messages dropped"));
+}
+
+TEST_F(AsyncLoggerTest, DisabledLevelArgumentsAreNotEvaluated)
+{
+    int counter = 0;
+
+    SetLogLevel(LogLevelEnum::eInfo);
+
+    LOG_DBG() << "value: " << GetValue(counter);
+    EXPECT_EQ(counter, 0);
+
+    LOG_INF() << "value: " << GetValue(counter);
+    EXPECT_EQ(counter, 1);
+
+    SetLogLevel(LogLevelEnum::eError);
+
+    LOG_INF() << "value: " << GetValue(counter);
+    LOG_WRN() << "value: " << GetValue(counter);
+    EXPECT_EQ(counter, 2);
+}
+
+TEST_F(AsyncLoggerTest, MessagesLoggedDuringStopAreNotLost)
+{
+    AsyncLogger              logger;
+    std::atomic_bool         stop = false;
+    std::atomic<size_t>      logged {0};
+    std::vector<std::thread> producers;
+
+    ASSERT_TRUE(logger.Init(CollectingSink(), LogLevelEnum::eDebug).IsNone());
+    ASSERT_TRUE(logger.Start().IsNone());
+
+    for (int i = 0; i < cProducerCount; i++) {
+        producers.emplace_back([&]() {
+            while (!stop) {
+                LOG_MODULE_DBG("test") << "message";
+                logged++;
+            }
+        });
+    }
+
+    while (logged < AsyncLogger::cQueueSize) {
+        std::this_thread::yield();
+    }
+
+    ASSERT_TRUE(logger.Stop().IsNone());
+
+    stop = true;
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    std::lock_guard lock {mMutex};
+
+    size_t written = std::count(mMessages.begin(), mMessages.end(), "test: message");
+
+    EXPECT_EQ(written + logger.GetDroppedCount(), logged.load());
+}
+
+TEST_F(AsyncLoggerTest, DISABLED_Benchmark)
+{
+    AsyncLogger logger;
+
+    ASSERT_TRUE(logger.Init(
+                          [](std::chrono::system_clock::time_point, const char*, LogLevel, const char*) {},
+                          LogLevelEnum::eDebug)
+                    .IsNone());
+    ASSERT_TRUE(logger.Start().IsNone());
+
+    // logs the same statements as a node info request forwarded through the node controller
+    auto handleRPC = [](int seq) {
+        LOG_DBG() << "Process get node info: nodeID=" << "node0";
+        LOG_DBG() << "Get node controller stream handler: nodeID=" << "node0";
+        LOG_DBG() << "Receive message: type=" << seq % 16;
+        LOG_DBG() << "Received node info: nodeID=" << "node0" << ", status=" << "provisioned";
+    };
+
+    auto measure = [&handleRPC](LogLevelEnum level) {
+        std::vector<std::thread> handlers;
+
+        SetLogLevel(level);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < cProducerCount; i++) {
+            handlers.emplace_back([&handleRPC]() {
+                for (int seq = 0; seq < cBenchmarkIterations; seq++) {
+                    handleRPC(seq);
+                }
+            });
+        }
+
+        for (auto& handler : handlers) {
+            handler.join();
+        }
+
+        // handler threads run in parallel, so wall time per handler iteration is the RPC cost seen by a handler
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()
+            / cBenchmarkIterations;
+    };
+
+    auto debugNs = measure(LogLevelEnum::eDebug);
+    auto infoNs  = measure(LogLevelEnum::eInfo);
+
+    ASSERT_TRUE(logger.Stop().IsNone());
+
+    std::cout << "Logging overhead per RPC on " << cProducerCount << " handler threads at debug level: " << debugNs
+              << " ns, at info level: " << infoNs << " ns, dropped: " << logger.GetDroppedCount() << std::endl;
+}
+
+} // namespace aos::iam::logger
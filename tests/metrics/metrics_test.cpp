@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <sstream>
+
+#include <gmock/gmock.h>
+
+#include <Poco/Net/HTTPClientSession.h>
+#include <Poco/Net/HTTPRequest.h>
+#include <Poco/Net/HTTPResponse.h>
+#include <Poco/StreamCopier.h>
+
+#include <aos/test/log.hpp>
+
+#include "metrics/metricsserver.hpp"
+
+using namespace testing;
+
+namespace aos::iam::metrics {
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class MetricsTest : public Test {
+protected:
+    void SetUp() override
+    {
+        test::InitLog();
+        SetEnabled(true);
+    }
+
+    void TearDown() override { SetEnabled(false); }
+
+    Registry mRegistry;
+};
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST_F(MetricsTest, RenderCounterAndGauge)
+{
+    mRegistry.GetCounter("aos_iam_test_total", "Test counter", {{"method", "Get\"Cert"}}).Inc(3);
+    mRegistry.GetGauge("aos_iam_test_active", "Test gauge").Set(-2);
+
+    EXPECT_EQ(mRegistry.Render(),
+        "# HELP aos_iam_test_active Test gauge\n"
+        "# TYPE aos_iam_test_active gauge\n"
+        "aos_iam_test_active -2\n"
+        "# HELP aos_iam_test_total Test counter\n"
+        "# TYPE aos_iam_test_total counter\n"
+        "aos_iam_test_total{method=\"Get\\\"Cert\"} 3\n");
+}
+
+TEST_F(MetricsTest, RenderHistogram)
+{
+    auto& histogram = mRegistry.GetHistogram("aos_iam_test_seconds", "Test histogram", {{"op", "get"}}, {0.1, 1});
+
+    histogram.Observe(0.05);
+    histogram.Observe(0.5);
+    histogram.Observe(2);
+
+    EXPECT_EQ(mRegistry.Render(),
+        "# HELP aos_iam_test_seconds Test histogram\n"
+        "# TYPE aos_iam_test_seconds histogram\n"
+        "aos_iam_test_seconds_bucket{op=\"get\",le=\"0.1\"} 1\n"
+        "aos_iam_test_seconds_bucket{op=\"get\",le=\"1\"} 2\n"
+        "aos_iam_test_seconds_bucket{op=\"get\",le=\"+Inf\"} 3\n"
+        "aos_iam_test_seconds_sum{op=\"get\"} 2.55\n"
+        "aos_iam_test_seconds_count{op=\"get\"} 3\n");
+}
+
+TEST_F(MetricsTest, SameMetricIsReturnedForSameLabels)
+{
+    auto& counter1 = mRegistry.GetCounter("aos_iam_test_total", "Test counter", {{"method", "A"}});
+    auto& counter2 = mRegistry.GetCounter("aos_iam_test_total", "Test counter", {{"method", "A"}});
+    auto& counter3 = mRegistry.GetCounter("aos_iam_test_total", "Test counter", {{"method", "B"}});
+
+    EXPECT_EQ(&counter1, &counter2);
+    EXPECT_NE(&counter1, &counter3);
+    EXPECT_THROW(mRegistry.GetGauge("aos_iam_test_total", "Test gauge"), std::exception);
+}
+
+TEST_F(MetricsTest, UpdatesAreSkippedWhenDisabled)
+{
+    auto& counter = mRegistry.GetCounter("aos_iam_test_total", "Test counter");
+
+    SetEnabled(false);
+    counter.Inc();
+
+    SetEnabled(true);
+    counter.Inc();
+
+    EXPECT_EQ(counter.Get(), 1);
+}
+
+TEST_F(MetricsTest, ScopedGaugeKeepsEnabledStateOfCreation)
+{
+    auto& gauge = mRegistry.GetGauge("aos_iam_test_active", "Test gauge");
+
+    {
+        ScopedGauge scoped {gauge};
+
+        EXPECT_EQ(gauge.Get(), 1);
+
+        SetEnabled(false);
+    }
+
+    EXPECT_EQ(gauge.Get(), 0);
+
+    {
+        ScopedGauge scoped {gauge};
+
+        SetEnabled(true);
+    }
+
+    EXPECT_EQ(gauge.Get(), 0);
+}
+
+TEST_F(MetricsTest, ServerExposesMetrics)
+{
+    MetricsServer server;
+
+    mRegistry.GetCounter("aos_iam_test_total", "Test counter").Inc();
+
+    ASSERT_TRUE(server.Start("localhost:0", mRegistry).IsNone());
+
+    Poco::Net::HTTPClientSession session("localhost", server.GetPort());
+    Poco::Net::HTTPRequest       request(Poco::Net::HTTPRequest::HTTP_GET, MetricsServer::cMetricsPath);
+    Poco::Net::HTTPResponse      response;
+
+    session.sendRequest(request);
+
+    std::ostringstream body;
+
+    Poco::StreamCopier::copyStream(session.receiveResponse(response), body);
+
+    EXPECT_EQ(response.getStatus(), Poco::Net::HTTPResponse::HTTP_OK);
+    EXPECT_THAT(body.str(), HasSubstr("aos_iam_test_total 1\n"));
+
+    EXPECT_TRUE(server.Stop().IsNone());
+    EXPECT_FALSE(IsEnabled());
+}
+
+} // namespace aos::iam::metrics
@@ -5,9 +5,14 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
 #include <array>
+#include <condition_variable>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <sys/utsname.h>
 #include <thread>
 
@@ -99,6 +104,53 @@ iam::config::NodeInfoConfig CreateConfig()
     return config;
 }
 
+void WriteFile(const std::string& path, const std::string& content)
+{
+    std::ofstream file(path, std::ios_base::out | std::ios_base::trunc);
+
+    file << content;
+}
+
+class NodeInfoObserverStub : public NodeInfoObserverItf {
+public:
+    void OnNodeInfoUpdated(const NodeInfo& info) override
+    {
+        std::lock_guard lock {mMutex};
+
+        *mNodeInfo = info;
+
+        mCondVar.notify_all();
+    }
+
+    bool WaitUsedRAM(const std::string& usedRAM)
+    {
+        return Wait([&](const NodeInfo& info) {
+            return std::any_of(info.mAttrs.begin(), info.mAttrs.end(), [&](const NodeAttribute& attribute) {
+                return std::string(attribute.mName.CStr()) == "UsedRAM" && usedRAM == attribute.mValue.CStr();
+            });
+        });
+    }
+
+    bool WaitPartitionSize(size_t index)
+    {
+        return Wait([&](const NodeInfo& info) {
+            return index < info.mPartitions.Size() && info.mPartitions[index].mTotalSize > 0;
+        });
+    }
+
+private:
+    bool Wait(const std::function<bool(const NodeInfo&)>& condition)
+    {
+        std::unique_lock lock {mMutex};
+
+        return mCondVar.wait_for(lock, std::chrono::seconds(5), [&]() { return condition(*mNodeInfo); });
+    }
+
+    std::mutex                mMutex;
+    std::condition_variable   mCondVar;
+    std::unique_ptr<NodeInfo> mNodeInfo = std::make_unique<NodeInfo>();
+};
+
 std::string GetCPUArch()
 {
     struct utsname buffer;
@@ -245,6 +297,41 @@ TEST_F(NodeInfoProviderTest, InitFailsIfConfigAttributesExceedMaxAllowed)
     EXPECT_TRUE(err.Is(ErrorEnum::eNoMemory)) << "Init should return no memory error, err = " << err.Message();
 }
 
+TEST_F(NodeInfoProviderTest, InitSucceedsIfEffectiveCapacityExceedsMaxAttributes)
+{
+    const std::string cProcCGroupPath = TEST_TMP_DIR "/cgroup";
+    const std::string cCGroupRootPath = TEST_TMP_DIR "/sys/fs/cgroup";
+
+    std::filesystem::create_directories(cCGroupRootPath + "/system.slice");
+
+    WriteFile(cProcCGroupPath, "0::/system.slice\n");
+    WriteFile(cCGroupRootPath + "/cpuset.cpus.effective", "0-7\n");
+    WriteFile(cCGroupRootPath + "/system.slice/cpu.max", "150000 100000\n");
+    WriteFile(cCGroupRootPath + "/system.slice/memory.max", "1073741824\n");
+
+    iam::config::NodeInfoConfig config = CreateConfig();
+
+    config.mProcCGroupPath = cProcCGroupPath;
+    config.mCGroupRootPath = cCGroupRootPath;
+    config.mAttrs.clear();
+
+    for (size_t i = 0; i < cMaxNumNodeAttributes; ++i) {
+        config.mAttrs[std::to_string(i).append("-name")] = std::to_string(i).append("-value");
+    }
+
+    NodeInfoProvider provider;
+
+    auto err = provider.Init(config);
+    ASSERT_TRUE(err.IsNone()) << "Init should succeed, err = " << err.Message();
+
+    auto nodeInfo = std::make_unique<NodeInfo>();
+
+    err = provider.GetNodeInfo(*nodeInfo);
+    ASSERT_TRUE(err.IsNone()) << "GetNodeInfo should succeed, err = " << err.Message();
+
+    EXPECT_EQ(nodeInfo->mAttrs.Size(), cMaxNumNodeAttributes);
+}
+
 TEST_F(NodeInfoProviderTest, InitSucceedsOnNonStandardProcFile)
 {
     NodeInfoProvider provider;
@@ -319,6 +406,28 @@ TEST_F(NodeInfoProviderTest, GetNodeInfoSucceeds)
     ASSERT_EQ(nodeInfo.mCPUs.Size(), 3) << "Invalid number of CPUs";
 }
 
+TEST_F(NodeInfoProviderTest, GetNodeInfoReportsPartitionSize)
+{
+    iam::config::NodeInfoConfig config = CreateConfig();
+
+    config.mPartitions
+        = {{"Name1", {"Type1"}, TEST_TMP_DIR}, {"Name2", {"Type2"}, TEST_TMP_DIR "/not-exist"}};
+    config.mPartitionProbeTimeout = 5 * Time::cSeconds;
+
+    NodeInfoProvider provider;
+    NodeInfo         nodeInfo;
+
+    auto err = provider.Init(config);
+    ASSERT_TRUE(err.IsNone()) << "Init should succeed, err = " << err.Message();
+
+    err = provider.GetNodeInfo(nodeInfo);
+    ASSERT_TRUE(err.IsNone()) << "GetNodeInfo should succeed, err = " << err.Message();
+
+    ASSERT_EQ(nodeInfo.mPartitions.Size(), 2);
+    EXPECT_GT(nodeInfo.mPartitions[0].mTotalSize, 0);
+    EXPECT_EQ(nodeInfo.mPartitions[1].mTotalSize, 0);
+}
+
 TEST_F(NodeInfoProviderTest, GetNodeInfoReadsProvisioningStatusFromFile)
 {
     const iam::config::NodeInfoConfig config = CreateConfig();
@@ -447,4 +556,90 @@ TEST_F(NodeInfoProviderTest, ObserversAreNotifiedOnStatusChange)
     EXPECT_TRUE(err.IsNone()) << "SetNodeStatus should succeed, err=" << err.Message();
 }
 
+TEST_F(NodeInfoProviderTest, NodeInfoObserversAreNotifiedOnResourceSample)
+{
+    constexpr auto cMemInfo1 = "MemTotal:       16384 kB\nMemAvailable:    8192 kB\n";
+    constexpr auto cMemInfo2 = "MemTotal:       16384 kB\nMemAvailable:    4096 kB\n";
+
+    NodeInfoObserverStub observer;
+    NodeInfoProvider     provider;
+
+    iam::config::NodeInfoConfig config = CreateConfig();
+
+    config.mResourceSampler.mInterval         = 100 * Time::cMilliseconds;
+    config.mResourceSampler.mSampleRAM        = true;
+    config.mResourceSampler.mSampleCPU        = false;
+    config.mResourceSampler.mSamplePartitions = false;
+
+    WriteFile(cMemInfoPath, cMemInfo1);
+
+    auto err = provider.Init(config);
+    ASSERT_TRUE(err.IsNone()) << "Init should succeed, err=" << err.Message();
+
+    err = provider.SubscribeNodeInfoUpdated(observer);
+    ASSERT_TRUE(err.IsNone()) << "SubscribeNodeInfoUpdated should succeed, err=" << err.Message();
+
+    err = provider.Start();
+    ASSERT_TRUE(err.IsNone()) << "Start should succeed, err=" << err.Message();
+
+    EXPECT_TRUE(observer.WaitUsedRAM(std::to_string((16384 - 8192) * 1024)));
+
+    WriteFile(cMemInfoPath, cMemInfo2);
+
+    EXPECT_TRUE(observer.WaitUsedRAM(std::to_string((16384 - 4096) * 1024)))
+        << "Used RAM must be updated on next sample";
+
+    err = provider.Stop();
+    ASSERT_TRUE(err.IsNone()) << "Stop should succeed, err=" << err.Message();
+
+    err = provider.UnsubscribeNodeInfoUpdated(observer);
+    ASSERT_TRUE(err.IsNone()) << "UnsubscribeNodeInfoUpdated should succeed, err=" << err.Message();
+}
+
+TEST_F(NodeInfoProviderTest, FailedPartitionProbeIsRetried)
+{
+    const std::string cLatePartitionPath = TEST_TMP_DIR "/late-partition";
+
+    NodeInfoObserverStub observer;
+    NodeInfoProvider     provider;
+
+    iam::config::NodeInfoConfig config = CreateConfig();
+
+    config.mPartitions            = {{"Name1", {"Type1"}, cLatePartitionPath}};
+    config.mPartitionProbeTimeout = 100 * Time::cMilliseconds;
+
+    auto err = provider.Init(config);
+    ASSERT_TRUE(err.IsNone()) << "Init should succeed, err=" << err.Message();
+
+    auto nodeInfo = std::make_unique<NodeInfo>();
+
+    err = provider.GetNodeInfo(*nodeInfo);
+    ASSERT_TRUE(err.IsNone()) << "GetNodeInfo should succeed, err=" << err.Message();
+
+    ASSERT_EQ(nodeInfo->mPartitions.Size(), 1);
+    EXPECT_EQ(nodeInfo->mPartitions[0].mTotalSize, 0);
+
+    // partition is mounted after init
+    std::filesystem::create_directory(cLatePartitionPath);
+
+    err = provider.SubscribeNodeInfoUpdated(observer);
+    ASSERT_TRUE(err.IsNone()) << "SubscribeNodeInfoUpdated should succeed, err=" << err.Message();
+
+    err = provider.Start();
+    ASSERT_TRUE(err.IsNone()) << "Start should succeed, err=" << err.Message();
+
+    EXPECT_TRUE(observer.WaitPartitionSize(0)) << "Observers must be notified about late partition size";
+
+    err = provider.GetNodeInfo(*nodeInfo);
+    ASSERT_TRUE(err.IsNone()) << "GetNodeInfo should succeed, err=" << err.Message();
+
+    EXPECT_GT(nodeInfo->mPartitions[0].mTotalSize, 0);
+
+    err = provider.Stop();
+    ASSERT_TRUE(err.IsNone()) << "Stop should succeed, err=" << err.Message();
+
+    err = provider.UnsubscribeNodeInfoUpdated(observer);
+    ASSERT_TRUE(err.IsNone()) << "UnsubscribeNodeInfoUpdated should succeed, err=" << err.Message();
+}
+
 } // namespace aos::iam::nodeinfoprovider
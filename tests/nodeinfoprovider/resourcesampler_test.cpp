@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <filesystem>
+#include <fstream>
+
+#include <gmock/gmock.h>
+
+#include <aos/test/log.hpp>
+
+#include "nodeinfoprovider/resourcesampler.hpp"
+
+using namespace testing;
+
+namespace aos::iam::nodeinfoprovider {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+#define TEST_TMP_DIR "test-sampler-tmp"
+
+const std::string cMemInfoPath        = TEST_TMP_DIR "/meminfo";
+const std::string cStatPath           = TEST_TMP_DIR "/stat";
+constexpr auto    cMemInfoFileContent = R"(MemTotal:       16384 kB
+MemFree:         1024 kB
+MemAvailable:    4096 kB
+Buffers:          512 kB
+)";
+constexpr auto    cStatFileContent1   = R"(cpu  100 0 100 700 100 0 0 0 0 0
+cpu0 100 0 100 700 100 0 0 0 0 0
+intr 1000
+)";
+constexpr auto    cStatFileContent2   = R"(cpu  200 0 200 1500 100 0 0 0 0 0
+cpu0 200 0 200 1500 100 0 0 0 0 0
+intr 2000
+)";
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+void WriteFile(const std::string& path, const std::string& content)
+{
+    std::ofstream file(path, std::ios_base::out | std::ios_base::trunc);
+
+    file << content;
+}
+
+iam::config::NodeInfoConfig CreateConfig()
+{
+    iam::config::NodeInfoConfig config;
+
+    config.mMemInfoPath = cMemInfoPath;
+    config.mStatPath    = cStatPath;
+    config.mPartitions  = {{"root", {"generic"}, TEST_TMP_DIR}};
+
+    config.mResourceSampler.mInterval         = Time::cSeconds;
+    config.mResourceSampler.mSampleCPU        = true;
+    config.mResourceSampler.mSampleRAM        = true;
+    config.mResourceSampler.mSamplePartitions = true;
+
+    return config;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class ResourceSamplerTest : public Test {
+protected:
+    void SetUp() override
+    {
+        test::InitLog();
+
+        std::filesystem::create_directory(TEST_TMP_DIR);
+
+        WriteFile(cMemInfoPath, cMemInfoFileContent);
+        WriteFile(cStatPath, cStatFileContent1);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(TEST_TMP_DIR); }
+};
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST_F(ResourceSamplerTest, SamplingIsDisabledByDefault)
+{
+    ResourceSampler sampler;
+
+    auto config = CreateConfig();
+
+    config.mResourceSampler = {};
+
+    ASSERT_TRUE(sampler.Init(config).IsNone());
+    EXPECT_FALSE(sampler.IsEnabled());
+    EXPECT_TRUE(sampler.Start().IsNone());
+    EXPECT_TRUE(sampler.Stop().IsNone());
+}
+
+TEST_F(ResourceSamplerTest, SampleRAMAndPartitions)
+{
+    ResourceSampler sampler;
+
+    ASSERT_TRUE(sampler.Init(CreateConfig()).IsNone());
+
+    ResourceUsage usage;
+
+    ASSERT_TRUE(sampler.GetResourceUsage(usage).IsNone());
+
+    EXPECT_EQ(usage.mTotalRAM, 16384 * 1024);
+    EXPECT_EQ(usage.mUsedRAM, (16384 - 4096) * 1024);
+
+    ASSERT_EQ(usage.mPartitions.size(), 1);
+    EXPECT_EQ(usage.mPartitions[0].mName, "root");
+    EXPECT_GT(usage.mPartitions[0].mTotalSize, 0);
+    EXPECT_LE(usage.mPartitions[0].mUsedSize, usage.mPartitions[0].mTotalSize);
+}
+
+TEST_F(ResourceSamplerTest, SampleCPULoad)
+{
+    ResourceSampler sampler;
+
+    ASSERT_TRUE(sampler.Init(CreateConfig()).IsNone());
+
+    ResourceUsage usage;
+
+    ASSERT_TRUE(sampler.GetResourceUsage(usage).IsNone());
+    EXPECT_DOUBLE_EQ(usage.mCPULoad, 0.0);
+
+    WriteFile(cStatPath, cStatFileContent2);
+
+    ASSERT_TRUE(sampler.Sample().IsNone());
+    ASSERT_TRUE(sampler.GetResourceUsage(usage).IsNone());
+
+    // total delta: 1000, idle delta: 800
+    EXPECT_DOUBLE_EQ(usage.mCPULoad, 20.0);
+}
+
+TEST_F(ResourceSamplerTest, SampleFailsIfMemInfoNotFound)
+{
+    ResourceSampler sampler;
+
+    std::filesystem::remove(cMemInfoPath);
+
+    EXPECT_TRUE(sampler.Init(CreateConfig()).Is(ErrorEnum::eNotFound));
+}
+
+TEST_F(ResourceSamplerTest, StartStop)
+{
+    ResourceSampler sampler;
+
+    ASSERT_TRUE(sampler.Init(CreateConfig()).IsNone());
+    EXPECT_TRUE(sampler.Start().IsNone());
+    EXPECT_TRUE(sampler.Stop().IsNone());
+}
+
+} // namespace aos::iam::nodeinfoprovider
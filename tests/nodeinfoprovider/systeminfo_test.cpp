@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+#include <gmock/gmock.h>
+
+#include <aos/test/log.hpp>
+
+#include "nodeinfoprovider/systeminfo.hpp"
+
+using namespace testing;
+
+namespace aos::iam::nodeinfoprovider::utils {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+#define TEST_TMP_DIR "test-systeminfo-tmp"
+
+const std::string cCPUInfoPath           = TEST_TMP_DIR "/cpuinfo";
+const std::string cMemInfoPath           = TEST_TMP_DIR "/meminfo";
+const std::string cProcCGroupPath        = TEST_TMP_DIR "/cgroup";
+const std::string cCGroupRootPath        = TEST_TMP_DIR "/sys/fs/cgroup";
+const std::string cCGroupSlicePath       = cCGroupRootPath + "/system.slice";
+const std::string cCGroupServicePath     = cCGroupSlicePath + "/aos-iam.service";
+constexpr auto    cNumSockets            = 2;
+constexpr auto    cNumProcessorPerSocket = 96;
+constexpr auto    cBenchmarkIterations   = 1000;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+// Mimics /proc/cpuinfo of a two socket x86 server.
+std::string CreateServerCPUInfo()
+{
+    std::ostringstream content;
+
+    for (auto socket = 0; socket < cNumSockets; socket++) {
+        for (auto processor = 0; processor < cNumProcessorPerSocket; processor++) {
+            content << "processor\t: " << socket * cNumProcessorPerSocket + processor << "\n"
+                    << "vendor_id\t: GenuineIntel\n"
+                    << "cpu family\t: 6\n"
+                    << "model\t\t: 143\n"
+                    << "model name\t: Intel(R) Xeon(R) Platinum 8468 socket " << socket << "\n"
+                    << "stepping\t: 8\n"
+                    << "cpu MHz\t\t: 2100.000\n"
+                    << "cache size\t: 107520 KB\n"
+                    << "physical id\t: " << socket << "\n"
+                    << "siblings\t: " << cNumProcessorPerSocket << "\n"
+                    << "core id\t\t: " << processor / 2 << "\n"
+                    << "cpu cores\t: " << cNumProcessorPerSocket / 2 << "\n"
+                    << "flags\t\t: fpu vme de pse tsc msr pae mce cx8 apic sep mtrr pge mca cmov pat pse36 clflush dts "
+                       "acpi mmx fxsr sse sse2 ss ht tm pbe syscall nx pdpe1gb rdtscp lm constant_tsc arch_perfmon "
+                       "pebs bts rep_good nopl xtopology nonstop_tsc cpuid aperfmperf pni pclmulqdq dtes64 monitor "
+                       "avx512f avx512dq rdseed adx smap avx512ifma clflushopt clwb intel_pt avx512cd sha_ni amx_tile\n"
+                    << "bogomips\t: 4200.00\n"
+                    << "address sizes\t: 46 bits physical, 57 bits virtual\n"
+                    << "power management:\n\n";
+        }
+    }
+
+    return content.str();
+}
+
+std::string CreateServerMemInfo()
+{
+    return "MemTotal:       1056323544 kB\n"
+           "MemFree:        1003345184 kB\n"
+           "MemAvailable:   1040253116 kB\n"
+           "Buffers:          1123412 kB\n"
+           "Cached:          38912744 kB\n"
+           "SwapCached:             0 kB\n"
+           "Active:          17238044 kB\n"
+           "Inactive:        26342812 kB\n"
+           "HugePages_Total:        0\n"
+           "Hugepagesize:       2048 kB\n";
+}
+
+void WriteFile(const std::string& path, const std::string& content)
+{
+    std::ofstream file(path, std::ios_base::out | std::ios_base::trunc);
+
+    file << content;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class SystemInfoTest : public Test {
+protected:
+    void SetUp() override
+    {
+        test::InitLog();
+
+        std::filesystem::create_directory(TEST_TMP_DIR);
+
+        WriteFile(cCPUInfoPath, CreateServerCPUInfo());
+        WriteFile(cMemInfoPath, CreateServerMemInfo());
+    }
+
+    void TearDown() override { std::filesystem::remove_all(TEST_TMP_DIR); }
+};
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST_F(SystemInfoTest, GetCPUInfoOnServer)
+{
+    auto cpuInfos = std::make_unique<StaticArray<CPUInfo, cMaxNumCPUs>>();
+
+    ASSERT_TRUE(GetCPUInfo(cCPUInfoPath, *cpuInfos).IsNone());
+    ASSERT_EQ(cpuInfos->Size(), cNumSockets);
+
+    for (size_t i = 0; i < cpuInfos->Size(); i++) {
+        const auto& cpuInfo = (*cpuInfos)[i];
+
+        EXPECT_EQ(cpuInfo.mNumCores, cNumProcessorPerSocket / 2);
+        EXPECT_EQ(cpuInfo.mNumThreads, cNumProcessorPerSocket);
+        EXPECT_STREQ(cpuInfo.mArch.CStr(), "6");
+        EXPECT_STREQ(cpuInfo.mModelName.CStr(),
+            ("Intel(R) Xeon(R) Platinum 8468 socket " + std::to_string(i)).c_str());
+    }
+}
+
+TEST_F(SystemInfoTest, GetMemTotalOnServer)
+{
+    auto [memTotal, err] = GetMemTotal(cMemInfoPath);
+
+    ASSERT_TRUE(err.IsNone());
+    EXPECT_EQ(memTotal, 1056323544ULL * 1024);
+}
+
+TEST_F(SystemInfoTest, ParseMemUsageWithoutMemAvailable)
+{
+    MemUsage memUsage;
+
+    ASSERT_TRUE(ParseMemUsage("MemTotal: 2048 kB\nMemFree: 1024 kB\n", memUsage).IsNone());
+    EXPECT_EQ(memUsage.mTotal, 2048 * 1024);
+    EXPECT_EQ(memUsage.mAvailable, 1024 * 1024);
+}
+
+TEST_F(SystemInfoTest, ProbeMountFSUsage)
+{
+    auto probe = ProbeMountFSUsage(TEST_TMP_DIR);
+
+    ASSERT_EQ(probe.wait_for(cDefaultProbeTimeout), std::future_status::ready);
+
+    const auto& [usage, err] = probe.get();
+
+    ASSERT_TRUE(err.IsNone());
+    EXPECT_GT(usage.mTotalSize, 0);
+    EXPECT_LE(usage.mUsedSize, usage.mTotalSize);
+
+    probe = ProbeMountFSUsage(TEST_TMP_DIR "/not-exist");
+
+    ASSERT_EQ(probe.wait_for(cDefaultProbeTimeout), std::future_status::ready);
+    EXPECT_FALSE(probe.get().mError.IsNone());
+}
+
+TEST_F(SystemInfoTest, GetCGroupLimits)
+{
+    std::filesystem::create_directories(cCGroupServicePath);
+
+    WriteFile(cProcCGroupPath, "1:name=systemd:/\n0::/system.slice/aos-iam.service\n");
+    WriteFile(cCGroupRootPath + "/cpuset.cpus.effective", "0-7\n");
+    WriteFile(cCGroupSlicePath + "/cpu.max", "max 100000\n");
+    WriteFile(cCGroupSlicePath + "/memory.max", "1073741824\n");
+    WriteFile(cCGroupServicePath + "/cpu.max", "150000 100000\n");
+    WriteFile(cCGroupServicePath + "/memory.max", "max\n");
+    WriteFile(cCGroupServicePath + "/cpuset.cpus.effective", "0-1,4\n");
+
+    auto [limits, err] = GetCGroupLimits(cProcCGroupPath, cCGroupRootPath);
+
+    ASSERT_TRUE(err.IsNone());
+    EXPECT_DOUBLE_EQ(limits.mCPUQuota, 1.5);
+    EXPECT_EQ(limits.mNumCPUs, 3);
+    EXPECT_EQ(limits.mMemLimit, 1073741824);
+
+    WriteFile(cProcCGroupPath, "1:name=systemd:/\n");
+
+    EXPECT_TRUE(GetCGroupLimits(cProcCGroupPath, cCGroupRootPath).mError.Is(ErrorEnum::eNotFound));
+}
+
+TEST_F(SystemInfoTest, ParseCGroupFiles)
+{
+    double   cpuQuota = 0.0;
+    uint64_t value    = 0;
+
+    EXPECT_TRUE(ParseCPUMax("max 100000\n", cpuQuota).IsNone());
+    EXPECT_DOUBLE_EQ(cpuQuota, 0.0);
+    EXPECT_FALSE(ParseCPUMax("50000\n", cpuQuota).IsNone());
+
+    EXPECT_TRUE(ParseCPUList("0-3,8,10-11\n", value).IsNone());
+    EXPECT_EQ(value, 7);
+    EXPECT_FALSE(ParseCPUList("3-1\n", value).IsNone());
+
+    EXPECT_TRUE(ParseMemoryMax("max\n", value).IsNone());
+    EXPECT_EQ(value, 0);
+    EXPECT_FALSE(ParseMemoryMax("unlimited\n", value).IsNone());
+}
+
+// Run with --gtest_also_run_disabled_tests to get parser timings.
+TEST_F(SystemInfoTest, DISABLED_ParserBenchmark)
+{
+    auto cpuInfos = std::make_unique<StaticArray<CPUInfo, cMaxNumCPUs>>();
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i < cBenchmarkIterations; i++) {
+        cpuInfos->Clear();
+
+        ASSERT_TRUE(GetCPUInfo(cCPUInfoPath, *cpuInfos).IsNone());
+    }
+
+    auto cpuInfoTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i < cBenchmarkIterations; i++) {
+        ASSERT_TRUE(GetMemTotal(cMemInfoPath).mError.IsNone());
+    }
+
+    auto memInfoTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << "GetCPUInfo: " << std::chrono::duration_cast<std::chrono::microseconds>(cpuInfoTime).count()
+              << " us per " << cBenchmarkIterations << " iterations" << std::endl;
+    std::cout << "GetMemTotal: " << std::chrono::duration_cast<std::chrono::microseconds>(memInfoTime).count()
+              << " us per " << cBenchmarkIterations << " iterations" << std::endl;
+}
+
+} // namespace aos::iam::nodeinfoprovider::utils
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+
+#include "tracer/span.hpp"
+
+using namespace testing;
+
+namespace aos::iam::tracer {
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class SpanTest : public Test { };
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST_F(SpanTest, TraceParent)
+{
+    const std::string traceParent = "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01";
+
+    auto context = ParseTraceParent(traceParent);
+
+    ASSERT_TRUE(context.has_value());
+    EXPECT_EQ(context->mTraceID[0], 0x4b);
+    EXPECT_EQ(context->mSpanID[7], 0xb7);
+    EXPECT_EQ(ToTraceParent(*context), traceParent);
+
+    EXPECT_FALSE(ParseTraceParent("").has_value());
+    EXPECT_FALSE(ParseTraceParent("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7").has_value());
+    EXPECT_FALSE(ParseTraceParent("00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01").has_value());
+    EXPECT_FALSE(ParseTraceParent("00-00000000000000000000000000000000-00f067aa0ba902b7-01").has_value());
+    EXPECT_FALSE(ParseTraceParent("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01-00").has_value());
+    EXPECT_TRUE(ParseTraceParent("01-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01-00").has_value());
+}
+
+TEST_F(SpanTest, Hierarchy)
+{
+    EXPECT_EQ(Span::Current(), nullptr);
+
+    const auto remote = ParseTraceParent("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01");
+
+    {
+        Span parent {"parent", remote};
+
+        EXPECT_EQ(Span::Current(), &parent);
+        EXPECT_EQ(parent.GetContext().mTraceID, remote->mTraceID);
+        EXPECT_NE(parent.GetContext().mSpanID, remote->mSpanID);
+
+        {
+            Span child {"child"};
+
+            EXPECT_EQ(Span::Current(), &child);
+            EXPECT_EQ(child.GetContext().mTraceID, remote->mTraceID);
+            EXPECT_NE(child.GetContext().mSpanID, parent.GetContext().mSpanID);
+        }
+
+        EXPECT_EQ(Span::Current(), &parent);
+    }
+
+    EXPECT_EQ(Span::Current(), nullptr);
+
+    Span root1 {"root1"};
+    Span root2 {"root2", std::nullopt};
+
+    // root2 is created while root1 is current, so it continues root1 trace
+    EXPECT_EQ(root1.GetContext().mTraceID, root2.GetContext().mTraceID);
+}
+
+} // namespace aos::iam::tracer
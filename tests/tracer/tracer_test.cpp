@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2024 Renesas Electronics Corporation.
+ * Copyright (C) 2024 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "tracer/tracer.hpp"
+
+using namespace testing;
+
+namespace aos::iam::tracer {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+constexpr auto cDumpFile = "tracer_test.bin";
+
+/***********************************************************************************************************************
+ * Types
+ **********************************************************************************************************************/
+
+struct DumpRing {
+    DumpRingHeader     mHeader;
+    std::vector<Event> mEvents;
+};
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+std::vector<DumpRing> ReadDump(DumpHeader& header)
+{
+    std::ifstream         file(cDumpFile, std::ios::binary);
+    std::vector<DumpRing> rings;
+
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return rings;
+    }
+
+    for (uint32_t i = 0; i < header.mRingCount; i++) {
+        DumpRing ring {{}, std::vector<Event>(header.mRingSize)};
+
+        file.read(reinterpret_cast<char*>(&ring.mHeader), sizeof(ring.mHeader));
+        file.read(reinterpret_cast<char*>(ring.mEvents.data()), ring.mEvents.size() * sizeof(Event));
+
+        rings.push_back(std::move(ring));
+    }
+
+    return rings;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Suite
+ **********************************************************************************************************************/
+
+class TracerTest : public Test {
+protected:
+    void SetUp() override { SetDumpPath(cDumpFile); }
+
+    void TearDown() override { std::filesystem::remove(cDumpFile); }
+};
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+TEST_F(TracerTest, DumpContainsEventsOfAllThreads)
+{
+    Record(EventType::ePendingSet, "main thread", 1, 2);
+
+    std::thread thread([]() {
+        for (size_t i = 0; i < cRingSize + 10; i++) {
+            Record(EventType::eRPCStart, "/iamanager.v5.IAMPublicService/GetCert", i);
+        }
+
+        ScopedEvent event(EventType::eDBOp, "GetCertInfo");
+    });
+
+    thread.join();
+
+    ASSERT_TRUE(Dump());
+
+    DumpHeader header {};
+    auto       rings = ReadDump(header);
+
+    EXPECT_EQ(memcmp(header.mMagic, cDumpMagic, sizeof(cDumpMagic)), 0);
+    EXPECT_EQ(header.mVersion, cDumpVersion);
+    EXPECT_EQ(header.mEventSize, sizeof(Event));
+    EXPECT_EQ(header.mRingSize, cRingSize);
+    ASSERT_GE(rings.size(), 2);
+
+    auto threadRing = std::find_if(
+        rings.begin(), rings.end(), [](const DumpRing& ring) { return ring.mHeader.mHead == cRingSize + 11; });
+    ASSERT_NE(threadRing, rings.end());
+
+    const auto& last = threadRing->mEvents[(cRingSize + 10) % cRingSize];
+
+    EXPECT_EQ(last.mType, static_cast<uint8_t>(EventType::eDBOp));
+    EXPECT_STREQ(last.mTag, "GetCertInfo");
+
+    const auto& previous = threadRing->mEvents[(cRingSize + 9) % cRingSize];
+
+    EXPECT_EQ(previous.mType, static_cast<uint8_t>(EventType::eRPCStart));
+    EXPECT_EQ(previous.mID, cRingSize + 9);
+    EXPECT_EQ(strlen(previous.mTag), cTagLen - 1);
+}
+
+TEST_F(TracerTest, EventTypeToString)
+{
+    EXPECT_STREQ(EventTypeToString(static_cast<uint8_t>(EventType::eRPCEnd)), "RPC_END");
+    EXPECT_STREQ(EventTypeToString(static_cast<uint8_t>(EventType::eVISResponse)), "VIS_RESPONSE");
+    EXPECT_STREQ(EventTypeToString(0xFF), "UNKNOWN");
+}
+
+TEST_F(TracerTest, CorrelationIDCoversWholeID)
+{
+    const auto id = "0b6a3f4e-9c2d-4e1b-8f7a-5d3c2b1a0f9e";
+
+    EXPECT_EQ(GetCorrelationID(id), GetCorrelationID(std::string(id).c_str()));
+    EXPECT_NE(GetCorrelationID(id), GetCorrelationID("0b6a3f4e-9c2d-4e1b-8f7a-5d3c2b1a0f9f"));
+    EXPECT_NE(GetCorrelationID(id), 0ULL);
+}
+
+} // namespace aos::iam::tracer